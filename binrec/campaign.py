@@ -319,14 +319,16 @@ class TraceParams:
         """
         return [arg.concrete_value for arg in self.args]
 
-    def write_config_script(self, project: str) -> None:
+    def write_config_script(self, project: str, filename: Path = None) -> None:
         """
         Write the trace params to the binrec trace config script. The config script
         relies on a patched ``bootstrap.sh`` script (see :func:`patch_s2e_project`).
 
         :param project: project name
+        :param filename: the config script to write, defaults to the project's trace
+            config script
         """
-        filename = trace_config_filename(project)
+        filename = filename or trace_config_filename(project)
 
         with open(filename, "w") as fp:
             print("#!/bin/bash", file=fp)
@@ -447,7 +449,9 @@ class TraceParams:
             name=item.get("name"),
         )
 
-    def setup_input_file_directory(self, project: str, cleanup: bool = True) -> None:
+    def setup_input_file_directory(
+        self, project: str, cleanup: bool = True, dirname: Path = None
+    ) -> None:
         """
         Setup the project's trace file input directory. This method will link all
         ``input_files`` to the provided project's file input directory. The ``cleanup``
@@ -457,8 +461,10 @@ class TraceParams:
         :param project: the project name
         :param cleanup: remove all symlinks from the file input directory prior to
             linking this trace's file inputs
+        :param dirname: the file input directory, defaults to the project's file input
+            directory
         """
-        dirname = input_files_dir(project)
+        dirname = dirname or input_files_dir(project)
         if not dirname.is_dir():
             dirname.mkdir()
 
@@ -21,6 +21,7 @@ __all__ = (
     "project_dir",
     "merged_trace_dir",
     "trace_dir",
+    "trace_worker_dir",
     "input_files_dir",
     "trace_config_filename",
     "campaign_filename",
@@ -103,6 +104,9 @@ TRACE_CONFIG_FILENAME = "binrec_trace_config.sh"
 #: The default input files directory name
 INPUT_FILES_DIRNAME = "input_files"
 
+#: The directory that holds the per-trace directories of parallel campaign runs
+TRACE_WORKERS_DIRNAME = "trace-workers"
+
 
 def project_dir(project_name: str) -> Path:
     """
@@ -133,6 +137,14 @@ def trace_dir(project_name: str, trace_id: int) -> Path:
     return project_dir(project_name) / f"s2e-out-{trace_id}"
 
 
+def trace_worker_dir(project_name: str, trace_id: int) -> Path:
+    """
+    :returns: the path to the isolated directory that a single trace runs in when the
+        campaign traces run in parallel
+    """
+    return project_dir(project_name) / TRACE_WORKERS_DIRNAME / str(trace_id)
+
+
 def input_files_dir(project_name: str) -> Path:
     """
     :returns the path to the project input files directory
@@ -174,11 +186,12 @@ def get_trace_dirs(project_name: str) -> List[Path]:
     :returns: the list of project completed trace directories, excluding the merged
         trace directory
     """
-    pattern = re.compile(r"s2e-out-[0-9]$")
+    pattern = re.compile(r"s2e-out-[0-9]+$")
 
     trace_dirs: List[Path] = []
     for trace_dir in project_dir(project_name).iterdir():
         if trace_dir.is_dir() and pattern.match(trace_dir.name):
             trace_dirs.append(trace_dir)
 
-    return sorted(trace_dirs)
+    # sort numerically, so that s2e-out-10 follows s2e-out-9
+    return sorted(trace_dirs, key=lambda path: int(path.name.rpartition("-")[2]))
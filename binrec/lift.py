@@ -1,16 +1,12 @@
 import logging
-import os
 import re
-import shutil
 import subprocess
-import tempfile
-from contextlib import suppress
 from enum import Enum
 from pathlib import Path
 from typing import List, Tuple
 
 from . import project
-from .env import BINREC_LIB, BINREC_LINK_LD, BINREC_RUNLIB, llvm_command
+from .env import BINREC_LIB, BINREC_LINK_LD, BINREC_RUNLIB
 from .errors import BinRecError
 from .lib import binrec_lift, binrec_link, convert_lib_error
 
@@ -39,65 +35,6 @@ ELF_SECTION_PATTERN = re.compile(
 )
 
 
-def prep_bitcode_for_linkage(
-    working_dir: Path, source: Path, destination: Path
-) -> None:
-    """
-    Prepare captured bitcode for linkage. This was originally the content of the
-    ``prep_for_linkage.sh`` script.
-
-    :param working_dir: S2E capture directory (typically ``s2e-out-*``)
-    :param source: the input bitcode filename
-    :param destination: the output bitcode filename
-    :raises BinRecError: operation failed
-    :raises OSError: I/O error
-    """
-    logger.debug("preparing capture bitcode for linkage: %s", source)
-
-    fd, tmp = tempfile.mkstemp()
-    os.close(fd)
-
-    # tmp.bc is created by the lifting scripts
-    tmp_bc = Path(f"{tmp}.bc")
-
-    cwd = str(working_dir)
-
-    if not source.is_absolute():
-        source = working_dir / source
-    src = str(source)
-
-    if not destination.is_absolute():
-        destination = working_dir / destination
-    dest = str(destination)
-
-    try:
-        binrec_lift.link_prep_1(trace_filename=src, destination=tmp, working_dir=cwd)
-    except Exception as err:
-        os.remove(tmp)
-        with suppress(OSError):
-            os.remove(tmp_bc)
-
-        raise convert_lib_error(
-            err, f"failed first stage of linkage prep for bitcode: {source}"
-        )
-
-    shutil.move(tmp_bc, destination)
-    try:
-        binrec_lift.link_prep_2(trace_filename=dest, destination=tmp, working_dir=cwd)
-    except Exception as err:
-        with suppress(OSError):
-            os.remove(tmp_bc)
-
-        os.remove(tmp)
-
-        raise convert_lib_error(
-            err, f"failed second stage of linkage prep for bitcode: {source}"
-        )
-
-    shutil.move(tmp_bc, destination)
-    os.remove(tmp)
-
-
 def _extract_binary_symbols(trace_dir: Path) -> None:
     """
     Extract the symbols from the original binary.
@@ -283,248 +220,49 @@ def _extract_sections(trace_dir: Path) -> None:
             print(" ".join(line), file=file)
 
 
-def _clean_bitcode(trace_dir: Path) -> None:
-    """
-    Clean the trace for linking with custom helpers.
-
-    **Inputs:** trace_dir / captured.bc
-
-    **Outputs:**
-
-    - trace_dir / "cleaned.bc"
-    - trace_dir / "cleaned.ll"
-    - trace_dir / "cleaned-memssa.ll"
-
-    :param trace_dir: binrec binary trace directory
-    :raises BinRecError: operation failed
-    """
-    logger.debug("cleaning captured bitcode: %s", trace_dir.parent.name)
-    try:
-        binrec_lift.clean(
-            trace_filename="captured.bc",
-            destination="cleaned",
-            working_dir=str(trace_dir),
-        )
-    except Exception as err:
-        raise convert_lib_error(
-            err, f"failed to clean captured LLVM bitcode: {trace_dir.parent.name}"
-        )
-
-
-def _apply_fixups(trace_dir: Path) -> None:
-    """
-    Apply binrec fixups to the cleaned bitcode.
-
-    **Inputs:** trace_dir / "cleaned.bc"
-
-    **Outputs:**
-      - trace_dir / "linked.bc"
-      - trace_dir / "linked.ll"
-
-    :param trace_dir: binrec binary trace directory
-    :raises BinRecError: operation failed
-    """
-    logfile = trace_dir / "fixups.log"
-    logger.debug("applying fixups to captured bitcode: %s", trace_dir.parent.name)
-    try:
-        subprocess.check_call(
-            [
-                llvm_command("llvm-link"),
-                "-o",
-                "linked.bc",
-                "cleaned.bc",
-                str(BINREC_RUNLIB / "custom-helpers.bc"),
-            ],
-            cwd=str(trace_dir),
-            stdout=logfile.open("w"),
-            stderr=subprocess.STDOUT,
-        )
-    except subprocess.CalledProcessError:
-        raise BinRecError(
-            f"failed to apply fixups to captured LLVM bitcode: {trace_dir.parent.name},"
-            f" see the log for more information: {logfile}"
-        )
-
-    try:
-        subprocess.check_call(
-            [llvm_command("llvm-dis"), "linked.bc"],
-            cwd=str(trace_dir),
-            stdout=logfile.open("a"),
-            stderr=subprocess.STDOUT,
-        )
-    except subprocess.CalledProcessError:  # pragma: no cover
-        # we don't really care if this fail since we really only want the
-        # human-readable for debugging purposes.
-        pass
-
-
-def _lift_bitcode(trace_dir: Path) -> None:
-    """
-    Lift trace into correct LLVM module.
-
-    **Inputs:** trace_dir / "linked.bc"
-
-    **Outputs:**
-      - trace_dir / "lifted.bc"
-      - trace_dir / "lifted.ll"
-      - trace_dir / "lifted-memssa.ll"
-      - trace_dir / "rfuncs"
-
-    :param trace_dir: binrec binary trace directory
-    :raises BinRecError: operation failed
-    """
-    logger.debug(
-        "performing initial lifting of captured LLVM bitcode: %s", trace_dir.parent.name
-    )
-    try:
-        binrec_lift.lift(
-            trace_filename="linked.bc",
-            destination="lifted",
-            working_dir=str(trace_dir),
-            clean_names=True,
-        )
-    except Exception as err:
-        raise convert_lib_error(
-            err,
-            f"failed to perform initial lifting of LLVM bitcode: "
-            f"{trace_dir.parent.name}",
-        )
-
-
 class OptimizationLevel(Enum):
     NORMAL = 1
     HIGH = 2
 
 
-def _optimize_bitcode(trace_dir: Path, opt_level: OptimizationLevel) -> None:
+def _run_full_pipeline(
+    trace_dir: Path, opt_level: OptimizationLevel, split_module: bool = False
+) -> None:
     """
-    Optimize the lifted LLVM module.
+    Recover the captured bitcode to an object file in a single process. The captured
+    bitcode is cleaned, linked with the custom helpers, lifted, optimized, lowered for
+    compilation, and compiled on one in-memory module.
 
-    **Inputs:** trace_dir / "lifted.bc"
+    **Inputs:** trace_dir / "captured.bc"
 
     **Outputs:**
-        - trace_dir / "optimized.bc"
-        - trace_dir / "optimized.ll"
-        - trace_dir / "optimized-memssa.ll"
-
-    :param trace_dir: binrec binary trace directory
-    :raises BinRecError: operation failed
-    """
-
-    optimizers = {
-        OptimizationLevel.NORMAL: binrec_lift.optimize,
-        OptimizationLevel.HIGH: binrec_lift.optimize_better,
-    }
-
-    logger.debug(
-        "optimizing lifted bitcode: %s at level %s", trace_dir.parent.name, opt_level
-    )
-
-    if opt_level not in optimizers:  # pragma: no cover
-        raise BinRecError(f"Unknown optimization level: {opt_level}")
-
-    optimizer = optimizers[opt_level]
-
-    try:
-        optimizer(
-            trace_filename="lifted.bc",
-            destination="optimized",
-            memssa_check_limit=100000,
-            working_dir=str(trace_dir),
-        )
-    except Exception as err:
-        raise convert_lib_error(
-            err, f"failed to optimized lifted LLVM bitcode: {trace_dir.parent.name}"
-        )
-
-
-def _disassemble_bitcode(trace_dir: Path) -> None:
-    """
-    Disassemble optimized bitcode.
-
-    **Inputs:** trace_dir / "optimized.bc"
-
-    **Outputs:** trace_dir / "optimized.ll"
-
-    :param trace_dir: binrec binary trace directory
-    :raises BinRecError: operation failed
-    """
-    logger.debug("disassembling optimized bitcode: %s", trace_dir.parent.name)
-    logfile = trace_dir / "disassembly.log"
-    try:
-        subprocess.check_call(
-            [llvm_command("llvm-dis"), "optimized.bc"],
-            cwd=str(trace_dir),
-            stdout=logfile.open("w"),
-            stderr=subprocess.STDOUT,
-        )
-    except subprocess.CalledProcessError:
-        raise BinRecError(
-            f"failed to disassemble captured LLVM bitcode: {trace_dir.parent.name}, "
-            f"see log for more information: {logfile}"
-        )
-
-
-def _recover_bitcode(trace_dir: Path) -> None:
-    """
-    Compile the trace to an object file. This method recovers the optimized bitcode.
-
-    **Inputs:** trace_dir / "optimized.bc"
+        - trace_dir / "recovered.o"
+        - trace_dir / "rfuncs"
+        - debug mode only: the bitcode and LLVM IR of each step, from "cleaned.bc" and
+          "cleaned.ll" to "recovered.bc" and "recovered.ll"
 
-    **Outputs:**
-        - trace_dir / "recovered.bc"
-        - trace_dir / "recovered.ll"
-        - trace_dir / "recovered-memssa.ll"
+    Outside of debug mode no bitcode or LLVM IR is written, not even "recovered.bc".
 
     :param trace_dir: binrec binary trace directory
+    :param opt_level: How much effort to put into optimizing lifted bitcode
+    :param split_module: Optimize and compile shards of the lifted bitcode in parallel
     :raises BinRecError: operation failed
     """
-    logger.debug(
-        "lowering optimized LLVM bitcode for compilation: %s", trace_dir.parent.name
-    )
+    logger.debug("recovering captured LLVM bitcode: %s", trace_dir.parent.name)
     try:
-        binrec_lift.compile_prep(
-            trace_filename="optimized.bc",
+        binrec_lift.full_pipeline(
+            trace_filename="captured.bc",
             destination="recovered",
+            custom_helpers=str(BINREC_RUNLIB / "custom-helpers.bc"),
             working_dir=str(trace_dir),
+            optimize_better=opt_level == OptimizationLevel.HIGH,
+            clean_names=True,
+            memssa_check_limit=100000,
+            split_module=split_module,
         )
     except Exception as err:
         raise convert_lib_error(
-            err, f"failed to lower optimized LLVM bitcode: {trace_dir.parent.name}"
-        )
-
-
-def _compile_bitcode(trace_dir: Path) -> None:
-    """
-    Compile the recovered bitcode.
-
-    **Inputs:** trace_dir / "recovered.bc"
-
-    **Outputs:** trace_dir / "recovered.o"
-
-    :param trace_dir: binrec binary trace directory
-    :raises BinRecError: operation failed
-    """
-    logger.debug("compiling recovered LLVM bitcode: %s", trace_dir.parent.name)
-    logfile = trace_dir / "compile.log"
-    try:
-        subprocess.check_call(
-            [
-                llvm_command("llc"),
-                "-filetype",
-                "obj",
-                "-o",
-                "recovered.o",
-                "recovered.bc",
-            ],
-            cwd=str(trace_dir),
-            stdout=logfile.open("a"),
-            stderr=subprocess.STDOUT,
-        )
-    except subprocess.CalledProcessError:
-        raise BinRecError(
-            f"failed to compile recovered LLVM bitcode: {trace_dir.parent.name}, "
-            f"see log for more information: {logfile}"
+            err, f"failed to recover captured LLVM bitcode: {trace_dir.parent.name}"
         )
 
 
@@ -561,6 +299,7 @@ def lift_trace(
     project_name: str,
     opt_level: OptimizationLevel = OptimizationLevel.NORMAL,
     harden: bool = False,
+    split_module: bool = False,
 ) -> None:
     """
     Lift and recover a binary from a binrec trace. This lifts, compiles, and links
@@ -570,6 +309,9 @@ def lift_trace(
     :param project_name: name of the s2e project to operate on
     :param opt_level: How much effort to put into optimizing lifted bitcode
     :param harden: Whether to apply security hardening passes to the lifted bitcode.
+    :param split_module: Whether to optimize and compile shards of the lifted bitcode in
+        parallel. This is faster on large binaries, but calls between shards are not
+        inlined.
 
     """
     merged_trace_dir = project.merged_trace_dir(project_name)
@@ -586,28 +328,11 @@ def lift_trace(
     _extract_sections(merged_trace_dir)
     _extract_dependencies(merged_trace_dir)
 
-    # Step 2: clean captured LLVM bitcode
-    _clean_bitcode(merged_trace_dir)
+    # Step 2: clean, apply fixups, lift, optimize, recover, and compile the captured
+    # bitcode in a single process
+    _run_full_pipeline(merged_trace_dir, opt_level, split_module)
 
-    # Step 3: apply fixups to captured bitcode
-    _apply_fixups(merged_trace_dir)
-
-    # Step 4: initial lifting
-    _lift_bitcode(merged_trace_dir)
-
-    # Step 5: optimize the lifted bitcode
-    _optimize_bitcode(merged_trace_dir, opt_level)
-
-    # Step 6: disassemble optimized bitcode
-    _disassemble_bitcode(merged_trace_dir)
-
-    # Step 7: recover the optimized bitcode
-    _recover_bitcode(merged_trace_dir)
-
-    # Step 8: compile recovered bitcode
-    _compile_bitcode(merged_trace_dir)
-
-    # Step 9: Link the recovered binary
+    # Step 3: Link the recovered binary
     _link_recovered_binary(merged_trace_dir, harden)
 
     logger.info(
@@ -640,6 +365,11 @@ def main() -> None:
         action="store_true",
         help="Enable security hardening optimizations during lifting",
     )
+    parser.add_argument(
+        "--split-module",
+        action="store_true",
+        help="Optimize and compile shards of the lifted bitcode in parallel",
+    )
     parser.add_argument("project_name", help="lift and compile the binary trace")
 
     args = parser.parse_args()
@@ -655,7 +385,7 @@ def main() -> None:
         logger.debug("Enabling extra performance optimizations during lifting")
         opt_level = OptimizationLevel.HIGH
 
-    lift_trace(args.project_name, opt_level, args.harden)
+    lift_trace(args.project_name, opt_level, args.harden, args.split_module)
     sys.exit(0)
 
 
@@ -2,56 +2,53 @@ import logging
 import os
 import shutil
 import subprocess
-import tempfile
 from pathlib import Path
 from typing import List
 
 from .env import BINREC_BIN, get_trace_dirs, llvm_command, merged_trace_dir
 from .errors import BinRecError
-from .lift import prep_bitcode_for_linkage
+from .lib import binrec_lift, convert_lib_error
 
 logger = logging.getLogger("binrec.merge")
 
 
-def _link_bitcode(base: Path, source: Path, destination: Path):
+def _link_bitcode(sources: List[Path], destination: Path) -> None:
     """
-    Link two LLVM bitcode captures.
+    Prepare LLVM bitcode captures for linkage and link them into a single module. The
+    captures are prepared and linked in memory and in parallel, and only the result is
+    written to disk. Definitions from earlier captures take precedence over definitions
+    from later captures.
 
-    :param base: bitcode file to use as the basis for the link (passed to llvm-link as
-        ``-override`` parameter)
-    :param source: input bitcode file to link
+    :param sources: captured bitcode files, in order of precedence
     :param destination: output bitcode file
     """
-    logfile = destination.parent / "merge_link.log"
-    logger.info("linking prepared bitcode: %s", source)
+    logger.info("preparing and linking %d captured bitcode files", len(sources))
     try:
-        subprocess.check_call(
-            [
-                llvm_command("llvm-link"),
-                "-print-after-all",
-                "-v",
-                "-o",
-                str(destination),
-                f"-override={base}",
-                str(source),
-            ],
-            stdout=logfile.open("a"),
-            stderr=subprocess.STDOUT,
+        binrec_lift.merge_captures(
+            captures=[str(source) for source in sources], destination=str(destination)
         )
-    except subprocess.CalledProcessError:
-        raise BinRecError(f"llvm-link failed on captured bitcode: {source}")
+    except Exception as err:
+        raise convert_lib_error(err, f"failed to merge captured bitcode: {destination}")
 
 
 def _merge_trace_info(trace_info_files: List[Path], destination: Path) -> None:
     """
-    Merge binrec trace information files, ``traceInfo.json``.
+    Merge binrec trace information files, ``traceInfo.json``, ``traceInfo.bin`` or the
+    ``traceInfo.journal`` that is appended while tracing. The inputs may be mixed
+    formats. The output is written in the binary format when the
+    ``destination`` has a ``.bin`` suffix and as JSON otherwise. The files are merged in
+    a single streaming pass, which also drops duplicate memory accesses.
 
     :param trace_info_files: list of input trace info files to merge
     :param destination: output file path
     """
 
     binrec_tracemerge = str(BINREC_BIN / "binrec_tracemerge")
-    args = [str(filename) for filename in trace_info_files] + [str(destination)]
+    args = (
+        ["--stream"]
+        + [str(filename) for filename in trace_info_files]
+        + [str(destination)]
+    )
     try:
         subprocess.check_call([binrec_tracemerge] + args)
     except subprocess.CalledProcessError:
@@ -64,23 +61,26 @@ def merge_bitcode(capture_dirs: List[Path], destination: Path) -> None:
     single LLVM bitcode and disassembly. This method performs the following:
 
     - Recursively delete and then recreate the ``destination``
-    - Prepares each captured bitcode, ``captured.bc``, for linkage
-    - Links all the preparsed captured bitcode into a single bitcode file,
-      ``{destination}/captured.bc``
-    - Disassembles the liked capture bitcode to LLVM assembly code,
-      ``{destination}/captured.ll``
-    - Merges all the trace information JSON files to a single trace info,
-      ``{destination}/traceInfo.json``
+    - Prepares each captured bitcode, ``captured.bc``, for linkage and links all of
+      them into a single bitcode file, ``{destination}/captured.bc``, without writing
+      the prepared bitcode to disk
+    - Disassembles the linked capture bitcode to LLVM assembly code,
+      ``{destination}/captured.ll``, when debug logging is enabled
+    - Merges all the trace information files to a single trace info,
+      ``{destination}/traceInfo.bin`` if any of the captures stored its trace info in
+      the binary format or as a journal and ``{destination}/traceInfo.json`` otherwise
 
     :param capture_dirs: list of trace capture directories or merged captures
     :param outdidestindestinationationr: output directory
     """
     logger.debug("merging captures %s to %s", capture_dirs, destination)
     SOURCE_BITCODE_NAME = "captured"
-    DESTINATION_SUFFIX = "-link-ready"
+    LINK_READY_SUFFIX = "-link-ready.bc"
     BITCODE_SUFFIX = ".bc"
     TRACE_INFO_NAME = "traceInfo"
     TRACE_SUFFIX = ".json"
+    BINARY_TRACE_SUFFIX = ".bin"
+    JOURNAL_TRACE_SUFFIX = ".journal"
 
     # Verify that the output directory (destination) is empty.
     if destination.exists():
@@ -88,51 +88,46 @@ def merge_bitcode(capture_dirs: List[Path], destination: Path) -> None:
 
     destination.mkdir(exist_ok=True)
 
-    # Check each capture folder for captured bitcode files and prepare each for linking
-    # There may be multiple files per capture: symex tracing produces one file per state
-    linked_paths = []
+    # Check each capture folder for captured bitcode files. There may be multiple files
+    # per capture: symex tracing produces one file per state. Link-ready bitcode left
+    # behind by older versions of binrec is ignored.
+    capture_paths = []
     trace_info_files = []
     for capture in capture_dirs:
         for capfile in os.listdir(capture):
-            if capfile.startswith(SOURCE_BITCODE_NAME) and capfile.endswith(
-                BITCODE_SUFFIX
+            if (
+                capfile.startswith(SOURCE_BITCODE_NAME)
+                and capfile.endswith(BITCODE_SUFFIX)
+                and not capfile.endswith(LINK_READY_SUFFIX)
+            ):
+                capture_paths.append(capture / capfile)
+
+            elif capfile.startswith(TRACE_INFO_NAME) and capfile.endswith(
+                (TRACE_SUFFIX, BINARY_TRACE_SUFFIX, JOURNAL_TRACE_SUFFIX)
             ):
-                linked_name = (
-                    capfile[: capfile.find(BITCODE_SUFFIX)]
-                    + DESTINATION_SUFFIX
-                    + BITCODE_SUFFIX
-                )
-                linked_paths.append(capture / linked_name)
-                prep_bitcode_for_linkage(capture, Path(capfile), Path(linked_name))
-
-            elif capfile.startswith(TRACE_INFO_NAME) and capfile.endswith(TRACE_SUFFIX):
                 trace_info_files.append(capture / capfile)
 
-    # copy the first captured-link-ready.bc to {destination}/captured.bc
+    # prepare and link all captured bitcode files to {destination}/captured.bc
     outfile = destination / (SOURCE_BITCODE_NAME + BITCODE_SUFFIX)
-    shutil.copy(linked_paths[0], outfile)
-
-    fd, tmp = tempfile.mkstemp(suffix=BITCODE_SUFFIX)
-    os.close(fd)
-
-    for linked_path in linked_paths[1:]:
-        # Link each captured-link-ready.bc to the {destination}/captured.bc
-        _link_bitcode(
-            base=outfile,
-            source=linked_path,
-            destination=Path(tmp),
-        )
-        shutil.move(tmp, outfile)
-
-    logger.debug("disassembling linked bitcode: %s", outfile)
-
-    try:
-        subprocess.check_call([llvm_command("llvm-dis"), str(outfile)])
-    except subprocess.CalledProcessError:
-        raise BinRecError(f"llvm-dis failed on linked bitcode: {outfile}")
-
-    # merge all found trace info files
-    _merge_trace_info(trace_info_files, destination / (TRACE_INFO_NAME + TRACE_SUFFIX))
+    _link_bitcode(capture_paths, outfile)
+
+    if logger.isEnabledFor(logging.DEBUG):
+        logger.debug("disassembling linked bitcode: %s", outfile)
+        try:
+            subprocess.check_call([llvm_command("llvm-dis"), str(outfile)])
+        except subprocess.CalledProcessError:
+            raise BinRecError(f"llvm-dis failed on linked bitcode: {outfile}")
+
+    # merge all found trace info files, keeping the binary format if any capture used it
+    if any(
+        path.suffix in (BINARY_TRACE_SUFFIX, JOURNAL_TRACE_SUFFIX)
+        for path in trace_info_files
+    ):
+        trace_suffix = BINARY_TRACE_SUFFIX
+    else:
+        trace_suffix = TRACE_SUFFIX
+
+    _merge_trace_info(trace_info_files, destination / (TRACE_INFO_NAME + trace_suffix))
 
 
 def merge_traces(project_name: str) -> None:
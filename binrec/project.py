@@ -6,6 +6,7 @@ import re
 import shutil
 import subprocess
 import textwrap
+from concurrent.futures import ThreadPoolExecutor, as_completed
 from pathlib import Path
 from typing import List, Tuple, Union
 
@@ -20,17 +21,33 @@ from binrec.campaign import (
 
 from .env import (
     INPUT_FILES_DIRNAME,
+    TRACE_CONFIG_FILENAME,
+    TRACE_WORKERS_DIRNAME,
     campaign_filename,
     get_trace_dirs,
     input_files_dir,
     merged_trace_dir,
     project_dir,
     s2e_config_filename,
+    trace_dir,
+    trace_worker_dir,
 )
 from .errors import BinRecError
 
 logger = logging.getLogger("binrec.project")
 
+#: The estimated host memory used by a single S2E trace, which bounds the number of
+#: traces that run in parallel
+TRACE_MEMORY_ESTIMATE = 2 * 1024**3
+
+#: Project entries that every trace worker directory gets its own copy of
+_TRACE_WORKER_OWN_ENTRIES = (
+    INPUT_FILES_DIRNAME,
+    TRACE_CONFIG_FILENAME,
+    TRACE_WORKERS_DIRNAME,
+    "launch-s2e.sh",
+)
+
 
 def listing() -> List[str]:
     try:
@@ -269,11 +286,16 @@ def _run_trace_teardown(campaign: Campaign, trace: TraceParams, cwd: Path) -> No
     logger.info("teardown actions completed")
 
 
-def run_campaign(project_or_campaign: Union[str, Campaign]) -> None:
+def run_campaign(
+    project_or_campaign: Union[str, Campaign], jobs: int = 1, merge: bool = False
+) -> None:
     """
     Run an entire campaign and all traces.
 
     :param project_or_campaign: the project name (``str``) or the campaign object to run
+    :param jobs: the number of traces to run in parallel, or ``0`` to size the worker
+        pool to the available cores and memory (see :func:`campaign_jobs`)
+    :param merge: merge the collected traces once all traces have completed
     """
     if isinstance(project_or_campaign, str):
         campaign = Campaign.load_project(project_or_campaign)
@@ -282,8 +304,174 @@ def run_campaign(project_or_campaign: Union[str, Campaign]) -> None:
     else:
         raise TypeError("expected project name (str) or campaign object")
 
-    for trace in campaign.traces:
-        _run_campaign_trace(campaign, trace)
+    if jobs <= 0:
+        jobs = campaign_jobs(len(campaign.traces))
+
+    if jobs > 1 and len(campaign.traces) > 1:
+        _run_campaign_parallel(campaign, jobs)
+    else:
+        for trace in campaign.traces:
+            _run_campaign_trace(campaign, trace)
+
+    if merge:
+        from .merge import merge_traces
+
+        merge_traces(campaign.project)
+
+
+def _available_memory() -> int:
+    """
+    :returns: the available host memory in bytes, or ``0`` if it is unknown
+    """
+    try:
+        with open("/proc/meminfo", "r") as file:
+            for line in file:
+                if line.startswith("MemAvailable:"):
+                    return int(line.split()[1]) * 1024
+    except (OSError, ValueError, IndexError):
+        pass
+
+    return 0
+
+
+def campaign_jobs(trace_count: int) -> int:
+    """
+    Get the number of campaign traces to run in parallel. Every trace runs its own S2E
+    instance, so the worker pool is bounded by the number of cores and by the number of
+    traces that fit in the available memory (see :data:`TRACE_MEMORY_ESTIMATE`).
+
+    :param trace_count: the number of traces in the campaign
+    :returns: the number of parallel workers, at least ``1``
+    """
+    jobs = os.cpu_count() or 1
+    memory = _available_memory()
+    if memory:
+        jobs = min(jobs, memory // TRACE_MEMORY_ESTIMATE)
+
+    return max(1, min(jobs, trace_count))
+
+
+def _run_campaign_parallel(campaign: Campaign, jobs: int) -> None:
+    """
+    Run all campaign traces in a pool of parallel workers. Every trace runs in its own
+    worker directory (see :func:`_setup_trace_worker`) and its output is moved to a
+    trace directory that was reserved before the first trace started, so the trace
+    directories follow the campaign order, just like a serial run.
+
+    :param campaign: the campaign
+    :param jobs: the number of traces to run in parallel
+    """
+    trace_ids = _get_next_trace_ids(campaign.project, len(campaign.traces))
+    logger.info(
+        "running %d campaign traces with %d parallel workers: %s",
+        len(campaign.traces),
+        jobs,
+        campaign.project,
+    )
+
+    failed = 0
+    with ThreadPoolExecutor(max_workers=jobs) as executor:
+        futures = [
+            executor.submit(_run_campaign_trace_worker, campaign, trace, trace_id)
+            for trace, trace_id in zip(campaign.traces, trace_ids)
+        ]
+        for future in as_completed(futures):
+            try:
+                future.result()
+            except BinRecError as err:
+                logger.error("%s", err)
+                failed += 1
+
+    workers_dir = project_dir(campaign.project) / TRACE_WORKERS_DIRNAME
+    if workers_dir.is_dir() and not any(workers_dir.iterdir()):
+        workers_dir.rmdir()
+
+    if failed:
+        raise BinRecError(
+            f"{failed} of {len(campaign.traces)} traces failed for project: "
+            f"{campaign.project}, for more information view the trace log files in "
+            f"{project_dir(campaign.project)}"
+        )
+
+
+def _setup_trace_worker(campaign: Campaign, trace: TraceParams, worker: Path) -> None:
+    """
+    Create the isolated directory that a single trace runs in. The worker directory
+    links to the entries of the project directory, except for the trace config script
+    and the input files directory, which belong to the trace, and the S2E config, which
+    is rewritten to load the host files from the worker directory. S2E writes the trace
+    output into the worker directory.
+
+    :param campaign: the campaign
+    :param trace: the trace
+    :param worker: the worker directory
+    """
+    project_path = project_dir(campaign.project)
+    if worker.is_dir():
+        shutil.rmtree(worker)
+    worker.mkdir(parents=True)
+
+    for entry in project_path.iterdir():
+        if entry.name in _TRACE_WORKER_OWN_ENTRIES or entry.name.startswith("s2e-"):
+            continue
+        (worker / entry.name).symlink_to(entry)
+
+    shutil.copy2(project_path / "launch-s2e.sh", worker / "launch-s2e.sh")
+    config = s2e_config_filename(campaign.project).read_text()
+    (worker / s2e_config_filename(campaign.project).name).write_text(
+        config.replace(str(project_path), str(worker))
+    )
+
+    trace.setup_input_file_directory(
+        campaign.project, dirname=worker / INPUT_FILES_DIRNAME
+    )
+    trace.write_config_script(campaign.project, worker / TRACE_CONFIG_FILENAME)
+
+
+def _run_campaign_trace_worker(
+    campaign: Campaign, trace: TraceParams, trace_id: int
+) -> None:
+    """
+    Run a single trace within its own worker directory and move the trace output to
+    the reserved trace directory.
+
+    :param campaign: the campaign
+    :param trace: the trace
+    :param trace_id: the reserved trace directory number
+    """
+    worker = trace_worker_dir(campaign.project, trace_id)
+    _setup_trace_worker(campaign, trace, worker)
+
+    logfile = _trace_log_filename(campaign.project, trace_id)
+    logger.info(
+        "running campaign trace: %s/%s (saving S2E log to: %s)",
+        campaign.project,
+        trace.name or "<anonymous trace>",
+        logfile,
+    )
+    with logfile.open("w") as log:
+        try:
+            subprocess.check_call(
+                ["./launch-s2e.sh"],
+                cwd=str(worker),
+                stdout=log,
+                stderr=subprocess.STDOUT,
+            )
+        except subprocess.CalledProcessError:
+            raise BinRecError(
+                f"s2e run failed for project: {campaign.project}, for more information "
+                f"view the log file at {logfile}"
+            )
+
+    output = worker / "s2e-last"
+    if not output.is_dir():
+        raise BinRecError(
+            f"s2e run did not produce a trace for project: {campaign.project}, for "
+            f"more information view the log file at {logfile}"
+        )
+
+    shutil.move(str(output.resolve()), str(trace_dir(campaign.project, trace_id)))
+    shutil.rmtree(worker)
 
 
 def run_campaign_trace(project: str, trace_name_or_id: Union[int, str]) -> None:
@@ -333,19 +521,40 @@ def _get_next_trace_log_filename(project: str) -> Path:
     """
     Get the next log file name prior to running a trace.
     """
-    trace_nums = []
+    return _trace_log_filename(project, _get_next_trace_ids(project, 1)[0])
+
+
+def _get_next_trace_ids(project: str, count: int) -> List[int]:
+    """
+    Get the numbers of the next trace directories, filling gaps left by removed traces
+    first.
+
+    :param project: the project name
+    :param count: the number of trace directories to reserve
+    """
+    trace_nums = set()
     for entry in get_trace_dirs(project):
         try:
             number = int(entry.name.split("-")[-1])
-            trace_nums.append(number)
+            trace_nums.add(number)
         except ValueError:
             pass
 
+    trace_ids: List[int] = []
     i = 0
-    while i in trace_nums:
+    while len(trace_ids) < count:
+        if i not in trace_nums:
+            trace_ids.append(i)
         i += 1
 
-    return project_dir(project) / f"s2e-out-{i}.log"
+    return trace_ids
+
+
+def _trace_log_filename(project: str, trace_id: int) -> Path:
+    """
+    :returns: the S2E log file name of a single trace
+    """
+    return project_dir(project) / f"s2e-out-{trace_id}.log"
 
 
 def validate_campaign(project_or_campaign: Union[str, Campaign]) -> None:
@@ -553,6 +762,12 @@ def new_project(
 add_plugin(\"ELFSelector\")
 add_plugin(\"FunctionMonitor\")
 add_plugin(\"FunctionLog\")
+pluginsConfig.FunctionLog = {{
+    traceInfoFormat = "binary", -- "json" for a human readable trace info
+    traceInfoJournal = true, -- append trace info in batches while tracing
+    journalBatchSize = 4096,
+    blockBufferSize = 4096 -- executed blocks folded into the trace info at once
+}}
 add_plugin(\"ExportELF\")
 pluginsConfig.ExportELF = {{
     baseDirs = {{
@@ -654,6 +869,11 @@ def clear_project_trace_data(project: str) -> None:
         logger.debug("deleting merged trace directory: %s", merged)
         shutil.rmtree(merged)
 
+    workers = project_dir(project) / TRACE_WORKERS_DIRNAME
+    if workers.is_dir():
+        logger.debug("deleting trace worker directory: %s", workers)
+        shutil.rmtree(workers)
+
 
 def add_trace_setup(
     project: str, trace_name_or_id: Union[str, int], command: str
@@ -736,6 +956,16 @@ def main() -> None:
     )
 
     run = subparsers.add_parser("run")
+    run.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=1,
+        help="number of traces to run in parallel (0 to match the cores and memory)",
+    )
+    run.add_argument(
+        "--merge", action="store_true", help="merge the traces once all have completed"
+    )
     run.add_argument("project", help="project name")
 
     run_trace = subparsers.add_parser("run-trace")
@@ -853,7 +1083,7 @@ def main() -> None:
     elif args.current_parser == "describe":
         describe_campaign(args.project)
     elif args.current_parser == "run":
-        run_campaign(args.project)
+        run_campaign(args.project, args.jobs, args.merge)
     elif args.current_parser == "run-trace":
         if args.name:
             name = int(args.name) if args.id else args.name
@@ -1,20 +1,28 @@
+from typing import List
+
 def link_prep_1(
     trace_filename: str,
     destination: str,
     working_dir: str = None,
     memssa_check_limit: int = None,
+    output: str = None,
+    profile: bool = False,
 ) -> None: ...
 def link_prep_2(
     trace_filename: str,
     destination: str,
     working_dir: str = None,
     memssa_check_limit: int = None,
+    output: str = None,
+    profile: bool = False,
 ) -> None: ...
 def clean(
     trace_filename: str,
     destination: str,
     working_dir: str = None,
     memssa_check_limit: int = None,
+    output: str = None,
+    profile: bool = False,
 ) -> None: ...
 def lift(
     trace_filename: str,
@@ -24,24 +32,52 @@ def lift(
     skip_link: bool = False,
     trace_calls: bool = False,
     memssa_check_limit: int = None,
+    output: str = None,
+    profile: bool = False,
 ) -> None: ...
 def optimize(
     trace_filename: str,
     destination: str,
     working_dir: str = None,
     memssa_check_limit: int = None,
+    output: str = None,
+    profile: bool = False,
 ) -> None: ...
 def optimize_better(
     trace_filename: str,
     destination: str,
     working_dir: str = None,
     memssa_check_limit: int = None,
+    output: str = None,
+    profile: bool = False,
 ) -> None: ...
 def compile_prep(
     trace_filename: str,
     destination: str,
     working_dir: str = None,
     memssa_check_limit: int = None,
+    output: str = None,
+    profile: bool = False,
+) -> None: ...
+def full_pipeline(
+    trace_filename: str,
+    destination: str,
+    custom_helpers: str,
+    working_dir: str = None,
+    optimize_better: bool = False,
+    clean_names: bool = False,
+    skip_link: bool = False,
+    trace_calls: bool = False,
+    memssa_check_limit: int = None,
+    output: str = None,
+    split_module: bool = False,
+    jobs: int = 0,
+    profile: bool = False,
+) -> None: ...
+def merge_captures(
+    captures: List[str],
+    destination: str,
+    jobs: int = 0,
 ) -> None: ...
 
 class LiftError(Exception): ...
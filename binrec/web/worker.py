@@ -23,7 +23,7 @@ def recover_from_campaign(project: str) -> None:
 
     logger.debug("running campaign")
     try:
-        run_campaign(campaign)
+        run_campaign(campaign, jobs=0)
     except:  # noqa: E722
         logger.exception("failed to run campaign for project: %s", project)
         sys.exit(-1)
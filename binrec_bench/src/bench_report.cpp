@@ -0,0 +1,238 @@
+#include "bench_report.hpp"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Process.h>
+#include <sys/resource.h>
+#include <thread>
+
+using namespace binrec;
+using namespace llvm;
+using namespace std;
+
+namespace {
+    /// The format of the report, which changes when a field changes its meaning.
+    constexpr int64_t report_version = 1;
+
+    auto cpu_time() -> chrono::nanoseconds
+    {
+        sys::TimePoint<> elapsed;
+        chrono::nanoseconds user{};
+        chrono::nanoseconds system{};
+        sys::Process::GetTimeUsage(elapsed, user, system);
+        return user + system;
+    }
+
+    /// Reset the peak resident set size of the process to its current size. This is only
+    /// supported on Linux, elsewhere the peak covers the lifetime of the process.
+    void reset_peak_rss()
+    {
+        ofstream clear_refs{"/proc/self/clear_refs"};
+        clear_refs << "5";
+    }
+
+    auto peak_rss() -> uint64_t
+    {
+        ifstream status{"/proc/self/status"};
+        string line;
+        while (getline(status, line)) {
+            if (line.compare(0, 6, "VmHWM:") == 0) {
+                // Linux reports kilobytes.
+                return stoull(line.substr(6)) * 1024;
+            }
+        }
+
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+    }
+
+    auto median(vector<double> values) -> double
+    {
+        std::sort(values.begin(), values.end());
+        size_t middle = values.size() / 2;
+        if (values.size() % 2 == 0) {
+            return (values[middle - 1] + values[middle]) / 2;
+        }
+        return values[middle];
+    }
+
+    void write_stats(json::OStream &j, StringRef name, const vector<double> &values)
+    {
+        j.attributeObject(name, [&] {
+            j.attribute("min", *min_element(values.begin(), values.end()));
+            j.attribute("median", median(values));
+            j.attribute("max", *max_element(values.begin(), values.end()));
+        });
+    }
+
+    auto timestamp() -> string
+    {
+        time_t now = time(nullptr);
+        tm utc{};
+        gmtime_r(&now, &utc);
+        char buffer[32];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+        return buffer;
+    }
+
+    /// Read the median wall time of every benchmark of a report.
+    auto load_medians(StringRef filename) -> Expected<StringMap<double>>
+    {
+        auto buffer = MemoryBuffer::getFile(filename);
+        if (!buffer) {
+            return createStringError(buffer.getError(), "cannot read " + filename);
+        }
+        Expected<json::Value> root = json::parse((*buffer)->getBuffer());
+        if (!root) {
+            return root.takeError();
+        }
+
+        StringMap<double> medians;
+        const json::Object *report = root->getAsObject();
+        const json::Array *benchmarks = report ? report->getArray("benchmarks") : nullptr;
+        if (!benchmarks) {
+            return createStringError(inconvertibleErrorCode(), filename + " is not a report");
+        }
+        for (const json::Value &value : *benchmarks) {
+            const json::Object *benchmark = value.getAsObject();
+            if (!benchmark) {
+                continue;
+            }
+            Optional<StringRef> name = benchmark->getString("name");
+            const json::Object *wall = benchmark->getObject("wall_seconds");
+            Optional<double> wall_median = wall ? wall->getNumber("median") : None;
+            if (name && wall_median) {
+                medians[*name] = *wall_median;
+            }
+        }
+        return medians;
+    }
+} // namespace
+
+Stopwatch::Stopwatch()
+{
+    reset_peak_rss();
+    wall = chrono::steady_clock::now();
+    cpu = cpu_time();
+}
+
+auto Stopwatch::stop() const -> Sample
+{
+    chrono::duration<double> wall_elapsed = chrono::steady_clock::now() - wall;
+    chrono::duration<double> cpu_elapsed = cpu_time() - cpu;
+    return {wall_elapsed.count(), cpu_elapsed.count(), peak_rss()};
+}
+
+void BenchReport::set_parameter(StringRef name, StringRef value)
+{
+    parameters.emplace_back(name.str(), value.str());
+}
+
+void BenchReport::add(StringRef name, StringRef unit, uint64_t items, const Sample &sample)
+{
+    auto it = find_if(benchmarks.begin(), benchmarks.end(), [&](const Benchmark &benchmark) {
+        return benchmark.name == name;
+    });
+    if (it == benchmarks.end()) {
+        benchmarks.push_back({name.str(), unit.str(), items, {}});
+        it = benchmarks.end() - 1;
+    }
+    it->samples.push_back(sample);
+}
+
+void BenchReport::write_json(raw_ostream &os) const
+{
+    // JSON integers are signed.
+    json::OStream j{os, 2};
+    j.object([&] {
+        j.attribute("version", report_version);
+        j.attribute("date", timestamp());
+        j.attributeObject("host", [&] {
+            j.attribute("threads", static_cast<int64_t>(thread::hardware_concurrency()));
+            j.attribute("llvm", LLVM_VERSION_STRING);
+        });
+        j.attributeObject("parameters", [&] {
+            for (const auto &parameter : parameters) {
+                j.attribute(parameter.first, parameter.second);
+            }
+        });
+        j.attributeArray("benchmarks", [&] {
+            for (const Benchmark &benchmark : benchmarks) {
+                vector<double> wall;
+                vector<double> cpu;
+                uint64_t peak = 0;
+                for (const Sample &sample : benchmark.samples) {
+                    wall.push_back(sample.wall_seconds);
+                    cpu.push_back(sample.cpu_seconds);
+                    peak = max(peak, sample.peak_rss);
+                }
+
+                j.object([&] {
+                    j.attribute("name", benchmark.name);
+                    j.attribute("unit", benchmark.unit);
+                    j.attribute("items", static_cast<int64_t>(benchmark.items));
+                    j.attribute("repetitions", static_cast<int64_t>(benchmark.samples.size()));
+                    write_stats(j, "wall_seconds", wall);
+                    write_stats(j, "cpu_seconds", cpu);
+                    double wall_median = median(wall);
+                    if (benchmark.items && wall_median > 0) {
+                        j.attribute("items_per_second", benchmark.items / wall_median);
+                    }
+                    if (peak) {
+                        j.attribute("peak_rss_bytes", static_cast<int64_t>(peak));
+                    }
+                });
+            }
+        });
+    });
+    os << '\n';
+}
+
+auto BenchReport::print_summary(raw_ostream &os, StringRef baseline_filename) const -> Error
+{
+    StringMap<double> baseline;
+    if (!baseline_filename.empty()) {
+        Expected<StringMap<double>> medians = load_medians(baseline_filename);
+        if (!medians) {
+            return medians.takeError();
+        }
+        baseline = move(*medians);
+    }
+
+    os << left_justify("benchmark", 48) << ' ' << right_justify("median (s)", 12) << ' '
+       << right_justify("items/s", 14) << ' ' << right_justify("peak MiB", 10);
+    if (!baseline_filename.empty()) {
+        os << ' ' << right_justify("vs base", 10);
+    }
+    os << '\n';
+
+    for (const Benchmark &benchmark : benchmarks) {
+        vector<double> wall;
+        uint64_t peak = 0;
+        for (const Sample &sample : benchmark.samples) {
+            wall.push_back(sample.wall_seconds);
+            peak = max(peak, sample.peak_rss);
+        }
+        double wall_median = median(wall);
+        double rate = wall_median > 0 ? benchmark.items / wall_median : 0;
+
+        os << format(
+            "%-48s %12.4f %14.0f %10.1f",
+            benchmark.name.c_str(),
+            wall_median,
+            rate,
+            peak / (1024.0 * 1024.0));
+        auto base = baseline.find(benchmark.name);
+        if (base != baseline.end() && base->second > 0) {
+            os << format(" %9.2fx", wall_median / base->second);
+        }
+        os << '\n';
+    }
+    return Error::success();
+}
@@ -0,0 +1,84 @@
+#ifndef BINREC_BENCH_REPORT_HPP
+#define BINREC_BENCH_REPORT_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace binrec {
+    /// The cost of one repetition of a benchmark.
+    struct Sample {
+        double wall_seconds;
+        /// The CPU time of all threads.
+        double cpu_seconds;
+        /// The peak resident set size of the process while the benchmark ran, or 0 if it was
+        /// not measured on its own.
+        uint64_t peak_rss;
+    };
+
+    /// Measures one repetition of a benchmark.
+    class Stopwatch {
+    public:
+        /// Reset the peak resident set size of the process and start the clocks.
+        Stopwatch();
+
+        [[nodiscard]] auto stop() const -> Sample;
+
+    private:
+        std::chrono::steady_clock::time_point wall;
+        std::chrono::nanoseconds cpu;
+    };
+
+    /// The repetitions of all benchmarks of a run, written as JSON so that runs can be compared.
+    class BenchReport {
+    public:
+        /// Record a parameter of the run, such as the number of threads, which must match for
+        /// the results of two runs to be comparable.
+        void set_parameter(llvm::StringRef name, llvm::StringRef value);
+
+        /// Add a repetition of the benchmark name, which processed items of unit.
+        void add(llvm::StringRef name, llvm::StringRef unit, uint64_t items, const Sample &sample);
+
+        void write_json(llvm::raw_ostream &os) const;
+
+        /// Print the median wall time of every benchmark and, if there is a baseline report,
+        /// its ratio to the median wall time of the benchmark of the same name in the baseline.
+        auto print_summary(llvm::raw_ostream &os, llvm::StringRef baseline_filename) const
+            -> llvm::Error;
+
+    private:
+        struct Benchmark {
+            std::string name;
+            std::string unit;
+            uint64_t items;
+            std::vector<Sample> samples;
+        };
+
+        std::vector<std::pair<std::string, std::string>> parameters;
+        std::vector<Benchmark> benchmarks;
+    };
+
+    /// Add repetitions of body to the report, measured on their own.
+    template <typename Body>
+    void measure(
+        BenchReport &report,
+        llvm::StringRef name,
+        llvm::StringRef unit,
+        uint64_t items,
+        unsigned repetitions,
+        Body body)
+    {
+        for (unsigned i = 0; i < repetitions; ++i) {
+            Stopwatch stopwatch;
+            body();
+            report.add(name, unit, items, stopwatch.stop());
+        }
+    }
+} // namespace binrec
+
+#endif
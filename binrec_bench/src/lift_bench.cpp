@@ -0,0 +1,133 @@
+#include "lift_bench.hpp"
+#include "analysis/trace_info_cache.hpp"
+#include "binrec_lift.hpp"
+#include "binrec_link.hpp"
+#include "link_context.hpp"
+#include <llvm/Object/Binary.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <stdexcept>
+
+using namespace binrec;
+using namespace llvm;
+using namespace std;
+
+namespace {
+    constexpr const char *destination = "bench-recovered";
+
+    /// Change the working directory for the lifetime of the object, like the working_dir
+    /// argument of the Python bindings.
+    class WorkingDirectory {
+    public:
+        explicit WorkingDirectory(StringRef path)
+        {
+            if (error_code ec = sys::fs::current_path(previous)) {
+                throw runtime_error{"cannot get the working directory: " + ec.message()};
+            }
+            if (error_code ec = sys::fs::set_current_path(path)) {
+                throw runtime_error{"cannot change directory to " + path.str() + ": " +
+                                    ec.message()};
+            }
+        }
+
+        ~WorkingDirectory()
+        {
+            sys::fs::set_current_path(previous);
+        }
+
+        WorkingDirectory(const WorkingDirectory &) = delete;
+        auto operator=(const WorkingDirectory &) -> WorkingDirectory & = delete;
+
+    private:
+        SmallString<128> previous;
+    };
+
+    void link_recovered(const LiftBenchOptions &options)
+    {
+        LinkContext ctx;
+        if (error_code ec = sys::fs::createUniqueDirectory("binrec_bench", ctx.work_dir)) {
+            throw runtime_error{"cannot create a link directory: " + ec.message()};
+        }
+
+        auto binary = object::createBinary("binary");
+        if (!binary) {
+            throw runtime_error{"cannot read the original binary: " +
+                                toString(binary.takeError())};
+        }
+        ctx.original_binary = move(*binary);
+        ctx.recovered_filename = string{destination} + ".o";
+        ctx.librt_filename = options.librt_filename;
+        ctx.ld_script_filename = options.ld_script_filename;
+        ctx.output_filename = destination;
+        if (sys::fs::exists("dependencies")) {
+            ctx.dependencies_filename = "dependencies";
+        }
+        ctx.harden = false;
+
+        Error err = run_link(ctx);
+        cleanup_link(ctx);
+        if (err) {
+            throw runtime_error{"cannot link the recovered binary: " + toString(move(err))};
+        }
+    }
+} // namespace
+
+void binrec::bench_lift(StringRef trace_dir, const LiftBenchOptions &options, BenchReport &report)
+{
+    // The trace directory of a project is <project>/s2e-out.
+    string project = sys::path::filename(sys::path::parent_path(trace_dir)).str();
+    string prefix = "lift/" + project + "/";
+    bool link = !options.librt_filename.empty() && !options.ld_script_filename.empty();
+
+    WorkingDirectory working_dir{trace_dir};
+    uint64_t captured_size = 0;
+    if (error_code ec = sys::fs::file_size("captured.bc", captured_size)) {
+        throw runtime_error{"cannot read " + trace_dir.str() + "/captured.bc: " + ec.message()};
+    }
+
+    for (unsigned i = 0; i < options.repetitions; ++i) {
+        LiftContext ctx;
+        ctx.trace_filename = "captured.bc";
+        ctx.destination = destination;
+        ctx.custom_helpers_filename = options.custom_helpers_filename;
+        ctx.optimize_better = options.optimize_better;
+        ctx.clean_names = true;
+        ctx.output = OutputPolicy::NONE;
+        ctx.jobs = options.jobs;
+        ctx.split_module = options.split_module;
+
+        // Every repetition parses the trace info, like a lift in a fresh process.
+        TraceInfoCache::get().clear();
+        PassProfiler profiler;
+        Stopwatch pipeline;
+        run_full_pipeline(ctx, &profiler);
+        Sample pipeline_sample = pipeline.stop();
+
+        // The stages share the peak of the pipeline, which is only reported once.
+        for (const PassProfiler::StageTotals &stage : profiler.stage_totals()) {
+            report.add(
+                prefix + stage.stage,
+                "bytes",
+                captured_size,
+                {stage.wall_seconds, stage.cpu_seconds, 0});
+        }
+        report.add(prefix + "full_pipeline", "bytes", captured_size, pipeline_sample);
+
+        if (link) {
+            Stopwatch linker;
+            link_recovered(options);
+            report.add(prefix + "link", "bytes", captured_size, linker.stop());
+        }
+
+        sys::fs::remove(string{destination} + ".o");
+        // The shards of a split module after the first.
+        for (unsigned part = 1;; ++part) {
+            string object = string{destination} + "." + to_string(part) + ".o";
+            if (!sys::fs::exists(object)) {
+                break;
+            }
+            sys::fs::remove(object);
+        }
+        sys::fs::remove(destination);
+    }
+}
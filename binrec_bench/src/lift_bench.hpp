@@ -0,0 +1,36 @@
+#ifndef BINREC_LIFT_BENCH_HPP
+#define BINREC_LIFT_BENCH_HPP
+
+#include "bench_report.hpp"
+#include <llvm/ADT/StringRef.h>
+#include <string>
+
+namespace binrec {
+    struct LiftBenchOptions {
+        std::string custom_helpers_filename;
+        /// The runtime library and linker script to link the recovered binary with. The link
+        /// stage is skipped unless both are set.
+        std::string librt_filename;
+        std::string ld_script_filename;
+        bool optimize_better;
+        bool split_module;
+        /// The number of threads of the sharded passes, 0 uses every core.
+        unsigned jobs;
+        unsigned repetitions;
+    };
+
+    /// Benchmark recovering a binary from the captured bitcode of a merged trace directory,
+    /// as `binrec.lift` does, once per stage: clean, link with the custom helpers, lift,
+    /// optimize, compile, emit the object, and link the recovered binary.
+    ///
+    /// The benchmarks are named lift/<project>/<stage> after the project of the trace
+    /// directory. The stages run in the trace directory, which must already contain the
+    /// symbols, sections, and dependencies extracted by a previous lift. The recovered files
+    /// are written as bench-recovered.o and bench-recovered and removed afterwards.
+    void bench_lift(
+        llvm::StringRef trace_dir,
+        const LiftBenchOptions &options,
+        BenchReport &report);
+} // namespace binrec
+
+#endif
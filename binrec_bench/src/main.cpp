@@ -0,0 +1,136 @@
+#include "bench_report.hpp"
+#include "lift_bench.hpp"
+#include "trace_info_bench.hpp"
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/raw_ostream.h>
+#include <stdexcept>
+
+using namespace llvm;
+using namespace llvm::cl;
+using namespace binrec;
+using namespace std;
+
+list<string> Trace_Dirs{
+    Positional,
+    ZeroOrMore,
+    desc{"<merged trace directory>..."},
+    value_desc{"directory"}};
+opt<string> Output_Filename{
+    "o",
+    desc{"Output report filename"},
+    init("binrec-bench.json"),
+    value_desc{"filename"}};
+opt<string> Baseline_Filename{
+    "baseline",
+    desc{"A previous report to compare the median wall times with"},
+    value_desc{"filename"}};
+opt<unsigned> Repetitions{"repeat", desc{"Number of repetitions of every benchmark"}, init(3)};
+
+opt<string> Custom_Helpers{
+    "custom-helpers",
+    desc{"Custom helpers bitcode linked in while lifting"},
+    value_desc{"filename"}};
+opt<string> Runtime_Library{
+    "runtime-library",
+    desc{"binrec runtime library to link the recovered binaries with"},
+    value_desc{"filename"}};
+opt<string> Linker_Script{
+    "linker-script",
+    desc{"Linker script to link the recovered binaries with"},
+    value_desc{"filename"}};
+opt<bool> Optimize_Better{"optimize-better", desc{"Optimize the lifted module better"}};
+opt<bool> Split_Module{
+    "split-module",
+    desc{"Optimize and compile shards of the lifted module in parallel"}};
+opt<unsigned> Jobs{"j", desc{"Number of threads (default: all cores)"}, init(0)};
+
+opt<size_t> Trace_Info_Size{
+    "trace-info-size",
+    desc{"Successors and memory accesses of every synthetic trace info (0 skips them)"},
+    init(100000)};
+opt<size_t> Merge_Inputs{
+    "merge-inputs",
+    desc{"Number of synthetic trace info files to merge"},
+    init(4)};
+opt<TraceInfoFormat> Merge_Format{
+    "merge-format",
+    desc{"Format of the synthetic trace info files to merge"},
+    values(
+        clEnumValN(TraceInfoFormat::Json, "json", "(default) JSON, written by the plugins"),
+        clEnumValN(TraceInfoFormat::Binary, "binary", "The binary format")),
+    init(TraceInfoFormat::Json)};
+
+
+auto main(int argc, char *argv[]) -> int
+{
+    InitLLVM init_llvm{argc, argv};
+    ParseCommandLineOptions(
+        argc,
+        argv,
+        "BinRec benchmarks\n\n"
+        "Lifts the captured bitcode of merged trace directories and merges synthetic trace "
+        "info, and writes the time and memory use of every stage as JSON.\n");
+
+    if (!Trace_Dirs.empty() && Custom_Helpers.empty()) {
+        errs() << "-custom-helpers is required to lift trace directories\n";
+        return 1;
+    }
+
+    BenchReport report;
+    report.set_parameter("repetitions", to_string(Repetitions));
+    report.set_parameter("jobs", to_string(Jobs));
+    report.set_parameter("optimize_better", Optimize_Better ? "true" : "false");
+    report.set_parameter("split_module", Split_Module ? "true" : "false");
+    report.set_parameter("trace_info_size", to_string(Trace_Info_Size));
+    report.set_parameter("merge_inputs", to_string(Merge_Inputs));
+    report.set_parameter("merge_format", Merge_Format == TraceInfoFormat::Json ? "json" : "binary");
+
+    LiftBenchOptions lift_options;
+    lift_options.custom_helpers_filename = Custom_Helpers;
+    lift_options.librt_filename = Runtime_Library;
+    lift_options.ld_script_filename = Linker_Script;
+    lift_options.optimize_better = Optimize_Better;
+    lift_options.split_module = Split_Module;
+    lift_options.jobs = Jobs;
+    lift_options.repetitions = Repetitions;
+
+    for (const string &trace_dir : Trace_Dirs) {
+        outs() << "lifting " << trace_dir << '\n';
+        try {
+            bench_lift(trace_dir, lift_options, report);
+        } catch (runtime_error &error) {
+            errs() << trace_dir << ": " << error.what() << '\n';
+            return 1;
+        }
+    }
+
+    if (Trace_Info_Size > 0) {
+        outs() << "merging trace info\n";
+        TraceInfoBenchOptions trace_info_options{
+            Trace_Info_Size,
+            Merge_Inputs,
+            Merge_Format,
+            Jobs,
+            Repetitions};
+        if (Error err = bench_trace_info(trace_info_options, report)) {
+            errs() << "trace info: " << toString(move(err)) << '\n';
+            return 1;
+        }
+    }
+
+    error_code ec;
+    raw_fd_ostream output{Output_Filename, ec, sys::fs::OF_Text};
+    if (ec) {
+        errs() << Output_Filename << ": " << ec.message() << '\n';
+        return 1;
+    }
+    report.write_json(output);
+
+    if (Error err = report.print_summary(outs(), Baseline_Filename)) {
+        errs() << Baseline_Filename << ": " << toString(move(err)) << '\n';
+        return 1;
+    }
+    return 0;
+}
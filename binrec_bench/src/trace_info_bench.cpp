@@ -0,0 +1,150 @@
+#include "trace_info_bench.hpp"
+#include "binrec/tracing/synthetic_trace_info.hpp"
+#include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_parallel_merge.hpp"
+#include "binrec/tracing/trace_info_stream_merge.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace binrec;
+using namespace llvm;
+using namespace std;
+
+namespace {
+    auto save(const string &path, const TraceInfo &ti, TraceInfoFormat format) -> Error
+    {
+        if (!saveTraceInfo(path, ti, format)) {
+            return createStringError(inconvertibleErrorCode(), "cannot write " + path);
+        }
+        return Error::success();
+    }
+
+    /// Add repetitions of body, which returns false if it failed with error, to the report.
+    template <typename Body>
+    auto measure_checked(
+        BenchReport &report,
+        const string &name,
+        uint64_t items,
+        unsigned repetitions,
+        const string &error,
+        Body body) -> Error
+    {
+        for (unsigned i = 0; i < repetitions; ++i) {
+            Stopwatch stopwatch;
+            if (!body()) {
+                return createStringError(inconvertibleErrorCode(), error);
+            }
+            report.add(name, "entries", items, stopwatch.stop());
+        }
+        return Error::success();
+    }
+
+    auto bench_round_trip(
+        const TraceInfoBenchOptions &options,
+        const TraceInfo &ti,
+        TraceInfoFormat format,
+        const string &path,
+        BenchReport &report) -> Error
+    {
+        string prefix = format == TraceInfoFormat::Json ? "trace_info/json" : "trace_info/binary";
+        uint64_t items = options.size * 2;
+        unsigned repetitions = options.repetitions;
+
+        string error = "cannot write " + path;
+        Error err = measure_checked(report, prefix + "/save", items, repetitions, error, [&] {
+            return saveTraceInfo(path, ti, format);
+        });
+        if (err) {
+            return err;
+        }
+
+        error = "cannot read " + path;
+        return measure_checked(report, prefix + "/load", items, repetitions, error, [&] {
+            TraceInfo loaded;
+            return loadTraceInfo(path, loaded);
+        });
+    }
+
+    auto bench_merges(
+        const TraceInfoBenchOptions &options,
+        const vector<string> &paths,
+        BenchReport &report) -> Error
+    {
+        uint64_t items = options.size * 2 * paths.size();
+        unsigned repetitions = options.repetitions;
+        string prefix = options.format == TraceInfoFormat::Json ? "trace_merge/json"
+                                                                : "trace_merge/binary";
+        string error = "cannot merge trace info";
+        unsigned jobs = options.jobs ? options.jobs : thread::hardware_concurrency();
+
+        // The default mode of binrec_tracemerge, which loads the inputs one at a time.
+        Error err = measure_checked(report, prefix + "/serial", items, repetitions, error, [&] {
+            TraceInfo merged;
+            for (const string &path : paths) {
+                TraceInfo ti;
+                if (!loadTraceInfo(path, ti)) {
+                    return false;
+                }
+                merged.add(ti);
+            }
+            return true;
+        });
+        if (err) {
+            return err;
+        }
+
+        err = measure_checked(report, prefix + "/parallel", items, repetitions, error, [&] {
+            TraceInfo merged;
+            return parallelMergeTraceInfo(paths, jobs, merged);
+        });
+        if (err) {
+            return err;
+        }
+
+        return measure_checked(report, prefix + "/stream", items, repetitions, error, [&] {
+            TraceInfo merged;
+            return streamMergeTraceInfo(paths, merged);
+        });
+    }
+} // namespace
+
+auto binrec::bench_trace_info(const TraceInfoBenchOptions &options, BenchReport &report) -> Error
+{
+    SmallString<128> work_dir;
+    if (error_code ec = sys::fs::createUniqueDirectory("binrec_bench", work_dir)) {
+        return errorCodeToError(ec);
+    }
+    auto path = [&](const Twine &name) {
+        SmallString<128> result = work_dir;
+        sys::path::append(result, name);
+        return string{result};
+    };
+
+    Error err = [&]() -> Error {
+        TraceInfo ti = syntheticTraceInfo(options.size, 0);
+        for (TraceInfoFormat format : {TraceInfoFormat::Json, TraceInfoFormat::Binary}) {
+            string filename = path(Twine{"round_trip"} + traceInfoSuffix(format));
+            if (Error err = bench_round_trip(options, ti, format, filename, report)) {
+                return err;
+            }
+        }
+
+        // Only one input is kept in memory at a time.
+        vector<string> inputs;
+        for (size_t i = 0; i < options.inputs; ++i) {
+            inputs.push_back(path(Twine{"input"} + Twine{i} + traceInfoSuffix(options.format)));
+            TraceInfo input = syntheticTraceInfo(options.size, i + 1);
+            if (Error err = save(inputs.back(), input, options.format)) {
+                return err;
+            }
+        }
+        return bench_merges(options, inputs, report);
+    }();
+
+    sys::fs::remove_directories(work_dir);
+    return err;
+}
@@ -0,0 +1,29 @@
+#ifndef BINREC_TRACE_INFO_BENCH_HPP
+#define BINREC_TRACE_INFO_BENCH_HPP
+
+#include "bench_report.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include <cstddef>
+#include <llvm/Support/Error.h>
+
+namespace binrec {
+    struct TraceInfoBenchOptions {
+        /// The number of successors and memory accesses of every synthetic trace info.
+        size_t size;
+        /// The number of trace info files that are merged.
+        size_t inputs;
+        /// The format of the merged files.
+        TraceInfoFormat format;
+        /// The number of threads of the parallel merge, 0 uses every core.
+        unsigned jobs;
+        unsigned repetitions;
+    };
+
+    /// Benchmark JSON and binary round trips of a synthetic trace info, and the serial,
+    /// parallel, and streaming merges of binrec_tracemerge on synthetic inputs. The inputs are
+    /// generated from fixed seeds, so every run measures the same files.
+    auto bench_trace_info(const TraceInfoBenchOptions &options, BenchReport &report)
+        -> llvm::Error;
+} // namespace binrec
+
+#endif
@@ -5,6 +5,11 @@
 using namespace binrec;
 using namespace llvm;
 
+AddCustomHelperVarsPass::AddCustomHelperVarsPass(unsigned debug_verbosity) :
+        debug_verbosity{debug_verbosity}
+{
+}
+
 // NOLINTNEXTLINE
 auto AddCustomHelperVarsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
@@ -14,7 +19,7 @@ auto AddCustomHelperVarsPass::run(Module &m, ModuleAnalysisManager &am) -> Prese
         ty,
         true,
         GlobalValue::ExternalLinkage,
-        ConstantInt::get(ty, debugVerbosity),
+        ConstantInt::get(ty, debug_verbosity),
         "debug_verbosity");
 
     return PreservedAnalyses::all();
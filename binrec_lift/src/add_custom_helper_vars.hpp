@@ -7,7 +7,13 @@ namespace binrec {
     /// S2E Insert variables that can be used by custom helpers
     class AddCustomHelperVarsPass : public llvm::PassInfoMixin<AddCustomHelperVarsPass> {
     public:
+        /// The custom helpers read debug_verbosity from @debug_verbosity.
+        explicit AddCustomHelperVarsPass(unsigned debug_verbosity);
+
         auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> llvm::PreservedAnalyses;
+
+    private:
+        unsigned debug_verbosity;
     };
 } // namespace binrec
 
@@ -0,0 +1,87 @@
+#include "block_registry.hpp"
+
+using namespace binrec;
+using namespace llvm;
+using namespace std;
+
+AnalysisKey BlockRegistryAnalysis::Key;
+
+namespace {
+    /// Parse the pc of a name with the given prefix. Names with a suffix, such as those of
+    /// clones, are not blocks.
+    auto parse_pc(const Value &v, StringRef prefix, uint32_t &pc) -> bool
+    {
+        if (!v.hasName()) {
+            return false;
+        }
+        StringRef name = v.getName();
+        return name.consume_front(prefix) && !name.getAsInteger(16, pc);
+    }
+} // namespace
+
+BlockRegistry::BlockRegistry(Module &m)
+{
+    for (Function &f : m) {
+        insert(f);
+    }
+}
+
+auto BlockRegistry::function(uint32_t pc) const -> Function *
+{
+    return functions.lookup(pc);
+}
+
+auto BlockRegistry::block(const Function &f, uint32_t pc) const -> BasicBlock *
+{
+    return blocks.lookup({&f, pc});
+}
+
+void BlockRegistry::insert(Function &f)
+{
+    uint32_t pc = 0;
+    if (parse_pc(f, "Func_", pc)) {
+        functions[pc] = &f;
+    }
+    for (BasicBlock &bb : f) {
+        insert(bb);
+    }
+}
+
+void BlockRegistry::insert(BasicBlock &bb)
+{
+    uint32_t pc = 0;
+    if (parse_pc(bb, "BB_", pc)) {
+        blocks[{bb.getParent(), pc}] = &bb;
+    }
+}
+
+void BlockRegistry::erase(Function &f)
+{
+    uint32_t pc = 0;
+    if (parse_pc(f, "Func_", pc)) {
+        auto it = functions.find(pc);
+        if (it != functions.end() && it->second == &f) {
+            functions.erase(it);
+        }
+    }
+    for (BasicBlock &bb : f) {
+        erase(bb);
+    }
+}
+
+void BlockRegistry::erase(BasicBlock &bb)
+{
+    uint32_t pc = 0;
+    if (parse_pc(bb, "BB_", pc)) {
+        auto it = blocks.find({bb.getParent(), pc});
+        if (it != blocks.end() && it->second == &bb) {
+            blocks.erase(it);
+        }
+    }
+}
+
+// NOLINTNEXTLINE
+auto BlockRegistryAnalysis::run(Module &m, ModuleAnalysisManager &am) -> Result
+{
+    return BlockRegistry{m};
+}
@@ -0,0 +1,53 @@
+#ifndef BINREC_BLOCK_REGISTRY_HPP
+#define BINREC_BLOCK_REGISTRY_HPP
+
+#include <cstdint>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassManager.h>
+#include <utility>
+
+namespace binrec {
+    /// Recovered blocks of a module indexed by guest pc.
+    ///
+    /// Captured blocks are functions named Func_<pc>, and the blocks of recovered functions and
+    /// of the wrapper are basic blocks named BB_<pc>. The registry is built from these names
+    /// once, so passes can look blocks up by pc without formatting names or scanning functions.
+    ///
+    /// Passes that rename, create, or erase blocks must either update the registry through
+    /// insert and erase and preserve BlockRegistryAnalysis, or not preserve it at all.
+    class BlockRegistry {
+    public:
+        explicit BlockRegistry(llvm::Module &m);
+
+        /// The function Func_<pc>, or null if there is none.
+        [[nodiscard]] auto function(uint32_t pc) const -> llvm::Function *;
+        /// The basic block BB_<pc> of f, or null if there is none.
+        [[nodiscard]] auto block(const llvm::Function &f, uint32_t pc) const
+            -> llvm::BasicBlock *;
+
+        /// Register f under the pc in its name, if it is named Func_<pc>.
+        void insert(llvm::Function &f);
+        /// Register bb under the pc in its name, if it is named BB_<pc>.
+        void insert(llvm::BasicBlock &bb);
+        /// Remove f and all of its blocks. Must be called before f is renamed or erased.
+        void erase(llvm::Function &f);
+        /// Remove bb. Must be called before bb is renamed or erased.
+        void erase(llvm::BasicBlock &bb);
+
+    private:
+        llvm::DenseMap<uint32_t, llvm::Function *> functions;
+        llvm::DenseMap<std::pair<const llvm::Function *, uint32_t>, llvm::BasicBlock *> blocks;
+    };
+
+    class BlockRegistryAnalysis : public llvm::AnalysisInfoMixin<BlockRegistryAnalysis> {
+        friend llvm::AnalysisInfoMixin<BlockRegistryAnalysis>;
+        static llvm::AnalysisKey Key; // NOLINT
+
+    public:
+        using Result = BlockRegistry;
+        auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> Result;
+    };
+} // namespace binrec
+
+#endif
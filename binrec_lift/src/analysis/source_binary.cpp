@@ -0,0 +1,38 @@
+#include "source_binary.hpp"
+#include "error.hpp"
+#include "section_utils.hpp"
+
+#define PASS_NAME "source_binary"
+
+using namespace binrec;
+using namespace llvm;
+using namespace llvm::object;
+using namespace std;
+
+AnalysisKey SourceBinaryAnalysis::Key;
+
+SourceBinary::SourceBinary(const string &path)
+{
+    // The file is memory mapped, so sections are only read from disk when they are accessed.
+    Expected<OwningBinary<Binary>> binary_or_err = createBinary(path);
+    if (Error err = binary_or_err.takeError()) {
+        LLVM_ERROR(error) << "could not open " << path << ": " << err;
+        throw lifting_error{PASS_NAME, error};
+    }
+    binary = move(*binary_or_err);
+}
+
+auto SourceBinary::elf() const -> const ELFObjectFileBase &
+{
+    const auto *elf = dyn_cast<ELFObjectFileBase>(binary.getBinary());
+    if (!elf) {
+        throw lifting_error{PASS_NAME, "source binary is not an ELF file"};
+    }
+    return *elf;
+}
+
+// NOLINTNEXTLINE
+auto SourceBinaryAnalysis::run(Module &m, ModuleAnalysisManager &am) -> Result
+{
+    return SourceBinary{getSourcePath(m)};
+}
@@ -0,0 +1,44 @@
+#ifndef BINREC_SOURCE_BINARY_HPP
+#define BINREC_SOURCE_BINARY_HPP
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Object/ELFObjectFile.h>
+#include <string>
+
+namespace binrec {
+    /// The original binary of a module, mapped into memory once and shared by all passes that
+    /// read its symbols.
+    ///
+    /// The file is parsed when the analysis first runs. The binary does not change while
+    /// lifting, so the result stays valid until the analysis manager is destroyed.
+    class SourceBinary {
+    public:
+        explicit SourceBinary(const std::string &path);
+
+        /// The binary as an ELF file. Throws a lifting error if it is not one.
+        [[nodiscard]] auto elf() const -> const llvm::object::ELFObjectFileBase &;
+
+        auto invalidate(
+            llvm::Module &m,
+            const llvm::PreservedAnalyses &pa,
+            llvm::ModuleAnalysisManager::Invalidator &inv) -> bool
+        {
+            return false;
+        }
+
+    private:
+        llvm::object::OwningBinary<llvm::object::Binary> binary;
+    };
+
+    class SourceBinaryAnalysis : public llvm::AnalysisInfoMixin<SourceBinaryAnalysis> {
+        friend llvm::AnalysisInfoMixin<SourceBinaryAnalysis>;
+        static llvm::AnalysisKey Key; // NOLINT
+
+    public:
+        using Result = SourceBinary;
+        auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> Result;
+    };
+} // namespace binrec
+
+#endif
@@ -0,0 +1,125 @@
+#include "successor_graph.hpp"
+#include "meta_utils.hpp"
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Metadata.h>
+
+using namespace binrec;
+using namespace llvm;
+using namespace std;
+
+AnalysisKey SuccessorGraphAnalysis::Key;
+
+namespace {
+    auto edge_kind(const MDNode *kinds, unsigned i) -> EdgeKind
+    {
+        if (!kinds || i >= kinds->getNumOperands()) {
+            return EdgeKind::TRACED;
+        }
+        auto *kind = mdconst::dyn_extract_or_null<ConstantInt>(kinds->getOperand(i));
+        return kind ? static_cast<EdgeKind>(kind->getZExtValue()) : EdgeKind::TRACED;
+    }
+} // namespace
+
+SuccessorGraph::SuccessorGraph(Module &m)
+{
+    for (Function &f : m) {
+        for (BasicBlock &bb : f) {
+            Instruction *term = bb.getTerminator();
+            MDNode *md = term ? term->getMetadata("succs") : nullptr;
+            if (!md) {
+                continue;
+            }
+            MDNode *kinds = term->getMetadata("succs_kind");
+            if (kinds && kinds->getNumOperands() != md->getNumOperands()) {
+                kinds = nullptr;
+            }
+
+            EdgeList &edges = lists[&bb];
+            edges.reserve(md->getNumOperands());
+            for (unsigned i = 0, e = md->getNumOperands(); i < e; ++i) {
+                auto *successor = dyn_cast_or_null<ValueAsMetadata>(md->getOperand(i).get());
+                if (!successor) {
+                    // The successor was erased, drop it when the list is written back.
+                    changed.insert(&bb);
+                    continue;
+                }
+                BasicBlock *succ = nullptr;
+                if (auto *succ_f = dyn_cast<Function>(successor->getValue())) {
+                    succ = &succ_f->getEntryBlock();
+                } else if (auto *address = dyn_cast<BlockAddress>(successor->getValue())) {
+                    succ = address->getBasicBlock();
+                } else {
+                    continue;
+                }
+                edges.push_back({succ, edge_kind(kinds, i)});
+            }
+        }
+    }
+}
+
+auto SuccessorGraph::successors(const BasicBlock &bb) const -> ArrayRef<SuccessorEdge>
+{
+    auto it = lists.find(&bb);
+    return it == lists.end() ? ArrayRef<SuccessorEdge>{} : ArrayRef<SuccessorEdge>{it->second};
+}
+
+auto SuccessorGraph::successor_blocks(const BasicBlock &bb, vector<BasicBlock *> &succs) const
+    -> bool
+{
+    succs.clear();
+    for (const SuccessorEdge &edge : successors(bb)) {
+        succs.push_back(edge.block);
+    }
+    return !succs.empty();
+}
+
+void SuccessorGraph::add(BasicBlock &bb, BasicBlock &succ, EdgeKind kind)
+{
+    lists[&bb].push_back({&succ, kind});
+    changed.insert(&bb);
+}
+
+void SuccessorGraph::set(BasicBlock &bb, ArrayRef<BasicBlock *> succs, EdgeKind kind)
+{
+    EdgeList &edges = lists[&bb];
+    edges.clear();
+    for (BasicBlock *succ : succs) {
+        edges.push_back({succ, kind});
+    }
+    changed.insert(&bb);
+}
+
+void SuccessorGraph::materialize()
+{
+    for (BasicBlock *bb : changed) {
+        ArrayRef<SuccessorEdge> edges = successors(*bb);
+        LLVMContext &ctx = bb->getContext();
+        Type *kind_type = Type::getInt32Ty(ctx);
+
+        vector<Metadata *> operands;
+        vector<Metadata *> kinds;
+        bool traced = true;
+        operands.reserve(edges.size());
+        kinds.reserve(edges.size());
+        for (const SuccessorEdge &edge : edges) {
+            Function *succ_f = edge.block->getParent();
+            Value *successor = &succ_f->getEntryBlock() == edge.block
+                ? cast<Value>(succ_f)
+                : BlockAddress::get(succ_f, edge.block);
+            operands.push_back(ValueAsMetadata::get(successor));
+            kinds.push_back(ConstantAsMetadata::get(
+                ConstantInt::get(kind_type, static_cast<uint32_t>(edge.kind))));
+            traced &= edge.kind == EdgeKind::TRACED;
+        }
+
+        setBlockMeta(bb, "succs", operands.empty() ? nullptr : MDNode::get(ctx, operands));
+        setBlockMeta(bb, "succs_kind", traced ? nullptr : MDNode::get(ctx, kinds));
+    }
+    changed.clear();
+}
+
+// NOLINTNEXTLINE
+auto SuccessorGraphAnalysis::run(Module &m, ModuleAnalysisManager &am) -> Result
+{
+    return SuccessorGraph{m};
+}
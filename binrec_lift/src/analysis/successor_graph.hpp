@@ -0,0 +1,73 @@
+#ifndef BINREC_SUCCESSOR_GRAPH_HPP
+#define BINREC_SUCCESSOR_GRAPH_HPP
+
+#include <cstdint>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassManager.h>
+
+namespace binrec {
+    /// How a successor edge was recovered.
+    enum class EdgeKind : uint32_t {
+        /// The edge was recorded in the trace info.
+        TRACED,
+        /// The edge was derived from the function log, such as the follow up block of a call.
+        INFERRED,
+        /// The edge was added by fallback recovery of code that was not traced.
+        FALLBACK,
+    };
+
+    struct SuccessorEdge {
+        llvm::BasicBlock *block;
+        EdgeKind kind;
+    };
+
+    /// Successor lists of recovered blocks.
+    ///
+    /// Between passes, and in bitcode, the successors of a block are stored as "succs" metadata on
+    /// its terminator (see getBlockSuccs), and the kinds of edges that were not traced as a
+    /// parallel "succs_kind" tuple. The graph reads all lists once into adjacency arrays, so they
+    /// are edited without uniquing a new metadata tuple for every change, and materialize writes
+    /// the lists of changed blocks back. The successors of a captured function are those of its
+    /// entry block.
+    class SuccessorGraph {
+    public:
+        explicit SuccessorGraph(llvm::Module &m);
+
+        /// The successors of bb, in order. Empty if bb has no successor list.
+        [[nodiscard]] auto successors(const llvm::BasicBlock &bb) const
+            -> llvm::ArrayRef<SuccessorEdge>;
+        /// Copy the successor blocks of bb into succs and return whether there are any.
+        auto successor_blocks(const llvm::BasicBlock &bb, std::vector<llvm::BasicBlock *> &succs)
+            const -> bool;
+
+        /// Append an edge to the successors of bb.
+        void add(llvm::BasicBlock &bb, llvm::BasicBlock &succ, EdgeKind kind);
+        /// Replace the successors of bb.
+        void set(llvm::BasicBlock &bb, llvm::ArrayRef<llvm::BasicBlock *> succs, EdgeKind kind);
+
+        /// Write the successor lists of all changed blocks to their metadata. Empty lists remove
+        /// the metadata.
+        void materialize();
+
+    private:
+        using EdgeList = llvm::SmallVector<SuccessorEdge, 2>;
+
+        llvm::DenseMap<const llvm::BasicBlock *, EdgeList> lists;
+        llvm::SetVector<llvm::BasicBlock *> changed;
+    };
+
+    class SuccessorGraphAnalysis : public llvm::AnalysisInfoMixin<SuccessorGraphAnalysis> {
+        friend llvm::AnalysisInfoMixin<SuccessorGraphAnalysis>;
+        static llvm::AnalysisKey Key; // NOLINT
+
+    public:
+        using Result = SuccessorGraph;
+        auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> Result;
+    };
+} // namespace binrec
+
+#endif
@@ -1,6 +1,8 @@
 #include "trace_info_analysis.hpp"
 #include "pass_utils.hpp"
-#include <fstream>
+#include "binrec/tracing/trace_info_binary.hpp"
+#include "binrec/tracing/trace_info_journal.hpp"
+#include <llvm/Support/FileSystem.h>
 
 using namespace binrec;
 using namespace llvm;
@@ -8,14 +10,28 @@ using namespace std;
 
 AnalysisKey TraceInfoAnalysis::Key;
 
+auto binrec::findTraceInfo(const std::string &name) -> std::string
+{
+    for (const char *suffix :
+         {TraceInfo::binarySuffix, TraceInfo::defaultSuffix, TraceInfoJournal::suffix})
+    {
+        std::string path = s2eOutFile(name + suffix);
+        if (sys::fs::exists(path)) {
+            return path;
+        }
+    }
+    return {};
+}
+
+void binrec::readTraceInfo(const std::string &name, TraceInfo &ti)
+{
+    std::string path = findTraceInfo(name);
+    failUnless(!path.empty(), "could not find trace info " + name);
+    failUnless(loadTraceInfo(path, ti), "could not read " + path);
+}
+
 // NOLINTNEXTLINE
-auto binrec::TraceInfoAnalysis::run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> TraceInfo
+auto binrec::TraceInfoAnalysis::run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> Result
 {
-    TraceInfo ti;
-    ifstream f;
-    s2eOpen(f, TraceInfo::defaultFilename);
-    if (!f)
-        return {};
-    f >> ti;
-    return ti;
+    return TraceInfoCache::get().load(TraceInfo::defaultName);
 }
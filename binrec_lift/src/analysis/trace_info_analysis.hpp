@@ -1,17 +1,28 @@
 #ifndef BINREC_TRACE_INFO_ANALYSIS_HPP
 #define BINREC_TRACE_INFO_ANALYSIS_HPP
 
+#include "trace_info_cache.hpp"
 #include "binrec/tracing/trace_info.hpp"
 #include <llvm/IR/PassManager.h>
+#include <memory>
+#include <string>
 
 namespace binrec {
+    /// Find the trace info file with the given base name (e.g. "traceInfo") in the S2E output
+    /// directory. The binary format is preferred over JSON, which is preferred over a journal.
+    /// Returns an empty string if there is no such file.
+    auto findTraceInfo(const std::string &name) -> std::string;
+    /// Read the trace info with the given base name, see findTraceInfo.
+    void readTraceInfo(const std::string &name, TraceInfo &ti);
+
+    /// The default trace info of the S2E output directory, shared through the TraceInfoCache.
     class TraceInfoAnalysis : public llvm::AnalysisInfoMixin<TraceInfoAnalysis> {
         friend llvm::AnalysisInfoMixin<TraceInfoAnalysis>;
         static llvm::AnalysisKey Key; // NOLINT
 
     public:
-        using Result = TraceInfo;
-        auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> TraceInfo;
+        using Result = std::shared_ptr<const CachedTraceInfo>;
+        auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> Result;
     };
 } // namespace binrec
 
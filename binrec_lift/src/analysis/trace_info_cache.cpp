@@ -0,0 +1,107 @@
+#include "trace_info_cache.hpp"
+#include "pass_utils.hpp"
+#include "trace_info_analysis.hpp"
+#include "utils/function_info.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+
+using namespace binrec;
+using namespace llvm;
+using namespace std;
+
+namespace {
+    /// Sort all sets up front, since sets are otherwise sorted on their first read, which is not
+    /// safe while they are shared between threads.
+    void normalize(TraceInfo &ti)
+    {
+        ti.successors.normalize();
+        FunctionLog &log = ti.functionLog;
+        log.entryToCaller.normalize();
+        log.entryToReturn.normalize();
+        log.callerToFollowUp.normalize();
+        for (auto &entry : log.entryToTbs) {
+            entry.second.normalize();
+        }
+    }
+} // namespace
+
+CachedTraceInfo::CachedTraceInfo(TraceInfo ti) : ti{std::move(ti)}
+{
+    normalize(this->ti);
+}
+
+CachedTraceInfo::~CachedTraceInfo() = default;
+
+auto CachedTraceInfo::trace_info() const -> const TraceInfo &
+{
+    return ti;
+}
+
+auto CachedTraceInfo::function_info() const -> const FunctionInfo &
+{
+    call_once(function_info_built, [this] { fi = make_unique<FunctionInfo>(ti); });
+    return *fi;
+}
+
+auto CachedTraceInfo::successors() const -> const FlatMap<uint32_t, FlatSet<uint32_t>> &
+{
+    call_once(successors_built, [this] {
+        // The successors are sorted by pc and then by successor, so both the map and every set
+        // are built by appending.
+        for (const Successor &successor : ti.successors) {
+            auto pc = static_cast<uint32_t>(successor.pc);
+            successor_map.emplace_hint(successor_map.end(), pc)
+                ->second.insert(static_cast<uint32_t>(successor.successor));
+        }
+    });
+    return successor_map;
+}
+
+auto TraceInfoCache::get() -> TraceInfoCache &
+{
+    static TraceInfoCache cache;
+    return cache;
+}
+
+auto TraceInfoCache::load(const std::string &name) -> shared_ptr<const CachedTraceInfo>
+{
+    SmallString<128> path{findTraceInfo(name)};
+    failUnless(!path.empty(), "could not find trace info " + name);
+    sys::fs::make_absolute(path);
+
+    sys::fs::file_status status;
+    failUnless(!sys::fs::status(path, status), "could not read " + path.str().str());
+    sys::TimePoint<> modified = status.getLastModificationTime();
+    uint64_t size = status.getSize();
+
+    {
+        lock_guard<std::mutex> lock{mutex};
+        auto it = entries.find(path.str().str());
+        if (it != entries.end() && it->second.modified == modified && it->second.size == size) {
+            if (shared_ptr<const CachedTraceInfo> trace = it->second.trace.lock()) {
+                return trace;
+            }
+        }
+    }
+
+    // Parse without holding the lock, so different files are parsed concurrently.
+    TraceInfo ti;
+    failUnless(loadTraceInfo(path.str().str(), ti), "could not read " + path.str().str());
+    auto trace = make_shared<const CachedTraceInfo>(std::move(ti));
+
+    lock_guard<std::mutex> lock{mutex};
+    // Replace the entry of an older version of the file and drop the entries of trace info that
+    // was freed.
+    entries[path.str().str()] = Entry{modified, size, trace};
+    for (auto it = entries.begin(); it != entries.end();) {
+        it = it->second.trace.expired() ? entries.erase(it) : next(it);
+    }
+    return trace;
+}
+
+void TraceInfoCache::clear()
+{
+    lock_guard<std::mutex> lock{mutex};
+    entries.clear();
+}
@@ -0,0 +1,73 @@
+#ifndef BINREC_TRACE_INFO_CACHE_HPP
+#define BINREC_TRACE_INFO_CACHE_HPP
+
+#include "binrec/flat_map.hpp"
+#include "binrec/flat_set.hpp"
+#include "binrec/tracing/trace_info.hpp"
+#include <cstdint>
+#include <llvm/Support/Chrono.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace binrec {
+    struct FunctionInfo;
+
+    /// Trace info read from one file together with the indexes derived from it. The trace info
+    /// is never modified after it was read, and every index is built once, on first use, so the
+    /// same instance can be shared by all passes and threads.
+    class CachedTraceInfo {
+    public:
+        explicit CachedTraceInfo(TraceInfo ti);
+        ~CachedTraceInfo();
+
+        CachedTraceInfo(const CachedTraceInfo &) = delete;
+        CachedTraceInfo(CachedTraceInfo &&) = delete;
+        auto operator=(const CachedTraceInfo &) -> CachedTraceInfo & = delete;
+        auto operator=(CachedTraceInfo &&) -> CachedTraceInfo & = delete;
+
+        [[nodiscard]] auto trace_info() const -> const TraceInfo &;
+        /// The function log indexed by function entry, caller, and block pcs.
+        [[nodiscard]] auto function_info() const -> const FunctionInfo &;
+        /// The recorded successor pcs of every block pc.
+        [[nodiscard]] auto successors() const -> const FlatMap<uint32_t, FlatSet<uint32_t>> &;
+
+    private:
+        TraceInfo ti;
+        mutable std::once_flag function_info_built;
+        mutable std::unique_ptr<FunctionInfo> fi;
+        mutable std::once_flag successors_built;
+        mutable FlatMap<uint32_t, FlatSet<uint32_t>> successor_map;
+    };
+
+    /// Process wide cache of parsed trace info files.
+    ///
+    /// A file is parsed once and handed out while it is in use and unchanged on disk, so the
+    /// passes of a lift run, the stages of run_full_pipeline, and the captures of a merge that
+    /// share a journal all share one parse. The cache does not keep trace info alive on its own:
+    /// it is freed once the last user releases it, so the trace info of earlier operations of
+    /// the Python extension does not accumulate.
+    class TraceInfoCache {
+    public:
+        static auto get() -> TraceInfoCache &;
+
+        /// Load the trace info with the given base name, see findTraceInfo. The file is parsed
+        /// again if it changed since it was cached or if the cached trace info was freed.
+        auto load(const std::string &name) -> std::shared_ptr<const CachedTraceInfo>;
+        /// Drop all cached trace info. Trace info that is still in use stays valid.
+        void clear();
+
+    private:
+        struct Entry {
+            llvm::sys::TimePoint<> modified;
+            uint64_t size;
+            std::weak_ptr<const CachedTraceInfo> trace;
+        };
+
+        std::mutex mutex;
+        std::map<std::string, Entry> entries;
+    };
+} // namespace binrec
+
+#endif
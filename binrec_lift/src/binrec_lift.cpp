@@ -1,6 +1,9 @@
 #include "binrec_lift.hpp"
 #include "add_custom_helper_vars.hpp"
+#include "analysis/block_registry.hpp"
 #include "analysis/env_alias_analysis.hpp"
+#include "analysis/source_binary.hpp"
+#include "analysis/successor_graph.hpp"
 #include "analysis/trace_info_analysis.hpp"
 #include "debug/call_tracer.hpp"
 #include "error.hpp"
@@ -51,15 +54,27 @@
 #include "tag_inst_pc.hpp"
 #include "utils/intrinsic_cleaner.hpp"
 #include "utils/name_cleaner.hpp"
+#include "utils/sharded_pipeline.hpp"
 #include <llvm/ADT/Triple.h>
 #include <llvm/Analysis/GlobalsModRef.h>
 #include <llvm/Analysis/MemorySSA.h>
 #include <llvm/Analysis/OptimizationRemarkEmitter.h>
 #include <llvm/Bitcode/BitcodeWriterPass.h>
+#include <llvm/CodeGen/ParallelCG.h>
+#include <llvm/IR/DiagnosticInfo.h>
+#include <llvm/IR/DiagnosticPrinter.h>
 #include <llvm/IR/IRPrintingPasses.h>
+#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Passes/OptimizationLevel.h>
 #include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/IPO/GlobalDCE.h>
 #include <llvm/Transforms/IPO/GlobalOpt.h>
@@ -72,8 +87,174 @@ using namespace llvm;
 using namespace llvm::cl;
 using namespace std;
 
-namespace binrec {
+namespace {
+    auto open_output(const string &filename) -> unique_ptr<raw_fd_ostream>
+    {
+        error_code ec;
+        auto output = make_unique<raw_fd_ostream>(filename, ec);
+        if (ec) {
+            LLVM_ERROR(error) << "failed to open file " << filename << ": " << ec.message();
+            throw runtime_error{error};
+        }
+        return output;
+    }
+
+    /// Collect error diagnostics instead of letting LLVM exit the process.
+    void collect_diagnostic(const DiagnosticInfo &info, void *context)
+    {
+        if (info.getSeverity() != DS_Error) {
+            return;
+        }
+        raw_string_ostream os{*static_cast<string *>(context)};
+        DiagnosticPrinterRawOStream printer{os};
+        info.print(printer);
+        os << '\n';
+    }
+
+    auto parse_module(const string &filename, LLVMContext &context) -> unique_ptr<Module>
+    {
+        SMDiagnostic err;
+        unique_ptr<Module> module = parseIRFile(filename, err, context);
+        if (!module) {
+            string error;
+            raw_string_ostream error_stream{error};
+            err.print("binrec-lift", error_stream);
+            throw runtime_error{error};
+        }
+        return module;
+    }
+
+    /// A target machine for the target triple of the module, with the defaults of llc.
+    /// Recovered modules are x86, so only the native target is linked in.
+    auto create_target_machine(const string &triple) -> unique_ptr<TargetMachine>
+    {
+        string error;
+        const Target *target = TargetRegistry::lookupTarget(triple, error);
+        if (!target) {
+            throw runtime_error{error};
+        }
+        return unique_ptr<TargetMachine>{target->createTargetMachine(
+            triple,
+            "",
+            "",
+            TargetOptions{},
+            None,
+            None,
+            CodeGenOpt::Default)};
+    }
+
+    /// The object file of a shard of a module that is compiled to filename in several shards.
+    /// The first shard is written to filename itself, the others to {stem}.1.o, {stem}.2.o, and
+    /// so on, which binrec_link links along with it.
+    auto part_filename(const string &filename, size_t part) -> string
+    {
+        if (part == 0) {
+            return filename;
+        }
+        SmallString<128> path{filename};
+        sys::path::replace_extension(path, Twine(part) + ".o");
+        return path.str().str();
+    }
+
+    /// Sets the limit of MemorySSA, which LLVM only reads from its command line option, for the
+    /// lifetime of the scope. A limit of 0 keeps the current one.
+    class MemorySSALimitScope {
+        cl::opt<unsigned> *option{};
+        unsigned previous{};
+
+    public:
+        explicit MemorySSALimitScope(unsigned limit)
+        {
+            if (limit) {
+                option = static_cast<cl::opt<unsigned> *>(
+                    cl::getRegisteredOptions()["memssa-check-limit"]);
+                previous = *option;
+                option->setValue(limit);
+            }
+        }
+
+        ~MemorySSALimitScope()
+        {
+            if (option) {
+                option->setValue(previous);
+            }
+        }
+
+        MemorySSALimitScope(const MemorySSALimitScope &) = delete;
+        auto operator=(const MemorySSALimitScope &) -> MemorySSALimitScope & = delete;
+    };
+
+    /// Compile shards of the module to separate objects in parallel.
+    ///
+    /// splitCodeGen makes local symbols hidden external so that the shards can reference
+    /// each other. They are renamed first, so they cannot take the place of symbols of the
+    /// original binary or its libraries when the recovered binary is linked. Being hidden, they
+    /// are still not exported from the recovered binary.
+    void emit_split_object(Module &module, const string &filename, size_t shards)
+    {
+        for (GlobalValue &value : module.global_values()) {
+            if (value.hasLocalLinkage()) {
+                // Unnamed values are named .binrec_local with a unique number.
+                value.setName(value.getName() + ".binrec_local");
+            }
+        }
+
+        vector<unique_ptr<raw_fd_ostream>> outputs;
+        vector<raw_pwrite_stream *> streams;
+        for (size_t i = 0; i < shards; ++i) {
+            outputs.push_back(open_output(part_filename(filename, i)));
+            streams.push_back(outputs.back().get());
+        }
+
+        string triple = module.getTargetTriple();
+        splitCodeGen(
+            module,
+            streams,
+            {},
+            [&triple] { return create_target_machine(triple); },
+            CGFT_ObjectFile);
+        for (unique_ptr<raw_fd_ostream> &output : outputs) {
+            output->close();
+            if (output->has_error()) {
+                throw runtime_error{"failed to write object: " + output->error().message()};
+            }
+        }
+    }
+
+    /// Compile the module to an object file for its target triple, in the given number of
+    /// shards.
+    void emit_object(Module &module, const string &filename, size_t shards)
+    {
+        InitializeNativeTarget();
+        InitializeNativeTargetAsmPrinter();
+
+        unique_ptr<TargetMachine> machine = create_target_machine(module.getTargetTriple());
+        if (module.getDataLayout().isDefault()) {
+            module.setDataLayout(machine->createDataLayout());
+        }
+
+        // Remove the shards of an earlier run, so they are not linked with this object.
+        for (size_t part = max<size_t>(shards, 1); sys::fs::exists(part_filename(filename, part));
+             ++part)
+        {
+            sys::fs::remove(part_filename(filename, part));
+        }
+
+        if (shards > 1) {
+            emit_split_object(module, filename, shards);
+            return;
+        }
 
+        unique_ptr<raw_fd_ostream> output = open_output(filename);
+        legacy::PassManager pm;
+        if (machine->addPassesToEmitFile(pm, *output, nullptr, CGFT_ObjectFile)) {
+            throw runtime_error{"target does not support object emission: " + filename};
+        }
+        pm.run(module);
+    }
+} // namespace
+
+namespace binrec {
 
     auto build_pipeline(LiftContext &ctx, PassBuilder &pb) -> ModulePassManager
     {
@@ -100,7 +281,7 @@ namespace binrec {
             mpm.addPass(TagInstPcPass{});
             mpm.addPass(RemoveS2EHelpersPass{});
             mpm.addPass(createModuleToFunctionPassAdaptor(DCEPass{}));
-            mpm.addPass(AddCustomHelperVarsPass{});
+            mpm.addPass(AddCustomHelperVarsPass{ctx.debug_verbosity});
             mpm.addPass(SetDataLayout32Pass{});
         }
 
@@ -117,10 +298,10 @@ namespace binrec {
             mpm.addPass(InsertCallsPass{});
             mpm.addPass(AddMemArrayPass{});
             mpm.addPass(createModuleToFunctionPassAdaptor(ExternPLTPass{}));
-            mpm.addPass(AddDebugPass{});
+            mpm.addPass(AddDebugPass{ctx.debug_verbosity, ctx.break_at});
             mpm.addPass(AlwaysInlinerPass{});
             mpm.addPass(InlineStubsPass{});
-            mpm.addPass(PcJumpsPass{});
+            mpm.addPass(PcJumpsPass{ctx.fallback_mode});
             mpm.addPass(FixCFGPass{});
             mpm.addPass(InsertTrampForRecFuncsPass{});
             mpm.addPass(InlineLibCallArgsPass{});
@@ -141,7 +322,7 @@ namespace binrec {
             mpm.addPass(createModuleToFunctionPassAdaptor(InternalizeFunctionsPass{}));
             mpm.addPass(GlobalDCEPass{});
             mpm.addPass(UnalignStackPass{});
-            mpm.addPass(RemoveMetadataPass{});
+            mpm.addPass(RemoveMetadataPass{ctx.debug_verbosity});
             mpm.addPass(GlobalDCEPass{});
             mpm.addPass(createModuleToFunctionPassAdaptor(DCEPass{}));
             mpm.addPass(IntrinsicCleanerPass{});
@@ -150,7 +331,16 @@ namespace binrec {
         }
 
         if (ctx.optimize) {
-            mpm.addPass(pb.buildPerModuleDefaultPipeline(OptimizationLevel::O3));
+            if (ctx.split_module) {
+                mpm.addPass(ShardedModulePassAdaptor{
+                    [](PassBuilder &pb) {
+                        return pb.buildPerModuleDefaultPipeline(OptimizationLevel::O3);
+                    },
+                    ctx.jobs});
+                mpm.addPass(GlobalDCEPass{});
+            } else {
+                mpm.addPass(pb.buildPerModuleDefaultPipeline(OptimizationLevel::O3));
+            }
         }
 
         if (ctx.optimize_better) {
@@ -165,7 +355,16 @@ namespace binrec {
             mpm.addPass(AlwaysInlinerPass{});
             mpm.addPass(createModuleToFunctionPassAdaptor(DCEPass{}));
             mpm.addPass(createModuleToFunctionPassAdaptor(GVNPass{}));
-            mpm.addPass(pb.buildModuleOptimizationPipeline(OptimizationLevel::O3));
+            if (ctx.split_module) {
+                mpm.addPass(ShardedModulePassAdaptor{
+                    [](PassBuilder &pb) {
+                        return pb.buildModuleOptimizationPipeline(OptimizationLevel::O3);
+                    },
+                    ctx.jobs});
+                mpm.addPass(GlobalDCEPass{});
+            } else {
+                mpm.addPass(pb.buildModuleOptimizationPipeline(OptimizationLevel::O3));
+            }
             mpm.addPass(GlobalOptPass{});
         }
 
@@ -183,23 +382,20 @@ namespace binrec {
         return mpm;
     }
 
-    void run_lift(LiftContext &ctx)
+    void run_stage(LiftContext &ctx, Module &module, PassProfiler *profiler)
     {
         // This isn't ideal from the standpoint of a Python API. However, because
         // binrec_lift appears to be stack-based, breaking this function up may cause
         // segfaults as structs/classes go out of scope. This method is very fragile.
-        LLVMContext llvm_context;
-        SMDiagnostic err;
-        unique_ptr<Module> module = parseIRFile(ctx.trace_filename, err, llvm_context);
-        if (!module) {
-            string error;
-            raw_string_ostream error_stream{error};
-            err.print("binrec-lift", error_stream);
-            throw runtime_error{error};
-        }
-        Triple triple(module->getTargetTriple());
+        logging::ThresholdScope threshold{ctx.log_level};
+        MemorySSALimitScope memssa_limit{ctx.memssa_check_limit};
 
-        PassBuilder pb;
+        PassInstrumentationCallbacks pic;
+        if (profiler) {
+            profiler->set_stage(sys::path::filename(ctx.destination));
+            profiler->register_callbacks(pic);
+        }
+        PassBuilder pb{nullptr, PipelineTuningOptions{}, None, &pic};
 
         AAManager aa = pb.buildDefaultAAPipeline();
         aa.registerFunctionAnalysis<EnvAa>();
@@ -211,6 +407,9 @@ namespace binrec {
         ModuleAnalysisManager mam;
 
         mam.registerPass([] { return TraceInfoAnalysis{}; });
+        mam.registerPass([] { return BlockRegistryAnalysis{}; });
+        mam.registerPass([] { return SourceBinaryAnalysis{}; });
+        mam.registerPass([] { return SuccessorGraphAnalysis{}; });
         fam.registerPass([&] { return move(aa); });
 
         pb.registerModuleAnalyses(mam);
@@ -221,31 +420,123 @@ namespace binrec {
 
         ModulePassManager mpm = build_pipeline(ctx, pb);
 
-        error_code ec;
-        raw_fd_ostream output_bc{ctx.destination + ".bc", ec};
-        if (ec) {
-            LLVM_ERROR(error) << "failed to open file " << ctx.destination
-                              << ".bc: " << ec.message();
-            throw runtime_error{error};
+        unique_ptr<raw_fd_ostream> output_bc;
+        if (ctx.output >= OutputPolicy::BITCODE) {
+            output_bc = open_output(ctx.destination + ".bc");
+            mpm.addPass(BitcodeWriterPass{*output_bc});
         }
-        raw_fd_ostream output_ll{ctx.destination + ".ll", ec};
-        if (ec) {
-            LLVM_ERROR(error) << "failed to open file " << ctx.destination
-                              << ".ll: " << ec.message();
-            throw runtime_error{error};
+
+        // The textual outputs are only useful for debugging and can be much larger, and much
+        // slower to produce, than the bitcode.
+        unique_ptr<raw_fd_ostream> output_ll;
+        if (ctx.output >= OutputPolicy::TEXT) {
+            output_ll = open_output(ctx.destination + ".ll");
+            mpm.addPass(PrintModulePass{*output_ll});
         }
-        mpm.addPass(BitcodeWriterPass{output_bc});
-        mpm.addPass(PrintModulePass{output_ll});
 
-        raw_fd_ostream memssa_ll{ctx.destination + "-memssa.ll", ec};
-        if (ec) {
-            LLVM_ERROR(error) << "failed to open file " << ctx.destination
-                              << "-memssa.ll: " << ec.message();
-            throw runtime_error{error};
+        unique_ptr<raw_fd_ostream> memssa_ll;
+        if (ctx.output >= OutputPolicy::MEMSSA) {
+            memssa_ll = open_output(ctx.destination + "-memssa.ll");
+            mpm.addPass(RequireAnalysisPass<GlobalsAA, Module>{});
+            mpm.addPass(createModuleToFunctionPassAdaptor(MemorySSAPrinterPass{*memssa_ll}));
         }
-        mpm.addPass(RequireAnalysisPass<GlobalsAA, Module>{});
-        mpm.addPass(createModuleToFunctionPassAdaptor(MemorySSAPrinterPass{memssa_ll}));
 
-        mpm.run(*module, mam);
+        mpm.run(module, mam);
+    }
+
+    void run_lift(LiftContext &ctx)
+    {
+        LLVMContext llvm_context;
+        unique_ptr<Module> module = parse_module(ctx.trace_filename, llvm_context);
+        unique_ptr<PassProfiler> profiler = ctx.profile ? make_unique<PassProfiler>() : nullptr;
+        run_stage(ctx, *module, profiler.get());
+        if (profiler) {
+            profiler->write_json(*open_output(ctx.destination + "-passes.json"));
+        }
+    }
+
+    void run_full_pipeline(LiftContext &ctx, PassProfiler *profiler)
+    {
+        LLVMContext llvm_context;
+        string diagnostics;
+        llvm_context.setDiagnosticHandlerCallBack(collect_diagnostic, &diagnostics);
+        unique_ptr<Module> module = parse_module(ctx.trace_filename, llvm_context);
+
+        // The intermediate modules are only written when debugging, using the names of the
+        // files written by the individual lift operations.
+        OutputPolicy intermediate =
+            ctx.output >= OutputPolicy::TEXT ? ctx.output : OutputPolicy::NONE;
+        unique_ptr<PassProfiler> owned_profiler;
+        if (!profiler && ctx.profile) {
+            owned_profiler = make_unique<PassProfiler>();
+            profiler = owned_profiler.get();
+        }
+
+        // The cache only keeps trace info while it is in use, so hold on to it between the
+        // stages, which would otherwise parse it again.
+        shared_ptr<const CachedTraceInfo> trace_info;
+        if (!findTraceInfo(TraceInfo::defaultName).empty()) {
+            if (profiler) {
+                profiler->set_stage("trace_info");
+                profiler->begin("LoadTraceInfo", *module);
+            }
+            trace_info = TraceInfoCache::get().load(TraceInfo::defaultName);
+            if (profiler) {
+                profiler->end(*module);
+            }
+        }
+        auto run = [&](bool LiftContext::*stage, const char *destination) {
+            LiftContext stage_ctx;
+            if (stage) {
+                stage_ctx.*stage = true;
+            }
+            stage_ctx.skip_link = ctx.skip_link;
+            stage_ctx.trace_calls = ctx.trace_calls;
+            stage_ctx.jobs = ctx.jobs;
+            stage_ctx.split_module = ctx.split_module;
+            stage_ctx.clean_names = ctx.clean_names && stage == &LiftContext::lift;
+            stage_ctx.log_level = ctx.log_level;
+            stage_ctx.fallback_mode = ctx.fallback_mode;
+            stage_ctx.debug_verbosity = ctx.debug_verbosity;
+            stage_ctx.break_at = ctx.break_at;
+            stage_ctx.memssa_check_limit = ctx.memssa_check_limit;
+            stage_ctx.output = intermediate;
+            stage_ctx.destination = destination;
+            run_stage(stage_ctx, *module, profiler);
+        };
+
+        run(&LiftContext::clean, "cleaned");
+
+        if (profiler) {
+            profiler->set_stage("linked");
+            profiler->begin("LinkCustomHelpers", *module);
+        }
+        unique_ptr<Module> helpers = parse_module(ctx.custom_helpers_filename, llvm_context);
+        if (Linker::linkModules(*module, move(helpers))) {
+            throw runtime_error{
+                "failed to link " + ctx.custom_helpers_filename + ": " + diagnostics};
+        }
+        if (profiler) {
+            profiler->end(*module);
+        }
+        run(nullptr, "linked");
+
+        run(&LiftContext::lift, "lifted");
+        run(ctx.optimize_better ? &LiftContext::optimize_better : &LiftContext::optimize,
+            "optimized");
+        run(&LiftContext::compile, "recovered");
+
+        size_t shards = ctx.split_module ? shard_count(*module, ctx.jobs) : 1;
+        if (profiler) {
+            profiler->set_stage("object");
+            profiler->begin("EmitObject", *module);
+        }
+        emit_object(*module, ctx.destination + ".o", shards);
+        if (profiler) {
+            profiler->end(*module);
+        }
+        if (ctx.profile) {
+            profiler->write_json(*open_output(ctx.destination + "-passes.json"));
+        }
     }
 } // namespace binrec
@@ -1,6 +1,7 @@
 #ifndef BINREC_LIFT_HPP
 #define BINREC_LIFT_HPP
 
+#include "debug/pass_profiler.hpp"
 #include "lift_context.hpp"
 #include <llvm/Passes/PassBuilder.h>
 
@@ -13,6 +14,21 @@ namespace binrec {
         llvm::ModuleAnalysisManager &mam,
         llvm::AAManager &aa);
     void run_lift(LiftContext &ctx);
+
+    /// Run the pipeline of ctx on a module that was already parsed and write the outputs
+    /// selected by its output policy. The passes are recorded by profiler, if there is one.
+    void run_stage(LiftContext &ctx, llvm::Module &module, PassProfiler *profiler = nullptr);
+
+    /// Recover an object file, {destination}.o, from captured bitcode in a single pass over one
+    /// module. This runs the clean stage, links the custom helpers, and runs the lift, optimize
+    /// (or optimize_better), and compile stages before compiling the module. Intermediate
+    /// modules are only written when the output policy includes text. The passes are recorded
+    /// by profiler, if there is one, or by a new profiler if ctx.profile is set.
+    ///
+    /// If ctx.split_module is set, the shards after the first are compiled to
+    /// {destination}.1.o, {destination}.2.o, and so on, which binrec_link links along with
+    /// {destination}.o.
+    void run_full_pipeline(LiftContext &ctx, PassProfiler *profiler = nullptr);
 } // namespace binrec
 
 #endif
@@ -0,0 +1,193 @@
+#include "pass_profiler.hpp"
+#include <algorithm>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Process.h>
+#include <sys/resource.h>
+
+using namespace binrec;
+using namespace llvm;
+using namespace std;
+
+namespace {
+    auto peak_rss() -> uint64_t
+    {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        // Linux reports kilobytes.
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+    }
+
+    auto cpu_time() -> chrono::nanoseconds
+    {
+        sys::TimePoint<> elapsed;
+        chrono::nanoseconds user{};
+        chrono::nanoseconds system{};
+        sys::Process::GetTimeUsage(elapsed, user, system);
+        return user + system;
+    }
+
+    auto seconds(chrono::nanoseconds duration) -> double
+    {
+        return chrono::duration<double>{duration}.count();
+    }
+} // namespace
+
+auto PassProfiler::ir_size(const Module &m) -> IRSize
+{
+    IRSize size{};
+    for (const Function &f : m) {
+        if (f.isDeclaration()) {
+            continue;
+        }
+        ++size.functions;
+        for (const BasicBlock &bb : f) {
+            ++size.blocks;
+            size.instructions += bb.size();
+        }
+    }
+    return size;
+}
+
+void PassProfiler::register_callbacks(PassInstrumentationCallbacks &pic)
+{
+    pic.registerBeforeNonSkippedPassCallback([this](StringRef pass, Any ir) {
+        before_pass(pass, ir);
+    });
+    pic.registerAfterPassCallback(
+        [this](StringRef, Any, const PreservedAnalyses &) { after_pass(); });
+    pic.registerAfterPassInvalidatedCallback(
+        [this](StringRef, const PreservedAnalyses &) { after_pass(); });
+}
+
+void PassProfiler::set_stage(StringRef stage)
+{
+    this->stage = stage.str();
+}
+
+void PassProfiler::before_pass(StringRef pass, const Any &ir)
+{
+    if (!any_isa<const Module *>(ir)) {
+        // List the passes that a module pass runs on functions, loops, or SCCs, without the
+        // pass managers and adaptors in between.
+        auto parent = find_if(running.rbegin(), running.rend(), [](const Running &r) {
+            return r.module != nullptr;
+        });
+        if (parent != running.rend() && !pass.startswith("PassManager<") &&
+            !pass.endswith("PassAdaptor"))
+        {
+            vector<string> &inner = records[parent->record].inner;
+            if (find(inner.begin(), inner.end(), pass) == inner.end()) {
+                inner.push_back(pass.str());
+            }
+        }
+        running.push_back({nullptr, 0, {}});
+        return;
+    }
+    begin(pass, *any_cast<const Module *>(ir));
+}
+
+void PassProfiler::after_pass()
+{
+    if (running.empty()) {
+        return;
+    }
+    if (!running.back().module) {
+        running.pop_back();
+        return;
+    }
+    end(*running.back().module);
+}
+
+void PassProfiler::begin(StringRef pass, const Module &m)
+{
+    unsigned depth = count_if(running.begin(), running.end(), [](const Running &r) {
+        return r.module != nullptr;
+    });
+
+    Record record{};
+    record.stage = stage;
+    record.pass = pass.str();
+    record.depth = depth;
+    record.before = ir_size(m);
+    records.push_back(move(record));
+
+    Usage start{chrono::steady_clock::now(), cpu_time(), peak_rss()};
+    running.push_back({&m, records.size() - 1, start});
+}
+
+void PassProfiler::end(const Module &m)
+{
+    Usage stop{chrono::steady_clock::now(), cpu_time(), peak_rss()};
+    Running pass = running.back();
+    running.pop_back();
+
+    Record &record = records[pass.record];
+    record.after = ir_size(m);
+    record.wall_seconds = seconds(stop.wall - pass.start.wall);
+    record.cpu_seconds = seconds(stop.cpu - pass.start.cpu);
+    record.peak_rss_growth = stop.peak_rss - pass.start.peak_rss;
+}
+
+auto PassProfiler::stage_totals() const -> vector<StageTotals>
+{
+    vector<StageTotals> totals;
+    for (const Record &record : records) {
+        if (record.depth > 0) {
+            continue;
+        }
+        auto it = find_if(totals.begin(), totals.end(), [&](const StageTotals &t) {
+            return t.stage == record.stage;
+        });
+        if (it == totals.end()) {
+            totals.push_back({record.stage, 0, 0});
+            it = totals.end() - 1;
+        }
+        it->wall_seconds += record.wall_seconds;
+        it->cpu_seconds += record.cpu_seconds;
+    }
+    return totals;
+}
+
+void PassProfiler::write_json(raw_ostream &os) const
+{
+    auto write_size = [](json::OStream &j, const IRSize &size) {
+        j.object([&] {
+            j.attribute("functions", static_cast<int64_t>(size.functions));
+            j.attribute("blocks", static_cast<int64_t>(size.blocks));
+            j.attribute("instructions", static_cast<int64_t>(size.instructions));
+        });
+    };
+
+    // JSON integers are signed.
+    json::OStream j{os, 2};
+    j.object([&] {
+        j.attribute("peak_rss_bytes", static_cast<int64_t>(peak_rss()));
+        j.attributeArray("passes", [&] {
+            for (const Record &record : records) {
+                j.object([&] {
+                    j.attribute("stage", record.stage);
+                    j.attribute("pass", record.pass);
+                    j.attribute("depth", record.depth);
+                    j.attributeArray("inner", [&] {
+                        for (const string &inner : record.inner) {
+                            j.value(inner);
+                        }
+                    });
+                    j.attribute("wall_seconds", record.wall_seconds);
+                    j.attribute("cpu_seconds", record.cpu_seconds);
+                    j.attribute(
+                        "peak_rss_growth_bytes",
+                        static_cast<int64_t>(record.peak_rss_growth));
+                    j.attributeBegin("before");
+                    write_size(j, record.before);
+                    j.attributeEnd();
+                    j.attributeBegin("after");
+                    write_size(j, record.after);
+                    j.attributeEnd();
+                });
+            }
+        });
+    });
+    os << '\n';
+}
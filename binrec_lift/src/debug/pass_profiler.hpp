@@ -0,0 +1,91 @@
+#ifndef BINREC_PASS_PROFILER_HPP
+#define BINREC_PASS_PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+#include <vector>
+
+namespace binrec {
+    /// Records the wall time, CPU time, growth of the peak resident set size, and IR size of
+    /// every module pass that runs in a pass manager.
+    ///
+    /// Function, loop, and CGSCC passes are not recorded on their own, they are part of the
+    /// module pass that runs them, such as a ModuleToFunctionPassAdaptor, which lists their
+    /// names. Nested module pipelines, such as the O3 pipeline, record their passes with a
+    /// greater depth. The CPU time includes all threads, so it also covers the shards of
+    /// ShardedModulePassAdaptor.
+    class PassProfiler {
+    public:
+        /// Record the passes run by pass managers that use pic.
+        void register_callbacks(llvm::PassInstrumentationCallbacks &pic);
+
+        /// Set the stage of the following passes, such as the destination of a lift operation.
+        void set_stage(llvm::StringRef stage);
+
+        /// Start to record a step that does not run in a pass manager, such as linking or code
+        /// generation. Every begin must be followed by an end.
+        void begin(llvm::StringRef pass, const llvm::Module &m);
+        /// Finish the step started by the last begin.
+        void end(const llvm::Module &m);
+
+        /// The time spent in the outermost passes of a stage.
+        struct StageTotals {
+            std::string stage;
+            double wall_seconds;
+            double cpu_seconds;
+        };
+
+        /// Sum the outermost passes of every stage, in the order the stages started.
+        [[nodiscard]] auto stage_totals() const -> std::vector<StageTotals>;
+
+        /// Write all records as JSON.
+        void write_json(llvm::raw_ostream &os) const;
+
+    private:
+        struct IRSize {
+            uint64_t functions;
+            uint64_t blocks;
+            uint64_t instructions;
+        };
+
+        struct Usage {
+            std::chrono::steady_clock::time_point wall;
+            std::chrono::nanoseconds cpu;
+            uint64_t peak_rss;
+        };
+
+        struct Record {
+            std::string stage;
+            std::string pass;
+            unsigned depth;
+            std::vector<std::string> inner;
+            IRSize before;
+            IRSize after;
+            double wall_seconds;
+            double cpu_seconds;
+            uint64_t peak_rss_growth;
+        };
+
+        /// A pass that is running. Only module passes have a record.
+        struct Running {
+            const llvm::Module *module;
+            size_t record;
+            Usage start;
+        };
+
+        std::string stage;
+        std::vector<Record> records;
+        std::vector<Running> running;
+
+        static auto ir_size(const llvm::Module &m) -> IRSize;
+        void before_pass(llvm::StringRef pass, const llvm::Any &ir);
+        void after_pass();
+    };
+} // namespace binrec
+
+#endif
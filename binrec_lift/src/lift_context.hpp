@@ -1,10 +1,25 @@
 #ifndef BINREC_LIFT_CONTEXT_HPP
 #define BINREC_LIFT_CONTEXT_HPP
 
+#include "pass_utils.hpp"
 #include <llvm/Passes/PassBuilder.h>
+#include <vector>
 
 namespace binrec {
 
+    /// The artifacts that run_lift writes for a lift operation.
+    enum class OutputPolicy {
+        /// Nothing, used for the intermediate stages of run_full_pipeline.
+        NONE,
+        /// Only the bitcode, {destination}.bc.
+        BITCODE,
+        /// The bitcode and the textual IR, {destination}.ll.
+        TEXT,
+        /// The bitcode, the textual IR, and the IR annotated with MemorySSA,
+        /// {destination}-memssa.ll. This runs GlobalsAA and MemorySSA on every function.
+        MEMSSA,
+    };
+
     class LiftContext {
     public:
         bool link_prep_1;
@@ -17,8 +32,30 @@ namespace binrec {
         bool skip_link;
         bool clean_names;
         bool trace_calls;
+        OutputPolicy output;
         std::string trace_filename;
         std::string destination;
+        /// The custom helpers linked in by run_full_pipeline.
+        std::string custom_helpers_filename;
+        /// The number of threads for sharded optimization and code generation, 0 uses every
+        /// core.
+        unsigned jobs;
+        /// Optimize shards of the module in parallel, and compile them in parallel in
+        /// run_full_pipeline. Calls between shards are not inlined.
+        bool split_module;
+        /// Write the time, memory use, and IR size of every pass to {destination}-passes.json.
+        bool profile;
+        /// The most detailed messages that the passes log.
+        logging::Level log_level;
+        /// How edges that are not recorded in the successor lists are handled.
+        fallback::Mode fallback_mode;
+        /// Verbosity of the generated code (0: default, 1: basic log, 2: register log).
+        unsigned debug_verbosity;
+        /// Addresses of the blocks to insert debugging breakpoints at.
+        std::vector<unsigned> break_at;
+        /// The number of stores and phis that MemorySSA walks past, 0 keeps the limit of the
+        /// -memssa-check-limit option.
+        unsigned memssa_check_limit;
 
         LiftContext() :
                 link_prep_1{false},
@@ -31,8 +68,18 @@ namespace binrec {
                 skip_link{false},
                 clean_names{false},
                 trace_calls(false),
+                output{OutputPolicy::BITCODE},
                 trace_filename{},
-                destination{}
+                destination{},
+                custom_helpers_filename{},
+                jobs{0},
+                split_module{false},
+                profile{false},
+                log_level{logging::INFO},
+                fallback_mode{fallback::NONE},
+                debug_verbosity{0},
+                break_at{},
+                memssa_check_limit{0}
         {
         }
 
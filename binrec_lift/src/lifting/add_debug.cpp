@@ -10,11 +10,18 @@
 
 using namespace binrec;
 using namespace llvm;
+using namespace std;
+
+AddDebugPass::AddDebugPass(unsigned verbosity, vector<unsigned> break_at) :
+        verbosity{verbosity},
+        break_at{move(break_at)}
+{
+}
 
 // NOLINTNEXTLINE
 auto AddDebugPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    if (debugVerbosity < 1)
+    if (verbosity < 1)
         return PreservedAnalyses::all();
 
     LLVMContext &ctx = m.getContext();
@@ -30,7 +37,7 @@ auto AddDebugPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyse
             cast<Function>(m.getOrInsertFunction("helper_break", Type::getVoidTy(ctx)).getCallee());
         helper_break->addFnAttr(Attribute::AlwaysInline);
 
-        for (unsigned pc : breakAt) {
+        for (unsigned pc : break_at) {
             bool found = false;
 
             for (BasicBlock &bb : f) {
@@ -48,7 +55,7 @@ auto AddDebugPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyse
             }
         }
 
-        if (debugVerbosity >= 3) {
+        if (verbosity >= 3) {
             auto *helper_debug_state = cast<Function>(
                 m.getOrInsertFunction("helper_debug_state", Type::getVoidTy(ctx)).getCallee());
 
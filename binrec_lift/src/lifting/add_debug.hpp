@@ -2,6 +2,7 @@
 #define BINREC_ADD_DEBUG_HPP
 
 #include <llvm/IR/PassManager.h>
+#include <vector>
 
 namespace binrec {
     /// S2E Add debug print statements for PC values and illegal states
@@ -15,7 +16,15 @@ namespace binrec {
     /// 6. jumps to the saved return address
     class AddDebugPass : public llvm::PassInfoMixin<AddDebugPass> {
     public:
+        /// Nothing is inserted at a verbosity of 0. Breakpoints are inserted at the blocks that
+        /// contain the pcs in break_at, and a verbosity of 3 also dumps the state at every block.
+        AddDebugPass(unsigned verbosity, std::vector<unsigned> break_at);
+
         auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> llvm::PreservedAnalyses;
+
+    private:
+        unsigned verbosity;
+        std::vector<unsigned> break_at;
     };
 } // namespace binrec
 
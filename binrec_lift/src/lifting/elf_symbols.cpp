@@ -8,6 +8,7 @@
  */
 
 #include "elf_symbols.hpp"
+#include "analysis/block_registry.hpp"
 #include "error.hpp"
 #include "ir/selectors.hpp"
 #include "meta_utils.hpp"
@@ -97,7 +98,7 @@ remove_plt_succs(Function *f, set<Function *> &erase_list, const elf_section &pl
     Function *lookup = get_plt_lookup_function(f, plt_section);
 
     if (!lookup) {
-        if (logLevel >= logging::DEBUG) {
+        if (logging::threshold() >= logging::DEBUG) {
             raw_ostream &log = logging::getStream(logging::DEBUG);
             log << "no plt successor: " << utohexstr(getBlockAddress(f)) << " -> ";
             getBlockSuccs(f, succs);
@@ -151,6 +152,7 @@ auto ELFSymbolsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnaly
 {
     DBG("Running ELF Symbols pass");
     bool changed = false;
+    BlockRegistry &blocks = am.getResult<BlockRegistryAnalysis>(m);
 
     // load the external symbols
     ifstream f;
@@ -159,7 +161,7 @@ auto ELFSymbolsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnaly
     unsigned size = 0;
     string symbol;
     while (f >> hex >> addr >> symbol) {
-        if (Function *f2 = m.getFunction("Func_" + utohexstr(addr))) {
+        if (Function *f2 = blocks.function(addr)) {
             annotate_symbol(f2, symbol);
             changed = true;
         }
@@ -186,8 +188,15 @@ auto ELFSymbolsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnaly
             remove_plt_succs(&f3, erase_list, plt_section);
     }
 
-    for (auto &it : erase_list)
+    for (auto &it : erase_list) {
+        blocks.erase(*it);
         it->eraseFromParent();
+    }
 
-    return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+    if (!changed) {
+        return PreservedAnalyses::all();
+    }
+    PreservedAnalyses preserved = PreservedAnalyses::none();
+    preserved.preserve<BlockRegistryAnalysis>();
+    return preserved;
 }
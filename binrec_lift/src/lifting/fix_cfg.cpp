@@ -141,8 +141,7 @@ static void add_switch_cases(
 // NOLINTNEXTLINE
 auto FixCFGPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    TraceInfo &ti = am.getResult<TraceInfoAnalysis>(m);
-    FunctionInfo fi{ti};
+    const FunctionInfo &fi = am.getResult<TraceInfoAnalysis>(m)->function_info();
 
     for (Function &f : m) {
         if (!f.getName().startswith("Func_")) {
@@ -166,7 +165,7 @@ auto FixCFGPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
         for (BasicBlock *bb : bb_set) {
             // find caller of this function
             unsigned pc = getBlockAddress(bb);
-            auto caller_pc_set = fi.entry_pc_to_caller_pcs[pc];
+            const auto &caller_pc_set = fi.get_caller_pcs(pc);
 
             // check if each pred is callerBB
             // if it is, then it function called by call inst
@@ -214,11 +213,11 @@ auto FixCFGPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
                 // func that called func(p.first) with jmp
                 unsigned bb_pc = getBlockAddress(bb);
                 DBG("BB_pred_pc: " << utohexstr(bb_pc));
-                for (unsigned caller_func_pc : fi.bb_pc_to_entry_pcs[bb_pc]) {
+                for (unsigned caller_func_pc : fi.get_entry_pcs(bb_pc)) {
                     DBG("caller func: " << utohexstr(caller_func_pc));
-                    for (unsigned caller_of_caller_func : fi.entry_pc_to_caller_pcs[caller_func_pc])
-                    {
-                        unsigned follow_up = fi.caller_pc_to_follow_up_pc[caller_of_caller_func];
+                    for (unsigned caller_of_caller_func : fi.get_caller_pcs(caller_func_pc)) {
+                        unsigned follow_up =
+                            fi.caller_pc_to_follow_up_pc.lookup(caller_of_caller_func);
                         DBG("follow_up to be added: " << utohexstr(follow_up));
                         new_succs[p.first].insert(follow_up);
                     }
@@ -233,7 +232,7 @@ auto FixCFGPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
             DBG("BB: " << bb->getName());
             // find caller of this function
             unsigned pc = getBlockAddress(bb);
-            auto caller_pc_set = fi.entry_pc_to_caller_pcs[pc];
+            const auto &caller_pc_set = fi.get_caller_pcs(pc);
 
             // check if each pred is callerBB
             // if it is, then it function called by call inst
@@ -250,7 +249,7 @@ auto FixCFGPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
                 for (unsigned caller_pc : caller_pc_set) {
                     for (auto *caller_bb : caller_pc_to_caller_bb[caller_pc]) {
                         if (caller_bb == p) {
-                            unsigned follow_up = fi.caller_pc_to_follow_up_pc[caller_pc];
+                            unsigned follow_up = fi.caller_pc_to_follow_up_pc.lookup(caller_pc);
                             DBG("BB_pred_pc: " << caller_bb->getName());
                             DBG("caller_pc: " << caller_pc
                                               << " followUp: " << utohexstr(follow_up));
@@ -1,4 +1,5 @@
 #include "fix_overlaps.hpp"
+#include "analysis/block_registry.hpp"
 #include "error.hpp"
 #include "meta_utils.hpp"
 #include "pass_utils.hpp"
@@ -247,5 +248,11 @@ auto FixOverlapsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnal
         for (auto pair : merge_list)
             remove_exception_helper(pair.first, pair.second);
     }
-    return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+    if (!changed) {
+        return PreservedAnalyses::all();
+    }
+    // Splitting only creates and deletes unnamed blocks, so the registry is still valid.
+    PreservedAnalyses preserved = PreservedAnalyses::none();
+    preserved.preserve<BlockRegistryAnalysis>();
+    return preserved;
 }
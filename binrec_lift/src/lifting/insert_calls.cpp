@@ -1,4 +1,6 @@
 #include "insert_calls.hpp"
+#include "analysis/block_registry.hpp"
+#include "analysis/successor_graph.hpp"
 #include "analysis/trace_info_analysis.hpp"
 #include "error.hpp"
 #include "meta_utils.hpp"
@@ -35,11 +37,12 @@ static auto find_exit_block(BasicBlock *bb) -> BasicBlock *
 // NOLINTNEXTLINE
 auto InsertCallsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    TraceInfo &ti = am.getResult<TraceInfoAnalysis>(m);
-    FunctionInfo fi{ti};
+    const FunctionInfo &fi = am.getResult<TraceInfoAnalysis>(m)->function_info();
+    const BlockRegistry &blocks = am.getResult<BlockRegistryAnalysis>(m);
+    SuccessorGraph &graph = am.getResult<SuccessorGraphAnalysis>(m);
 
     std::map<Function *, std::set<BasicBlock *>> all_ret_blocks =
-        fi.get_ret_bbs_by_merged_function(m);
+        fi.get_ret_bbs_by_merged_function(blocks);
 
     for (Function &f : m) {
 
@@ -57,7 +60,7 @@ auto InsertCallsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnal
             }
 
             std::vector<BasicBlock *> successors;
-            if (!getBlockSuccs(&bb, successors) || successors.empty()) {
+            if (!graph.successor_blocks(bb, successors)) {
                 continue;
             }
 
@@ -74,17 +77,11 @@ auto InsertCallsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnal
                 if (call_follow_up_pc != fi.caller_pc_to_follow_up_pc.end()) {
                     // When the call does not return (e.g. call to exit()) there is no
                     // follow up block.
-                    std::string call_follow_up_block_name =
-                        std::string("BB_") + utohexstr(call_follow_up_pc->second);
-                    for (BasicBlock &bb2 : f) {
-                        if (bb2.getName() == call_follow_up_block_name) {
-                            call_follow_up_block = &bb2;
-                        }
-                    }
+                    call_follow_up_block = blocks.block(f, call_follow_up_pc->second);
                     if (call_follow_up_block == nullptr) {
-                        errs() << "Can't find call follow up block " << call_follow_up_block_name
-                               << " of block " << bb.getName() << " in function " << f.getName()
-                               << ".\n";
+                        errs() << "Can't find call follow up block BB_"
+                               << utohexstr(call_follow_up_pc->second) << " of block "
+                               << bb.getName() << " in function " << f.getName() << ".\n";
                         PASS_ASSERT(call_follow_up_block);
                     }
                 }
@@ -117,14 +114,13 @@ auto InsertCallsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnal
                         // inserting an UnreachableInst here would make sense. However for
                         // tail calls this causes the removal of the return instruction
                         // in the exitBlock.
-                        setBlockSuccs(&bb, {});
+                        graph.set(bb, {}, EdgeKind::INFERRED);
                     } else {
                         new StoreInst(
                             getFirstInstStart(call_follow_up_block)->getValueOperand(),
                             m.getNamedGlobal("PC"),
                             exit_block->getTerminator());
-                        std::vector<BasicBlock *> meta_succs{call_follow_up_block};
-                        setBlockSuccs(&bb, meta_succs);
+                        graph.set(bb, call_follow_up_block, EdgeKind::INFERRED);
                     }
                 } else {
                     unsigned last_pc = getLastPc(&bb);
@@ -148,8 +144,7 @@ auto InsertCallsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnal
                             getFirstInstStart(call_follow_up_block)->getValueOperand(),
                             m.getNamedGlobal("PC"),
                             join_block->getTerminator());
-                        std::vector<BasicBlock *> meta_succs{call_follow_up_block};
-                        setBlockSuccs(join_block, meta_succs);
+                        graph.set(*join_block, call_follow_up_block, EdgeKind::INFERRED);
                         join_block->getTerminator()->setMetadata(
                             "lastpc",
                             MDNode::get(
@@ -202,5 +197,11 @@ auto InsertCallsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnal
             }
         }
     }
-    return PreservedAnalyses::none();
+    graph.materialize();
+
+    // The graph is not preserved, since replacing the terminators of call sites removes their
+    // successor lists.
+    PreservedAnalyses preserved = PreservedAnalyses::none();
+    preserved.preserve<BlockRegistryAnalysis>();
+    return preserved;
 }
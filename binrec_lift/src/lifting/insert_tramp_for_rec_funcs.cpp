@@ -1,4 +1,5 @@
 #include "insert_tramp_for_rec_funcs.hpp"
+#include "analysis/block_registry.hpp"
 #include "analysis/trace_info_analysis.hpp"
 #include "error.hpp"
 #include "meta_utils.hpp"
@@ -18,15 +19,12 @@ using namespace binrec;
 using namespace llvm;
 using namespace std;
 
-static auto get_block_by_name(StringRef name, Function *containing_f) -> BasicBlock *
+
+static auto switches_on_pc(BasicBlock *bb) -> bool
 {
-    for (auto &curr_bb : *containing_f) {
-        if (curr_bb.getName().equals(name)) {
-            return &curr_bb;
-        }
-    }
-    DBG("found no bb called " << name);
-    return nullptr;
+    auto *sw = dyn_cast<SwitchInst>(bb->getTerminator());
+    auto *load = sw ? dyn_cast<LoadInst>(sw->getCondition()) : nullptr;
+    return load && load->getPointerOperand()->getName() == "PC";
 }
 
 static auto make_enter_tramp(Module &m, BasicBlock *entry_bb) -> BasicBlock *
@@ -133,6 +131,10 @@ static auto make_enter_tramp(Module &m, BasicBlock *entry_bb) -> BasicBlock *
         }
     }
 
+    // A dense fallback jump table dispatches from the default of the switch on @PC.
+    while (!switches_on_pc(entry_pred) && entry_pred->getSinglePredecessor()) {
+        entry_pred = entry_pred->getSinglePredecessor();
+    }
     auto *pred_switch = dyn_cast<SwitchInst>(entry_pred->getTerminator());
     PASS_ASSERT(pred_switch && "Terminator is not switch");
     ConstantInt *case_tag =
@@ -257,6 +259,7 @@ static void get_cb_entry_and_returns(
     unordered_set<BasicBlock *> &returns,
     unordered_set<BasicBlock *> &entries,
     const FunctionInfo &fi,
+    const BlockRegistry &blocks,
     unordered_set<uint32_t> &callers)
 {
     Function *wrapper = m.getFunction("Func_wrapper");
@@ -294,7 +297,7 @@ static void get_cb_entry_and_returns(
         for (uint32_t ret_pc : it->second) {
             // insert retBB into set
             DBG("callback ret: " << utohexstr(ret_pc));
-            BasicBlock *ret_bb = get_block_by_name("BB_" + utohexstr(ret_pc), wrapper);
+            BasicBlock *ret_bb = blocks.block(*wrapper, ret_pc);
             PASS_ASSERT(ret_bb && "Couldn't find return BB");
             returns.insert(ret_bb);
         }
@@ -339,8 +342,7 @@ auto InsertTrampForRecFuncsPass::run(Module &m, ModuleAnalysisManager &am) -> Pr
     // TODO: phyton script jumps to beginning of enterTramp. Instead jump to
     // movl %esp R_ESP instruction.
 
-    TraceInfo &ti = am.getResult<TraceInfoAnalysis>(m);
-    FunctionInfo fi{ti};
+    const FunctionInfo &fi = am.getResult<TraceInfoAnalysis>(m)->function_info();
 
     // Create global bool onUnfallback = false
     auto *g_on_unfallback = cast<GlobalVariable>(
@@ -362,7 +364,13 @@ auto InsertTrampForRecFuncsPass::run(Module &m, ModuleAnalysisManager &am) -> Pr
     unordered_set<BasicBlock *> entries;
     unordered_set<BasicBlock *> returns;
     unordered_set<uint32_t> callers;
-    get_cb_entry_and_returns(m, entries, returns, fi, callers);
+    get_cb_entry_and_returns(
+        m,
+        entries,
+        returns,
+        fi,
+        am.getResult<BlockRegistryAnalysis>(m),
+        callers);
 
     for (BasicBlock *entry_bb : entries) {
         make_enter_tramp(m, entry_bb);
@@ -1,15 +1,16 @@
 #include "pc_jumps.hpp"
+#include "analysis/successor_graph.hpp"
 #include "analysis/trace_info_analysis.hpp"
 #include "error.hpp"
 #include "meta_utils.hpp"
 #include "pass_utils.hpp"
 #include "pc_utils.hpp"
-#include "utils/function_info.hpp"
 #include <llvm/Analysis/CFG.h>
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/InlineAsm.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/PassManager.h>
+#include <algorithm>
 
 #define PASS_NAME "pc_jumps"
 #define PASS_ASSERT(cond) LIFT_ASSERT(PASS_NAME, cond)
@@ -32,7 +33,8 @@ static void insert_prev_pc(Function *wrapper, GlobalVariable *prev_pc)
     }
 }
 
-static auto create_error_block(Module &m, Function *wrapper) -> BasicBlock *
+static auto create_error_block(Module &m, Function *wrapper, fallback::Mode fallback_mode)
+    -> BasicBlock *
 {
     BasicBlock *err_block = BasicBlock::Create(m.getContext(), "error", wrapper);
     GlobalVariable *pc = m.getNamedGlobal("PC");
@@ -40,7 +42,7 @@ static auto create_error_block(Module &m, Function *wrapper) -> BasicBlock *
     // jump to original .text section
     IRBuilder<> b(err_block);
 
-    switch (fallbackMode) {
+    switch (fallback_mode) {
     case fallback::NONE:
     case fallback::UNFALLBACK:
         b.CreateUnreachable();
@@ -97,19 +99,190 @@ static auto is_possible_jump_target(BasicBlock *bb) -> bool
         bb != &bb->getParent()->getEntryBlock();
 }
 
-static auto create_jump_table(BasicBlock *err_block) -> SwitchInst *
+/// Jump tables with more targets than fit in one switch look up a case index for @PC and
+/// dispatch on it through two levels of switches with at most this many cases each. A single
+/// switch with tens of thousands of cases takes O3 and code generation many minutes.
+static constexpr unsigned case_bits = 7;
+static constexpr uint32_t max_cases_per_switch = 1U << case_bits;
+
+/// Dense index tables are only built if they have at most this many entries per jump target, so
+/// the table stays within a few words per byte of the covered code. The indices of sparser
+/// targets are found by a binary search over their sorted addresses.
+static constexpr uint32_t max_table_entries_per_target = 32;
+
+static void create_switch_jump_table(
+    IRBuilder<> &b,
+    Value *load_pc,
+    BasicBlock *err_block,
+    const vector<pair<uint32_t, BasicBlock *>> &targets)
+{
+    SwitchInst *jump_table = b.CreateSwitch(load_pc, err_block, targets.size());
+    for (const auto &[pc, target] : targets) {
+        createJumpTableEntry(jump_table, target);
+    }
+}
+
+/// Look up the case index of @PC in an array that is indexed by the offset of @PC from the first
+/// target, so an unknown edge costs a range check and a load. Addresses outside of the targets
+/// go to err_block and addresses in the range that are not targets get index 0.
+static auto create_dense_index(
+    IRBuilder<> &b,
+    Value *load_pc,
+    BasicBlock *err_block,
+    const vector<pair<uint32_t, BasicBlock *>> &targets) -> Value *
+{
+    Function *wrapper = err_block->getParent();
+    LLVMContext &ctx = wrapper->getContext();
+    uint32_t first_pc = targets.front().first;
+    uint32_t size = targets.back().first - first_pc + 1;
+
+    // Most functions have fewer than 2^16 targets, which halves the size of the table.
+    IntegerType *index_type =
+        targets.size() < UINT16_MAX ? Type::getInt16Ty(ctx) : Type::getInt32Ty(ctx);
+    vector<Constant *> entries(size, ConstantInt::get(index_type, 0));
+    for (size_t i = 0; i < targets.size(); ++i) {
+        entries[targets[i].first - first_pc] = ConstantInt::get(index_type, i + 1);
+    }
+    auto *table_type = ArrayType::get(index_type, size);
+    auto *table = new GlobalVariable(
+        *wrapper->getParent(),
+        table_type,
+        true,
+        GlobalValue::PrivateLinkage,
+        ConstantArray::get(table_type, entries),
+        wrapper->getName() + ".jumptable");
+    table->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+
+    // The offset wraps around for addresses below the first target, so one unsigned comparison
+    // checks both bounds.
+    BasicBlock *load_block = BasicBlock::Create(ctx, "jumptable.load", wrapper);
+    Value *offset = b.CreateSub(load_pc, b.getInt32(first_pc), "jumptable.offset");
+    b.CreateCondBr(b.CreateICmpULT(offset, b.getInt32(size)), load_block, err_block);
+
+    b.SetInsertPoint(load_block);
+    Value *entry = b.CreateInBoundsGEP(table_type, table, {b.getInt32(0), offset});
+    return b.CreateLoad(index_type, entry, "jumptable.index");
+}
+
+/// Look up the case index of @PC by a binary search over the sorted addresses of the targets.
+/// Addresses that are not targets get index 0.
+static auto create_sorted_index(
+    IRBuilder<> &b,
+    Value *load_pc,
+    const vector<pair<uint32_t, BasicBlock *>> &targets) -> Value *
+{
+    BasicBlock *entry_block = b.GetInsertBlock();
+    Function *wrapper = entry_block->getParent();
+    LLVMContext &ctx = wrapper->getContext();
+    IntegerType *i32 = b.getInt32Ty();
+
+    vector<Constant *> entries;
+    entries.reserve(targets.size());
+    for (const auto &[pc, target] : targets) {
+        entries.push_back(b.getInt32(pc));
+    }
+    auto *table_type = ArrayType::get(i32, targets.size());
+    auto *table = new GlobalVariable(
+        *wrapper->getParent(),
+        table_type,
+        true,
+        GlobalValue::PrivateLinkage,
+        ConstantArray::get(table_type, entries),
+        wrapper->getName() + ".jumptable");
+    table->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+    auto load_entry = [&](Value *i) {
+        return b.CreateLoad(i32, b.CreateInBoundsGEP(table_type, table, {b.getInt32(0), i}));
+    };
+
+    // Find the first target that is not below @PC in [low, high).
+    BasicBlock *search_block = BasicBlock::Create(ctx, "jumptable.search", wrapper);
+    BasicBlock *step_block = BasicBlock::Create(ctx, "jumptable.step", wrapper);
+    BasicBlock *found_block = BasicBlock::Create(ctx, "jumptable.found", wrapper);
+    b.CreateBr(search_block);
+
+    b.SetInsertPoint(search_block);
+    PHINode *low = b.CreatePHI(i32, 2, "jumptable.low");
+    PHINode *high = b.CreatePHI(i32, 2, "jumptable.high");
+    low->addIncoming(b.getInt32(0), entry_block);
+    high->addIncoming(b.getInt32(targets.size()), entry_block);
+    b.CreateCondBr(b.CreateICmpULT(low, high), step_block, found_block);
+
+    b.SetInsertPoint(step_block);
+    Value *mid = b.CreateLShr(b.CreateAdd(low, high), 1, "jumptable.mid");
+    Value *below = b.CreateICmpULT(load_entry(mid), load_pc);
+    low->addIncoming(b.CreateSelect(below, b.CreateAdd(mid, b.getInt32(1)), low), step_block);
+    high->addIncoming(b.CreateSelect(below, high, mid), step_block);
+    b.CreateBr(search_block);
+
+    // Addresses above all targets end the search past the last one.
+    b.SetInsertPoint(found_block);
+    Value *last = b.getInt32(targets.size() - 1);
+    Value *clamped = b.CreateSelect(b.CreateICmpULT(low, last), low, last);
+    Value *found = b.CreateICmpEQ(load_entry(clamped), load_pc);
+    return b.CreateSelect(
+        found,
+        b.CreateAdd(clamped, b.getInt32(1)),
+        b.getInt32(0),
+        "jumptable.index");
+}
+
+/// Dispatch on a case index, where index i + 1 selects targets[i] and index 0 selects
+/// err_block. The high bits of the index select a switch over consecutive cases, which the
+/// backend lowers to a jump table, so no switch has more than max_cases_per_switch cases.
+static void create_index_dispatch(
+    IRBuilder<> &b,
+    Value *index,
+    BasicBlock *err_block,
+    const vector<pair<uint32_t, BasicBlock *>> &targets)
 {
     Function *wrapper = err_block->getParent();
+    auto *index_type = cast<IntegerType>(index->getType());
+    size_t buckets = targets.size() / max_cases_per_switch + 1;
+
+    SwitchInst *bucket_switch =
+        b.CreateSwitch(b.CreateLShr(index, case_bits, "jumptable.bucket"), err_block, buckets);
+    for (size_t bucket = 0; bucket < buckets; ++bucket) {
+        BasicBlock *bucket_block =
+            BasicBlock::Create(wrapper->getContext(), "jumptable.bucket", wrapper);
+        bucket_switch->addCase(ConstantInt::get(index_type, bucket), bucket_block);
+
+        IRBuilder<> bucket_builder{bucket_block};
+        SwitchInst *dispatch =
+            bucket_builder.CreateSwitch(index, err_block, max_cases_per_switch);
+        size_t first = max<size_t>(bucket * max_cases_per_switch, 1);
+        size_t end = min<size_t>((bucket + 1) * max_cases_per_switch, targets.size() + 1);
+        for (size_t i = first; i < end; ++i) {
+            dispatch->addCase(ConstantInt::get(index_type, i), targets[i - 1].second);
+        }
+    }
+}
 
-    // find error block and count recovered blocks
-    unsigned num_cases = 0;
+static void create_jump_table(BasicBlock *err_block)
+{
+    Function *wrapper = err_block->getParent();
+
+    // collect the recovered blocks by address
+    vector<pair<uint32_t, BasicBlock *>> targets;
     for (BasicBlock &bb : *wrapper) {
         if (is_possible_jump_target(&bb))
-            num_cases++;
+            targets.emplace_back(getBlockAddress(&bb), &bb);
     }
-    PASS_ASSERT(num_cases > 0);
-
-    DBG("creating BB jump table of size " << num_cases);
+    PASS_ASSERT(!targets.empty());
+    std::sort(targets.begin(), targets.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first < rhs.first;
+    });
+    targets.erase(
+        std::unique(
+            targets.begin(),
+            targets.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.first == rhs.first; }),
+        targets.end());
+
+    uint64_t table_size = uint64_t{targets.back().first} - targets.front().first + 1;
+    bool indexed = targets.size() > max_cases_per_switch;
+    bool dense = table_size <= uint64_t{max_table_entries_per_target} * targets.size();
+    DBG("creating " << (!indexed ? "switch" : dense ? "dense" : "sorted")
+                    << " BB jump table with " << targets.size() << " targets");
 
     // create new jump table block which replaces the error block
     BasicBlock *jump_table_block = BasicBlock::Create(wrapper->getContext(), "jumptable", wrapper);
@@ -119,8 +292,22 @@ static auto create_jump_table(BasicBlock *err_block) -> SwitchInst *
     Value *pc_global = wrapper->getParent()->getNamedGlobal("PC");
     Value *load_pc = b.CreateLoad(pc_global->getType()->getPointerElementType(), pc_global);
 
-    // add a switch statement on the value of @PC that defaults to the old error block
-    return b.CreateSwitch(load_pc, err_block, num_cases);
+    // dispatch on the value of @PC and default to the old error block
+    if (!indexed) {
+        create_switch_jump_table(b, load_pc, err_block, targets);
+        return;
+    }
+
+    // The lookup is the default of an empty switch on @PC, which later passes can still add
+    // cases to. Unlike a table of block addresses dispatched by indirectbr, the index keeps the
+    // wrapper free of address-taken blocks, so it can still be inlined and split into shards.
+    BasicBlock *lookup_block =
+        BasicBlock::Create(wrapper->getContext(), "jumptable.lookup", wrapper);
+    b.CreateSwitch(load_pc, lookup_block);
+    b.SetInsertPoint(lookup_block);
+    Value *index = dense ? create_dense_index(b, load_pc, err_block, targets)
+                         : create_sorted_index(b, load_pc, targets);
+    create_index_dispatch(b, index, err_block, targets);
 }
 
 // Find the first recovered block, searching predecessors. If bb is itself a recovered
@@ -139,20 +326,24 @@ static auto find_master_block(BasicBlock *bb) -> BasicBlock *
     return bb;
 }
 
+PcJumpsPass::PcJumpsPass(fallback::Mode fallback_mode) : fallback_mode{fallback_mode}
+{
+}
 
 // NOLINTNEXTLINE
 auto PcJumpsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    TraceInfo &ti = am.getResult<TraceInfoAnalysis>(m);
-    FunctionInfo fi{ti};
+    const CachedTraceInfo &trace = *am.getResult<TraceInfoAnalysis>(m);
+    const TraceInfo &ti = trace.trace_info();
 
+    SuccessorGraph &graph = am.getResult<SuccessorGraphAnalysis>(m);
     GlobalVariable *global_pc = m.getNamedGlobal("PC");
 
     for (Function &f : m) {
         if (!f.getName().startswith("Func_"))
             continue;
 
-        BasicBlock *err_bb = create_error_block(m, &f);
+        BasicBlock *err_bb = create_error_block(m, &f, fallback_mode);
 
         for (BasicBlock &bb : f) {
             vector<BasicBlock *> successors;
@@ -160,7 +351,7 @@ auto PcJumpsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
             if (!master_block)
                 continue;
 
-            getBlockSuccs(master_block, successors);
+            graph.successor_blocks(*master_block, successors);
 
             auto *terminator = bb.getTerminator();
             if (!isa<ReturnInst>(terminator) || successors.empty())
@@ -213,16 +404,12 @@ auto PcJumpsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 
         for (BasicBlock &bb : f) {
             // Remove metadata here, because it simplifies later passes.
-            setBlockSuccs(&bb, {});
+            graph.set(bb, {}, EdgeKind::TRACED);
         }
+        graph.materialize();
 
-        if (fallbackMode == fallback::EXTENDED) {
-            SwitchInst *jump_table = create_jump_table(err_bb);
-
-            for (BasicBlock &bb : f) {
-                if (is_possible_jump_target(&bb))
-                    createJumpTableEntry(jump_table, &bb);
-            }
+        if (fallback_mode == fallback::EXTENDED) {
+            create_jump_table(err_bb);
         }
     }
     return PreservedAnalyses::none();
@@ -1,12 +1,16 @@
 #ifndef BINREC_PC_JUMPS_HPP
 #define BINREC_PC_JUMPS_HPP
 
+#include "pass_utils.hpp"
 #include <llvm/IR/PassManager.h>
 
 namespace binrec {
     /// S2E Replace stores to PC followed by returns with branches
     class PcJumpsPass : public llvm::PassInfoMixin<PcJumpsPass> {
     public:
+        /// fallback_mode chooses how the error block handles pcs that are not in the switch.
+        explicit PcJumpsPass(fallback::Mode fallback_mode);
+
         /// For each BB_xxxxxx in @wrapper, replace:
         ///   ret void !{blockaddress(@wrapper, %BB_xxxxxx), ...}
         /// with:
@@ -16,6 +20,9 @@ namespace binrec {
         ///       ...
         ///   ]
         auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> llvm::PreservedAnalyses;
+
+    private:
+        fallback::Mode fallback_mode;
     };
 } // namespace binrec
 
@@ -1,7 +1,5 @@
 #include "prune_null_succs.hpp"
-#include "ir/selectors.hpp"
-#include "meta_utils.hpp"
-#include "pass_utils.hpp"
+#include "analysis/successor_graph.hpp"
 #include <llvm/IR/PassManager.h>
 
 using namespace binrec;
@@ -10,27 +8,12 @@ using namespace llvm;
 // NOLINTNEXTLINE
 auto PruneNullSuccsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    std::vector<Function *> succs;
+    // Successors that were erased are dropped while the successor lists are read, so writing
+    // them back prunes them.
+    SuccessorGraph &graph = am.getResult<SuccessorGraphAnalysis>(m);
+    graph.materialize();
 
-    for (Function &f : LiftedFunctions{m}) {
-        MDNode *md;
-        if ((md = getBlockMeta(&f, "succs"))) {
-            bool update = false;
-            succs.clear();
-
-            for (unsigned i = 0, i_upper_bound = md->getNumOperands(); i < i_upper_bound; ++i) {
-                if (const MDOperand &op = md->getOperand(i)) {
-                    Value *value = cast<ValueAsMetadata>(op)->getValue();
-                    succs.push_back(cast<Function>(value));
-                } else {
-                    update = true;
-                }
-            }
-
-            if (update) {
-                setBlockSuccs(&f, succs);
-            }
-        }
-    }
-    return PreservedAnalyses::none();
+    PreservedAnalyses preserved = PreservedAnalyses::none();
+    preserved.preserve<SuccessorGraphAnalysis>();
+    return preserved;
 }
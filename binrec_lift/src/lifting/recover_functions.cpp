@@ -1,4 +1,5 @@
 #include "recover_functions.hpp"
+#include "analysis/block_registry.hpp"
 #include "analysis/trace_info_analysis.hpp"
 #include "error.hpp"
 #include "meta_utils.hpp"
@@ -209,7 +210,7 @@ namespace {
     }
 
 
-    Function *get_main(Function *entrypoint, Module &m)
+    Function *get_main(Function *entrypoint, Module &m, const BlockRegistry &blocks)
     {
         auto mainpc = locate_main_addr(entrypoint, m);
         if (mainpc == 0) {
@@ -218,8 +219,7 @@ namespace {
         }
 
         // Return the Func_xxxxxx
-        auto main = "Func_" + utohexstr(mainpc);
-        return m.getFunction(main);
+        return blocks.function(mainpc);
     }
 
 } // namespace
@@ -350,8 +350,8 @@ static void tail_call_helper(uint32_t address, ParsedInfo &info, set<uint32_t> &
 // High level wrapper for fixing BB info for tail calls
 static void handle_info_for_tail_calls(
     unordered_map<Function *, DenseSet<Function *>> &tb_map,
-    TraceInfo &ti,
-    FunctionInfo &fl)
+    const TraceInfo &ti,
+    const FunctionInfo &fl)
 {
     ParsedInfo info;
     info.ret_addrs_for_entry_addrs = fl.get_ret_pcs_for_entry_pcs();
@@ -466,14 +466,14 @@ static void handle_info_for_tail_calls(
 // NOLINTNEXTLINE
 auto RecoverFunctionsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    TraceInfo &ti = am.getResult<TraceInfoAnalysis>(m);
-    FunctionInfo fl{ti};
+    const FunctionInfo &fl = am.getResult<TraceInfoAnalysis>(m)->function_info();
+    BlockRegistry &blocks = am.getResult<BlockRegistryAnalysis>(m);
     unordered_map<uint32_t, set<uint32_t>> cfg;
     DenseSet<uint32_t> visited;
 
     LLVMContext &context = m.getContext();
 
-    unordered_map<Function *, DenseSet<Function *>> tb_map = fl.get_tbs_by_function_entry(m);
+    unordered_map<Function *, DenseSet<Function *>> tb_map = fl.get_tbs_by_function_entry(blocks);
     multimap<Function *, BasicBlock *> tb_to_bb;
     vector<pair<Function *, Function *>> merged_functions;
 
@@ -534,7 +534,9 @@ auto RecoverFunctionsPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
     // causes a segfault. So it appears that another part of binrec_lift relies on the
     // function name being erased after merging.
     for (auto item : merged_functions) {
+        blocks.erase(*item.second);
         item.first->takeName(item.second);
+        blocks.insert(*item.first);
     }
 
     for (auto bb : tb_to_bb) {
@@ -545,19 +547,22 @@ auto RecoverFunctionsPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
          tb_to_bb_pair = tb_to_bb.upper_bound(tb_to_bb_pair->first))
     {
         Function *f = tb_to_bb_pair->first;
+        blocks.erase(*f);
         f->eraseFromParent();
     }
 
-    vector<Function *> entry_points = fl.get_entrypoint_functions(m);
+    vector<Function *> entry_points = fl.get_entrypoint_functions(blocks);
     PASS_ASSERT(!entry_points.empty() && "No entry points, can't recover main");
     auto *wrapper = m.getFunction("Func_wrapper");
     PASS_ASSERT(wrapper);
     BasicBlock *entry_block = BasicBlock::Create(context, "", wrapper);
     // NOTE (hbrodin): Changed how main function is located due to update S2E version
-    auto main_func = get_main(entry_points[0], m);
+    auto main_func = get_main(entry_points[0], m, blocks);
     PASS_ASSERT(main_func && "Failed to locate main-function");
     CallInst::Create(main_func, {}, "", entry_block);
     ReturnInst::Create(context, entry_block);
 
-    return PreservedAnalyses::none();
+    PreservedAnalyses preserved = PreservedAnalyses::none();
+    preserved.preserve<BlockRegistryAnalysis>();
+    return preserved;
 }
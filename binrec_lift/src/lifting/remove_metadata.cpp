@@ -12,6 +12,11 @@ static void remove_from_module(Module &m, StringRef name)
         md->eraseFromParent();
 }
 
+RemoveMetadataPass::RemoveMetadataPass(unsigned debug_verbosity) :
+        debug_verbosity{debug_verbosity}
+{
+}
+
 // NOLINTNEXTLINE
 auto RemoveMetadataPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
@@ -22,16 +27,17 @@ auto RemoveMetadataPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedA
         for (BasicBlock &bb : f) {
             setBlockMeta(&bb, "extern_symbol", nullptr);
             setBlockMeta(&bb, "succs", nullptr);
+            setBlockMeta(&bb, "succs_kind", nullptr);
             setBlockMeta(&bb, "lastpc", nullptr);
             setBlockMeta(&bb, "merged", nullptr);
 
-            if (debugVerbosity == 0)
+            if (debug_verbosity == 0)
                 setBlockMeta(&bb, "funcname", nullptr);
 
             for (Instruction &i : bb) {
                 i.setMetadata("srcloc", nullptr);
 
-                if (debugVerbosity == 0)
+                if (debug_verbosity == 0)
                     i.setMetadata("inststart", nullptr);
             }
         }
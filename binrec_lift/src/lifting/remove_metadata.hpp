@@ -7,7 +7,13 @@ namespace binrec {
     /// S2E Remove all unused metadata if not in debug mode
     class RemoveMetadataPass : public llvm::PassInfoMixin<RemoveMetadataPass> {
     public:
+        /// The metadata used by the debug helpers is kept at a debug verbosity above 0.
+        explicit RemoveMetadataPass(unsigned debug_verbosity);
+
         auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> llvm::PreservedAnalyses;
+
+    private:
+        unsigned debug_verbosity;
     };
 } // namespace binrec
 
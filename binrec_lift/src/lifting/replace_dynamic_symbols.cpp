@@ -1,4 +1,5 @@
 #include "replace_dynamic_symbols.hpp"
+#include "analysis/source_binary.hpp"
 #include "error.hpp"
 #include "pass_utils.hpp"
 #include <llvm/IR/IRBuilder.h>
@@ -9,19 +10,12 @@ using namespace llvm;
 using namespace llvm::object;
 using namespace std;
 
-static auto get_symbols(Module &m) -> map<uint32_t, string>
+static auto get_symbols(Module &m, const SourceBinary &binary) -> map<uint32_t, string>
 {
-    auto binary_or_err = createBinary("binary");
-    if (auto err = binary_or_err.takeError()) {
-        LLVM_ERROR(error) << err;
-        throw binrec::lifting_error{"replace_dynamic_symbols", error};
-    }
-    auto &binary = binary_or_err.get();
-
     map<uint32_t, string> symmap;
 
-    auto *elf = dyn_cast<ELFObjectFileBase>(binary.getBinary());
-    for (ELFSymbolRef symbol : elf->getDynamicSymbolIterators()) {
+    const ELFObjectFileBase &elf = binary.elf();
+    for (ELFSymbolRef symbol : elf.getDynamicSymbolIterators()) {
         auto address = symbol.getAddress();
         if (address.takeError() || *address == 0)
             continue;
@@ -51,7 +45,7 @@ static auto get_symbols(Module &m) -> map<uint32_t, string>
 // NOLINTNEXTLINE
 auto ReplaceDynamicSymbolsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    auto symbol_map = get_symbols(m);
+    auto symbol_map = get_symbols(m, am.getResult<SourceBinaryAnalysis>(m));
 
     vector<CallInst *> loads;
     for (auto &f : m) {
@@ -1,49 +1,35 @@
 #include "successor_lists.hpp"
-#include "meta_utils.hpp"
+#include "analysis/block_registry.hpp"
+#include "analysis/successor_graph.hpp"
+#include "analysis/trace_info_analysis.hpp"
 #include "pass_utils.hpp"
 #include "binrec/tracing/trace_info.hpp"
-#include <fstream>
 
 using namespace binrec;
 using namespace llvm;
 
-static auto get_cached_func(std::map<uint32_t, Function *> &bb_cache, Module &m, uint32_t pc)
-    -> Function *
-{
-    auto cached_func = bb_cache.find(pc);
-    if (cached_func == bb_cache.end()) {
-        cached_func = bb_cache.emplace(pc, m.getFunction("Func_" + utohexstr(pc))).first;
-    }
-    return cached_func->second;
-}
-
 // NOLINTNEXTLINE
 auto SuccessorListsPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    TraceInfo ti;
-    {
-        std::ifstream f;
-        s2eOpen(f, TraceInfo::defaultFilename);
-        f >> ti;
-    }
+    const CachedTraceInfo &trace = *am.getResult<TraceInfoAnalysis>(m);
+    const BlockRegistry &blocks = am.getResult<BlockRegistryAnalysis>(m);
+    SuccessorGraph &graph = am.getResult<SuccessorGraphAnalysis>(m);
 
-    std::map<uint32_t, Function *> bb_cache;
-    for (auto successor : ti.successors) {
-        uint32_t pred = successor.pc;
-        uint32_t succ = successor.successor;
-        Function *pred_bb = get_cached_func(bb_cache, m, pred);
+    for (const auto &[pred, succ_pcs] : trace.successors()) {
+        Function *pred_bb = blocks.function(pred);
 
-        if (!pred_bb) {
+        if (!pred_bb || pred_bb->isDeclaration()) {
             // A block can be removed manually from the bitcode file
             continue;
         }
 
-        Function *succ_bb = get_cached_func(bb_cache, m, succ);
-
-        std::vector<Function *> succs;
-        getBlockSuccs(pred_bb, succs);
-        succs.push_back(succ_bb);
-        setBlockSuccs(pred_bb, succs);
+        for (uint32_t succ : succ_pcs) {
+            Function *succ_bb = blocks.function(succ);
+            if (succ_bb && !succ_bb->isDeclaration()) {
+                graph.add(pred_bb->getEntryBlock(), succ_bb->getEntryBlock(), EdgeKind::TRACED);
+            }
+        }
     }
+    graph.materialize();
     return PreservedAnalyses::all();
 }
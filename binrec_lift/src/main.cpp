@@ -3,6 +3,7 @@
 #include "binrec_lift.hpp"
 #include "error.hpp"
 #include "lift_context.hpp"
+#include "pass_utils.hpp"
 #include <llvm/ADT/Triple.h>
 #include <llvm/Analysis/AliasAnalysis.h>
 #include <llvm/Analysis/GlobalsModRef.h>
@@ -34,6 +35,13 @@ opt<bool> Lift{"lift", desc{"Lift trace into correct LLVM module"}};
 opt<bool> Optimize{"optimize", desc{"Optimize module"}};
 opt<bool> Optimize_Better{"optimize-better", desc{"Optimize module better"}};
 opt<bool> Compile{"compile", desc{"Compile the trace to an object file"}};
+opt<bool> Full_Pipeline{
+    "full-pipeline",
+    desc{"Clean, link with custom helpers, lift, optimize, and compile to an object file"}};
+opt<string> Custom_Helpers{
+    "custom-helpers",
+    desc{"Custom helpers bitcode linked in by -full-pipeline"},
+    value_desc{"filename"}};
 
 opt<bool> No_Link_Lift{"no-link-lift", desc{"Do not lift dynamic symbols"}};
 opt<bool> Clean_Names{"clean-names", desc{"Do not lift dynamic symbols"}};
@@ -42,6 +50,71 @@ opt<bool> Trace_Calls{
     "trace-calls",
     desc{"Trace calls and register values of recovered functions"}};
 
+opt<OutputPolicy> Output_Policy{
+    "output",
+    desc{"Artifacts to write next to the output bitcode"},
+    values(
+        clEnumValN(OutputPolicy::BITCODE, "bitcode", "(default) Only write bitcode"),
+        clEnumValN(OutputPolicy::TEXT, "text", "Also write textual IR"),
+        clEnumValN(OutputPolicy::MEMSSA, "memssa", "Also write IR annotated with MemorySSA")),
+    init(OutputPolicy::BITCODE)};
+opt<unsigned> Jobs{
+    "j",
+    desc{"Number of threads used by -split-module (default: all cores)"},
+    init(0)};
+opt<bool> Split_Module{
+    "split-module",
+    desc{"Optimize and compile shards of the module in parallel, across -j threads"}};
+opt<bool> Profile{
+    "profile",
+    desc{"Write the time, memory use, and IR size of every pass to <output>-passes.json"}};
+
+opt<logging::Level> Log_Level{
+    "loglevel",
+    desc{"Logging level"},
+    values(
+        clEnumValN(logging::ERROR, "error", "Only show errors"),
+        clEnumValN(logging::WARNING, "warning", "Show warnings"),
+        clEnumValN(
+            logging::INFO,
+            "info",
+            "(default) Show some informative messages about what passes are doing"),
+        clEnumValN(logging::DEBUG, "debug", "Show extensive debug messages")),
+    init(logging::INFO)};
+opt<fallback::Mode> Fallback_Mode{
+    "fallback-mode",
+    desc{"How to handle edges that are not recorded in successor lists"},
+    values(
+        clEnumValN(
+            fallback::NONE,
+            "none",
+            "(default) Make error block unreachable, allows most optimization"
+            " (assumes a single code path)"),
+        clEnumValN(
+            fallback::ERROR1,
+            "error1",
+            "Print prevPC and PC values when execution diverged."),
+        clEnumValN(fallback::ERROR, "error", "Print PC value to which execution diverged."),
+        clEnumValN(fallback::BASIC, "basic", "Fallback for any unknown edge"),
+        clEnumValN(
+            fallback::EXTENDED,
+            "extended",
+            "Basic fallback + jump table for unknown edges with"
+            " target blocks that are in the recovered set"),
+        clEnumValN(
+            fallback::UNFALLBACK,
+            "unfallback",
+            "extended + try to return to recovered code")),
+    init(fallback::NONE)};
+opt<unsigned> Debug_Verbosity{
+    "debug-verbosity",
+    desc{"Verbosity of generated code (0: default, 1: basic log, 2: register log"},
+    value_desc{"level"}};
+llvm::cl::list<unsigned> Break_At{
+    "break-at",
+    desc{"Basic block addresses to insert debugging breakpoints at"},
+    value_desc{"address"}};
+
 
 auto main(int argc, char *argv[]) -> int
 {
@@ -64,9 +137,22 @@ auto main(int argc, char *argv[]) -> int
     ctx.skip_link = No_Link_Lift;
     ctx.clean_names = Clean_Names;
     ctx.trace_calls = Trace_Calls;
+    ctx.output = Output_Policy;
+    ctx.custom_helpers_filename = Custom_Helpers;
+    ctx.jobs = Jobs;
+    ctx.split_module = Split_Module;
+    ctx.profile = Profile;
+    ctx.log_level = Log_Level;
+    ctx.fallback_mode = Fallback_Mode;
+    ctx.debug_verbosity = Debug_Verbosity;
+    ctx.break_at.assign(Break_At.begin(), Break_At.end());
 
     try {
-        run_lift(ctx);
+        if (Full_Pipeline) {
+            run_full_pipeline(ctx);
+        } else {
+            run_lift(ctx);
+        }
     } catch (lifting_error &error) {
         errs() << "[" << error.pass() << "] " << error.what() << "\n";
     } catch (runtime_error &error) {
@@ -0,0 +1,60 @@
+#include "merging/link_bitcode.hpp"
+#include "pass_utils.hpp"
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace llvm;
+using namespace llvm::cl;
+using namespace binrec;
+using namespace std;
+
+list<string> Input_Filenames{
+    Positional,
+    OneOrMore,
+    desc{"<link-ready bitcode files>"},
+    value_desc{"filename"}};
+opt<bool> Prepare{
+    "prepare",
+    desc{"Inputs are captured bitcode that is prepared for linking before it is merged"}};
+opt<string> Output_Filename{"o", desc{"Output filename"}, value_desc{"filename"}, Required};
+opt<unsigned> Jobs{
+    "j",
+    desc{"Number of threads used to read and link the inputs (default: all cores)"},
+    init(0)};
+opt<logging::Level> Log_Level{
+    "loglevel",
+    desc{"Logging level of the -prepare passes"},
+    values(
+        clEnumValN(logging::ERROR, "error", "Only show errors"),
+        clEnumValN(logging::WARNING, "warning", "Show warnings"),
+        clEnumValN(logging::INFO, "info", "(default) Show informative messages"),
+        clEnumValN(logging::DEBUG, "debug", "Show extensive debug messages")),
+    init(logging::INFO)};
+
+
+auto main(int argc, char *argv[]) -> int
+{
+    InitLLVM init_llvm{argc, argv};
+
+    ParseCommandLineOptions(
+        argc,
+        argv,
+        "BinRec capture merger\n\n"
+        "Links prepared captures into one module. Definitions from earlier inputs take\n"
+        "precedence over definitions from later inputs.\n");
+
+    logging::ThresholdScope threshold{Log_Level};
+    try {
+        if (Prepare) {
+            merge_captures(Input_Filenames, Output_Filename, Jobs);
+        } else {
+            link_bitcode_files(Input_Filenames, Output_Filename, Jobs);
+        }
+    } catch (runtime_error &error) {
+        errs() << error.what() << "\n";
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include "link_bitcode.hpp"
+#include "analysis/block_registry.hpp"
+#include "analysis/env_alias_analysis.hpp"
+#include "analysis/successor_graph.hpp"
+#include "analysis/trace_info_analysis.hpp"
+#include "binrec_lift.hpp"
+#include "error.hpp"
+#include "pass_utils.hpp"
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/DiagnosticInfo.h>
+#include <llvm/IR/DiagnosticPrinter.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace llvm;
+using namespace std;
+
+namespace {
+    /// Collect error diagnostics instead of letting LLVM exit the process, since links run on
+    /// worker threads.
+    void collect_diagnostic(const DiagnosticInfo &info, void *context)
+    {
+        if (info.getSeverity() != DS_Error) {
+            return;
+        }
+        raw_string_ostream os{*static_cast<string *>(context)};
+        DiagnosticPrinterRawOStream printer{os};
+        info.print(printer);
+        os << '\n';
+    }
+
+    auto parse(MemoryBufferRef buffer, LLVMContext &context, string &error) -> unique_ptr<Module>
+    {
+        Expected<unique_ptr<Module>> module = parseBitcodeFile(buffer, context);
+        if (!module) {
+            error += buffer.getBufferIdentifier().str() + ": " + toString(module.takeError());
+            return nullptr;
+        }
+        return move(*module);
+    }
+
+    auto write_bitcode(const Module &module) -> unique_ptr<MemoryBuffer>
+    {
+        SmallVector<char, 0> bitcode;
+        raw_svector_ostream os{bitcode};
+        WriteBitcodeToFile(module, os);
+        return make_unique<SmallVectorMemoryBuffer>(
+            move(bitcode),
+            module.getModuleIdentifier(),
+            false);
+    }
+
+    /// Link source into base, keeping the definitions of base, and return the result as bitcode.
+    auto link_pair(MemoryBufferRef base, MemoryBufferRef source, string &error)
+        -> unique_ptr<MemoryBuffer>
+    {
+        LLVMContext context;
+        context.setDiagnosticHandlerCallBack(collect_diagnostic, &error);
+
+        auto composite = make_unique<Module>(base.getBufferIdentifier(), context);
+        Linker linker{*composite};
+        for (auto [buffer, flags] :
+             {pair{source, Linker::Flags::None}, pair{base, Linker::Flags::OverrideFromSrc}})
+        {
+            unique_ptr<Module> module = parse(buffer, context, error);
+            if (!module) {
+                return nullptr;
+            }
+            if (linker.linkInModule(move(module), flags)) {
+                error += "failed to link " + buffer.getBufferIdentifier().str();
+                return nullptr;
+            }
+        }
+
+        return write_bitcode(*composite);
+    }
+
+    /// Run the link preparation passes, link_prep_1 followed by link_prep_2, on a capture and
+    /// return the prepared module as bitcode.
+    auto prepare_capture(const string &capture, string &error) -> unique_ptr<MemoryBuffer>
+    {
+        LLVMContext context;
+        context.setDiagnosticHandlerCallBack(collect_diagnostic, &error);
+
+        SMDiagnostic err;
+        unique_ptr<Module> module = parseIRFile(capture, err, context);
+        if (!module) {
+            raw_string_ostream os{error};
+            err.print("binrec-lift", os);
+            return nullptr;
+        }
+
+        PassBuilder pb;
+        AAManager aa = pb.buildDefaultAAPipeline();
+        aa.registerFunctionAnalysis<binrec::EnvAa>();
+
+        LoopAnalysisManager lam;
+        FunctionAnalysisManager fam;
+        fam.registerPass([] { return binrec::EnvAa{}; });
+        CGSCCAnalysisManager cgam;
+        ModuleAnalysisManager mam;
+
+        mam.registerPass([] { return binrec::TraceInfoAnalysis{}; });
+        mam.registerPass([] { return binrec::BlockRegistryAnalysis{}; });
+        mam.registerPass([] { return binrec::SuccessorGraphAnalysis{}; });
+        fam.registerPass([&] { return move(aa); });
+
+        pb.registerModuleAnalyses(mam);
+        pb.registerCGSCCAnalyses(cgam);
+        pb.registerFunctionAnalyses(fam);
+        pb.registerLoopAnalyses(lam);
+        pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+        binrec::LiftContext ctx;
+        ctx.trace_filename = capture;
+        ctx.link_prep_1 = true;
+        ctx.link_prep_2 = true;
+
+        try {
+            ModulePassManager mpm = binrec::build_pipeline(ctx, pb);
+            mpm.run(*module, mam);
+        } catch (binrec::lifting_error &err) {
+            error += capture + ": [" + err.pass() + "] " + err.what();
+            return nullptr;
+        } catch (runtime_error &err) {
+            error += capture + ": " + err.what();
+            return nullptr;
+        }
+
+        return write_bitcode(*module);
+    }
+
+    void check_errors(const vector<string> &errors)
+    {
+        string message;
+        for (const string &error : errors) {
+            if (!error.empty()) {
+                message += error + "\n";
+            }
+        }
+        if (!message.empty()) {
+            throw runtime_error{message};
+        }
+    }
+
+    /// Link all runs into the first one and write it to destination. Runs that failed to load
+    /// must have been reported through errors already.
+    void link_runs(
+        ThreadPool &pool,
+        vector<unique_ptr<MemoryBuffer>> &runs,
+        vector<string> &errors,
+        const string &destination)
+    {
+        // Each level links every run into its left neighbour at the current stride, so the
+        // earlier run always keeps its definitions and the tree stays balanced.
+        for (size_t stride = 1; stride < runs.size(); stride *= 2) {
+            for (size_t lhs = 0; lhs + stride < runs.size(); lhs += 2 * stride) {
+                pool.async([&runs, &errors, lhs, stride] {
+                    unique_ptr<MemoryBuffer> merged = link_pair(
+                        runs[lhs]->getMemBufferRef(),
+                        runs[lhs + stride]->getMemBufferRef(),
+                        errors[lhs]);
+                    if (merged) {
+                        runs[lhs] = move(merged);
+                    }
+                    runs[lhs + stride].reset();
+                });
+            }
+            pool.wait();
+            check_errors(errors);
+        }
+
+        error_code ec;
+        raw_fd_ostream output{destination, ec};
+        if (ec) {
+            LLVM_ERROR(error) << "failed to open file " << destination << ": " << ec.message();
+            throw runtime_error{error};
+        }
+        output << runs.front()->getBuffer();
+    }
+} // namespace
+
+namespace binrec {
+    void link_bitcode_files(const vector<string> &inputs, const string &destination, unsigned jobs)
+    {
+        if (inputs.empty()) {
+            throw runtime_error{"no bitcode files to link"};
+        }
+
+        ThreadPool pool{hardware_concurrency(jobs)};
+        vector<unique_ptr<MemoryBuffer>> runs(inputs.size());
+        vector<string> errors(inputs.size());
+
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            pool.async([&inputs, &runs, &errors, i] {
+                ErrorOr<unique_ptr<MemoryBuffer>> buffer = MemoryBuffer::getFile(inputs[i]);
+                if (buffer) {
+                    runs[i] = move(*buffer);
+                } else {
+                    errors[i] = inputs[i] + ": " + buffer.getError().message();
+                }
+            });
+        }
+        pool.wait();
+        check_errors(errors);
+
+        link_runs(pool, runs, errors, destination);
+    }
+
+    void merge_captures(const vector<string> &captures, const string &destination, unsigned jobs)
+    {
+        if (captures.empty()) {
+            throw runtime_error{"no captures to merge"};
+        }
+
+        ThreadPool pool{hardware_concurrency(jobs)};
+        vector<unique_ptr<MemoryBuffer>> runs(captures.size());
+        vector<string> errors(captures.size());
+
+        logging::Level log_level = logging::threshold();
+        for (size_t i = 0; i < captures.size(); ++i) {
+            pool.async([&captures, &runs, &errors, log_level, i] {
+                logging::ThresholdScope threshold{log_level};
+                runs[i] = prepare_capture(captures[i], errors[i]);
+            });
+        }
+        pool.wait();
+        check_errors(errors);
+
+        link_runs(pool, runs, errors, destination);
+    }
+} // namespace binrec
@@ -0,0 +1,32 @@
+#ifndef BINREC_LINK_BITCODE_HPP
+#define BINREC_LINK_BITCODE_HPP
+
+#include <string>
+#include <vector>
+
+namespace binrec {
+    /// Link bitcode files into a single module and write it to destination.
+    ///
+    /// Definitions from earlier inputs override those of later inputs, which matches linking
+    /// every input with `llvm-link -override=<merged> <input>` in order. The inputs are read and
+    /// linked pairwise in a balanced tree on up to jobs threads (0 uses every core), and every
+    /// link runs in its own LLVMContext. Intermediate modules are only kept as in-memory
+    /// bitcode.
+    void link_bitcode_files(
+        const std::vector<std::string> &inputs,
+        const std::string &destination,
+        unsigned jobs = 0);
+
+    /// Prepare captured bitcode for linking and link it into a single module written to
+    /// destination.
+    ///
+    /// Every capture runs through the link_prep_1 and link_prep_2 pipelines in memory, on up to
+    /// jobs threads, and the prepared modules are linked as in link_bitcode_files without ever
+    /// being written to disk. The trace info of a capture is read from its directory.
+    void merge_captures(
+        const std::vector<std::string> &captures,
+        const std::string &destination,
+        unsigned jobs = 0);
+} // namespace binrec
+
+#endif
@@ -1,9 +1,11 @@
 #include "rename_block_funcs.hpp"
+#include "analysis/block_registry.hpp"
+#include "analysis/trace_info_analysis.hpp"
 #include "error.hpp"
 #include "ir/selectors.hpp"
 #include "pass_utils.hpp"
 #include "binrec/tracing/trace_info.hpp"
-#include <fstream>
+#include <llvm/Support/Path.h>
 #include <set>
 
 #define PASS_NAME "rename_block_funcs"
@@ -18,25 +20,31 @@ auto RenameBlockFuncsPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
     unsigned removed = 0, total = 0;
 
     // Find all distinct basic block addresses that should be in the CFG
-    TraceInfo ti;
+    std::shared_ptr<const CachedTraceInfo> trace;
     {
         // Can't use the default traceinfo filename here as this pass runs pre-link.
-        // Symbolic traces that are numbered have correspondingly name trace info files.
+        // Symbolic traces that are numbered have correspondingly name trace info files. The
+        // trace info is stored next to the captured bitcode, so captures can be prepared without
+        // changing the working directory.
         std::string modId = m.getModuleIdentifier();
-        std::string filename;
+        SmallString<128> dir = sys::path::parent_path(modId);
+        std::string name = TraceInfo::defaultName;
         std::size_t pos = modId.find("_", modId.find_last_of("/"));
-        if (pos == std::string::npos) {
-            filename = TraceInfo::defaultFilename;
-        } else {
-            filename = TraceInfo::defaultName + modId.substr(pos, 2) + TraceInfo::defaultSuffix;
+        if (pos != std::string::npos) {
+            name += modId.substr(pos, 2);
         }
 
-        std::ifstream f;
-        s2eOpen(f, filename);
-        f >> ti;
+        SmallString<128> path = dir;
+        sys::path::append(path, name);
+        if (findTraceInfo(path.str().str()).empty()) {
+            // A journal is shared by all states of a capture and is never numbered.
+            path = dir;
+            sys::path::append(path, TraceInfo::defaultName);
+        }
+        trace = TraceInfoCache::get().load(path.str().str());
     }
     std::set<uint32_t> known_pcs;
-    for (auto successor : ti.successors) {
+    for (auto successor : trace->trace_info().successors) {
         known_pcs.insert(successor.pc);
         known_pcs.insert(successor.successor);
     }
@@ -54,6 +62,7 @@ auto RenameBlockFuncsPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
     // function exists yet) or remove the unused block
     std::list<Function *> erase_list;
     std::set<uint32_t> renamed_pcs;
+    BlockRegistry *blocks = am.getCachedResult<BlockRegistryAnalysis>(m);
 
     for (Function &f : m) {
         if (f.hasName() && f.getName().startswith("tcg-llvm-")) {
@@ -66,6 +75,9 @@ auto RenameBlockFuncsPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
             } else {
                 f.setName("Func_" + utohexstr(address));
                 renamed_pcs.insert(address);
+                if (blocks) {
+                    blocks->insert(f);
+                }
             }
         }
         // Also fix any broken declarations with private linkage, which S2E
@@ -78,8 +90,12 @@ auto RenameBlockFuncsPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
 
     total += renamed_pcs.size();
 
-    for (Function *f : erase_list)
+    for (Function *f : erase_list) {
+        if (blocks) {
+            blocks->erase(*f);
+        }
         f->eraseFromParent();
+    }
 
     INFO(
         "renamed " << renamed_pcs.size() << " blocks, removed " << removed << " blocks, " << total
@@ -87,5 +103,7 @@ auto RenameBlockFuncsPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
 
     PASS_ASSERT(renamed_pcs.size() <= known_pcs.size());
 
-    return PreservedAnalyses::none();
+    PreservedAnalyses preserved = PreservedAnalyses::none();
+    preserved.preserve<BlockRegistryAnalysis>();
+    return preserved;
 }
@@ -75,6 +75,8 @@ void binrec::setBlockSuccs(BasicBlock *bb, const std::vector<BasicBlock *> &succ
     }
     MDNode *md = operands.empty() ? nullptr : MDNode::get(bb->getContext(), operands);
     setBlockMeta(bb, "succs", md);
+    // The edges are no longer tagged, see SuccessorGraph.
+    setBlockMeta(bb, "succs_kind", nullptr);
 }
 
 auto binrec::getBlockSuccs(Function *f, std::vector<Function *> &succs) -> bool
@@ -98,4 +100,5 @@ void binrec::setBlockSuccs(Function *f, const std::vector<Function *> &succs)
         succsMeta.push_back(ValueAsMetadata::get(succ));
     }
     setBlockMeta(f, "succs", MDNode::get(f->getContext(), succsMeta));
+    setBlockMeta(f, "succs_kind", nullptr);
 }
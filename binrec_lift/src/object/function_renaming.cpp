@@ -1,4 +1,6 @@
 #include "function_renaming.hpp"
+#include "analysis/block_registry.hpp"
+#include "analysis/source_binary.hpp"
 #include "error.hpp"
 #include "ir/selectors.hpp"
 
@@ -10,20 +12,9 @@ using namespace llvm;
 using namespace llvm::object;
 using namespace std;
 
-FunctionRenamingPass::FunctionRenamingPass()
-{
-    auto binary_or_err = createBinary("binary");
-    if (auto err = binary_or_err.takeError()) {
-        LLVM_ERROR(error) << err;
-        throw binrec::lifting_error{"function_renaming", error};
-    }
-    binary = move(binary_or_err.get());
-}
-
 auto FunctionRenamingPass::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
 {
-    auto *elf = dyn_cast<ELFObjectFileBase>(binary.getBinary());
-    PASS_ASSERT(elf);
+    const ELFObjectFileBase &elf = am.getResult<SourceBinaryAnalysis>(m).elf();
 
     DenseMap<uint64_t, Function *> address_to_func;
     for (Function &f : LiftedFunctions{m}) {
@@ -35,7 +26,7 @@ auto FunctionRenamingPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
         address_to_func.insert(make_pair(address, &f));
     }
 
-    for (ELFSymbolRef symbol : elf->symbols()) {
+    for (ELFSymbolRef symbol : elf.symbols()) {
         Expected<uint64_t> address = symbol.getAddress();
         if (address.takeError())
             continue;
@@ -47,5 +38,9 @@ auto FunctionRenamingPass::run(Module &m, ModuleAnalysisManager &am) -> Preserve
             continue;
         address_to_func_it->second->setName("Func_" + *name);
     }
-    return PreservedAnalyses::all();
+
+    // Functions are no longer named by their address.
+    PreservedAnalyses preserved = PreservedAnalyses::all();
+    preserved.abandon<BlockRegistryAnalysis>();
+    return preserved;
 }
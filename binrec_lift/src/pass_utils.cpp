@@ -12,64 +12,32 @@ namespace logging {
 
     static const char *const levelStrings[] = {"ERROR", "WARNING", "INFO", "DEBUG"};
 
+    static thread_local Level currentThreshold = INFO;
+
     auto getStream(logging::Level level) -> raw_ostream &
     {
-        if (level > logLevel)
+        if (level > currentThreshold)
             return dummy;
 
         errs() << "[" << levelStrings[level] << "] ";
         return errs();
     }
-} // namespace logging
 
-cl::opt<unsigned> debugVerbosity(
-    "debug-verbosity",
-    cl::desc("Verbosity of generated code (0: default, 1: basic log, 2: register log"),
-    cl::value_desc("level"));
-
-cl::opt<logging::Level> logLevel(
-    "loglevel",
-    cl::desc("Logging level"),
-    cl::values(
-        clEnumValN(logging::ERROR, "error", "Only show errors"),
-        clEnumValN(logging::WARNING, "warning", "Show warnings"),
-        clEnumValN(
-            logging::INFO,
-            "info",
-            "(default) Show some informative messages about what passes are doing"),
-        clEnumValN(logging::DEBUG, "debug", "Show extensive debug messages")),
-    cl::initializer<logging::Level>(logging::INFO));
-
-cl::opt<fallback::Mode> fallbackMode(
-    "fallback-mode",
-    cl::desc("How to handle edges that are not recorded in successor lists"),
-    cl::values(
-        clEnumValN(
-            fallback::NONE,
-            "none",
-            "Make error block unreachable, allows most optimization"
-            " (assumes a single code path)"),
-        clEnumValN(
-            fallback::ERROR1,
-            "error1",
-            "Print prevPC and PC values when execution diverged."),
-        clEnumValN(fallback::ERROR, "error", "Print PC value to which execution diverged."),
-        clEnumValN(fallback::BASIC, "basic", "Fallback for any unknown edge"),
-        clEnumValN(
-            fallback::EXTENDED,
-            "extended",
-            "(default) Basic fallback + jump table for unknown edges with"
-            " target blocks that are in the recovered set"),
-        clEnumValN(
-            fallback::UNFALLBACK,
-            "unfallback",
-            "extended + try to return to recovered code")),
-    cl::initializer<fallback::Mode>(fallback::NONE));
-
-cl::list<unsigned> breakAt(
-    "break-at",
-    cl::desc("Basic block addresses to insert debugging breakpoints at"),
-    cl::value_desc("address"));
+    auto threshold() -> Level
+    {
+        return currentThreshold;
+    }
+
+    ThresholdScope::ThresholdScope(Level level) : previous{currentThreshold}
+    {
+        currentThreshold = level;
+    }
+
+    ThresholdScope::~ThresholdScope()
+    {
+        currentThreshold = previous;
+    }
+} // namespace logging
 
 auto checkif(bool condition, const std::string &message) -> bool
 {
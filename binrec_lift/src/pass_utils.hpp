@@ -7,6 +7,23 @@
 namespace logging {
     enum Level { ERROR = 0, WARNING, INFO, DEBUG };
     auto getStream(Level level) -> llvm::raw_ostream &;
+
+    /// The most detailed level that is logged on the calling thread, INFO unless a
+    /// ThresholdScope is active.
+    auto threshold() -> Level;
+
+    /// Sets the logging threshold of the calling thread until it is destroyed. Threads that run
+    /// passes for a lift operation take over the threshold of the thread that started them.
+    class ThresholdScope {
+        Level previous;
+
+    public:
+        explicit ThresholdScope(Level level);
+        ~ThresholdScope();
+
+        ThresholdScope(const ThresholdScope &) = delete;
+        auto operator=(const ThresholdScope &) -> ThresholdScope & = delete;
+    };
 } // namespace logging
 
 namespace fallback {
@@ -18,7 +35,7 @@ namespace fallback {
 // evaluated, saving execution time (since stringification is expensive)
 #define LOG(level, message)                                                                        \
     do {                                                                                           \
-        if (logging::level <= logLevel)                                                            \
+        if (logging::level <= logging::threshold())                                                \
             logging::getStream(logging::level) << message;                                         \
     } while (false)
 #define LOG_LINE(level, message) LOG(level, message << '\n')
@@ -27,11 +44,6 @@ namespace fallback {
 #define INFO(message) LOG_LINE(INFO, message)
 #define DBG(message) LOG_LINE(DEBUG, message)
 
-extern llvm::cl::opt<unsigned> debugVerbosity;
-extern llvm::cl::opt<logging::Level> logLevel;
-extern llvm::cl::opt<fallback::Mode> fallbackMode;
-extern llvm::cl::list<unsigned> breakAt;
-
 static inline auto hexToInt(llvm::StringRef hexStr) -> uint32_t
 {
     return std::strtoul(hexStr.data(), nullptr, 16);
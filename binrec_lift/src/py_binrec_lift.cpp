@@ -1,12 +1,12 @@
 #include "binrec_lift.hpp"
 #include "error.hpp"
 #include "lift_context.hpp"
+#include "merging/link_bitcode.hpp"
 #include "pass_utils.hpp"
 #include <llvm/ADT/Triple.h>
 #include <llvm/Analysis/AliasAnalysis.h>
 #include <llvm/IRReader/IRReader.h>
 #include <llvm/Passes/PassBuilder.h>
-#include <llvm/Support/CommandLine.h>
 
 
 extern "C" {
@@ -36,16 +36,6 @@ static PyObject *PyLiftError_str(PyObject *self)
     return ret;
 }
 
-/**
- * Set the LLVM memssa check limit for the current lift operation.
- */
-static void set_memssa_check_limit(int limit)
-{
-    llvm::StringMap<llvm::cl::Option *> &opts = llvm::cl::getRegisteredOptions();
-    auto option = (llvm::cl::opt<unsigned> *)opts["memssa-check-limit"];
-    option->setValue(limit);
-}
-
 static int is_binrec_debug_mode()
 {
     char *debug = getenv("BINREC_DEBUG");
@@ -53,41 +43,69 @@ static int is_binrec_debug_mode()
 }
 
 /**
- * Reset LLVM command line arguments.
+ * Parse the output policy of a lift operation. When no policy is given, debug mode writes
+ * every output and bitcode is written otherwise.
+ *
+ * @returns 0 on success and -1, with a Python exception, on error.
  */
-static void reset_llvm_options()
+static int parse_output_policy(const char *output, binrec::OutputPolicy &policy)
 {
-    llvm::StringMap<llvm::cl::Option *> &opts = llvm::cl::getRegisteredOptions();
-    auto option = (llvm::cl::opt<unsigned> *)opts["memssa-check-limit"];
-    option->setValue(option->getDefault().getValue());
+    if (!output) {
+        policy = is_binrec_debug_mode() ? binrec::OutputPolicy::MEMSSA
+                                        : binrec::OutputPolicy::BITCODE;
+    } else if (!strcmp(output, "bitcode")) {
+        policy = binrec::OutputPolicy::BITCODE;
+    } else if (!strcmp(output, "text")) {
+        policy = binrec::OutputPolicy::TEXT;
+    } else if (!strcmp(output, "memssa")) {
+        policy = binrec::OutputPolicy::MEMSSA;
+    } else {
+        PyErr_Format(PyExc_ValueError, "invalid output policy: %s", output);
+        return -1;
+    }
+    return 0;
+}
 
-    auto log_opt = (llvm::cl::opt<logging::Level> *)opts["loglevel"];
-    log_opt->setValue(is_binrec_debug_mode() ? logging::DEBUG : logging::ERROR);
+/**
+ * The logging level of binrec operations, debug messages in debug mode and only errors
+ * otherwise.
+ */
+static logging::Level binrec_log_level()
+{
+    return is_binrec_debug_mode() ? logging::DEBUG : logging::ERROR;
 }
 
 /**
- * Helper class that properly sets up LLVM prior to a lift opertion and then cleans up
- * when the operation completes.
+ * Helper class that properly sets up the logging and the working directory prior to a binrec
+ * operation and then cleans up when the operation completes.
  */
 class BinrecCallState {
 public:
     const char *working_dir;
-    unsigned memssa_check_limit;
+    logging::ThresholdScope threshold;
     char pwd[PATH_MAX];
     bool good;
 
-    BinrecCallState(const char *working_dir, unsigned memssa_check_limit) :
+    explicit BinrecCallState(const char *working_dir) :
             working_dir(working_dir),
-            memssa_check_limit(memssa_check_limit)
+            threshold(binrec_log_level())
     {
-        reset_llvm_options();
-        if (memssa_check_limit) {
-            set_memssa_check_limit(memssa_check_limit);
-        }
-
         good = set_working_dir() == 0;
     }
 
+    /**
+     * Set up a lift operation, which logs and limits MemorySSA through its context.
+     */
+    BinrecCallState(
+        const char *working_dir,
+        binrec::LiftContext &ctx,
+        unsigned memssa_check_limit) :
+            BinrecCallState(working_dir)
+    {
+        ctx.log_level = binrec_log_level();
+        ctx.memssa_check_limit = memssa_check_limit;
+    }
+
     ~BinrecCallState()
     {
         reset_working_dir();
@@ -145,47 +163,63 @@ static int run_lift_operation(binrec::LiftContext &ctx)
 PyDoc_STRVAR(
     link_prep_1__doc__,
     "link_prep_1(trace_filename: str, destination: str, working_dir: str = None, "
-    "memssa_check_link: int = None) -> None\n\n"
+    "memssa_check_link: int = None, output: str = None, profile: bool = False) -> None\n\n"
     "Perform a first-pass bitcode preparation for linking on the trace filename.\n\n"
     ":param trace_filename: the bitcode captured trace to prepare\n"
     ":param destination: the output bitcode file\n"
     ":param working_dir: the working directory, which is typically the capture trace "
     "directory\n"
     ":param memssa_check_limit: the maximum number of stores/phis MemorySSA will consider "
-    "trying to walk past (default = 100)\n");
+    "trying to walk past (default = 100)\n"
+    ":param output: the outputs to write, ``bitcode``, ``text`` to also write LLVM IR, or "
+    "``memssa`` to also write LLVM IR run through MemorySSA analysis (default = ``memssa`` "
+    "in debug mode, ``bitcode`` otherwise)\n"
+    ":param profile: write the wall time, CPU time, peak memory growth, and IR size of "
+    "every pass to ``{destination}-passes.json``\n");
 static PyObject *link_prep_1(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    static const char *kwlist[] =
-        {"trace_filename", "destination", "working_dir", "memssa_check_limit", NULL};
+    static const char *kwlist[] = {
+        "trace_filename",
+        "destination",
+        "working_dir",
+        "memssa_check_limit",
+        "output",
+        "profile",
+        NULL};
 
     const char *trace_filename = NULL;
     const char *destination = NULL;
     const char *working_dir = NULL;
     unsigned int memssa_check_limit = 0;
+    const char *output = NULL;
+    int profile = 0;
     binrec::LiftContext ctx;
 
     if (!PyArg_ParseTupleAndKeywords(
             args,
             kwargs,
-            "ss|sI",
+            "ss|sIzp",
             const_cast<char **>(kwlist),
             &trace_filename,
             &destination,
             &working_dir,
-            &memssa_check_limit))
+            &memssa_check_limit,
+            &output,
+            &profile))
     {
         return NULL;
     }
 
     llvm::LLVMContext llvm_context;
-    BinrecCallState state{working_dir, memssa_check_limit};
+    BinrecCallState state{working_dir, ctx, memssa_check_limit};
 
-    if (!state.good) {
+    if (!state.good || parse_output_policy(output, ctx.output)) {
         return NULL;
     }
 
     ctx.trace_filename = trace_filename;
     ctx.destination = destination;
+    ctx.profile = (bool)profile;
     ctx.link_prep_1 = true;
 
     int status = run_lift_operation(ctx);
@@ -199,45 +233,61 @@ static PyObject *link_prep_1(PyObject *self, PyObject *args, PyObject *kwargs)
 PyDoc_STRVAR(
     link_prep_2__doc__,
     "link_prep_2(trace_filename: str, destination: str, working_dir: str = None, "
-    "memssa_check_link: int = None) -> None\n\n"
+    "memssa_check_link: int = None, output: str = None, profile: bool = False) -> None\n\n"
     "Perform a second-pass bitcode preparation for linking on the trace filename.\n\n"
     ":param trace_filename: the bitcode captured trace to prepare\n"
     ":param destination: the output bitcode file\n"
     ":param working_dir: the working directory, which is typically the capture trace "
     "directory\n"
     ":param memssa_check_limit: the maximum number of stores/phis MemorySSA will consider "
-    "trying to walk past (default = 100)\n");
+    "trying to walk past (default = 100)\n"
+    ":param output: the outputs to write, ``bitcode``, ``text`` to also write LLVM IR, or "
+    "``memssa`` to also write LLVM IR run through MemorySSA analysis (default = ``memssa`` "
+    "in debug mode, ``bitcode`` otherwise)\n"
+    ":param profile: write the wall time, CPU time, peak memory growth, and IR size of "
+    "every pass to ``{destination}-passes.json``\n");
 static PyObject *link_prep_2(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    static const char *kwlist[] =
-        {"trace_filename", "destination", "working_dir", "memssa_check_limit", NULL};
+    static const char *kwlist[] = {
+        "trace_filename",
+        "destination",
+        "working_dir",
+        "memssa_check_limit",
+        "output",
+        "profile",
+        NULL};
 
     const char *trace_filename = NULL;
     const char *destination = NULL;
     const char *working_dir = NULL;
     unsigned int memssa_check_limit = 0;
+    const char *output = NULL;
+    int profile = 0;
     binrec::LiftContext ctx;
 
     if (!PyArg_ParseTupleAndKeywords(
             args,
             kwargs,
-            "ss|sI",
+            "ss|sIzp",
             const_cast<char **>(kwlist),
             &trace_filename,
             &destination,
             &working_dir,
-            &memssa_check_limit))
+            &memssa_check_limit,
+            &output,
+            &profile))
     {
         return NULL;
     }
 
-    BinrecCallState state{working_dir, memssa_check_limit};
-    if (!state.good) {
+    BinrecCallState state{working_dir, ctx, memssa_check_limit};
+    if (!state.good || parse_output_policy(output, ctx.output)) {
         return NULL;
     }
 
     ctx.trace_filename = trace_filename;
     ctx.destination = destination;
+    ctx.profile = (bool)profile;
     ctx.link_prep_2 = true;
 
     int status = run_lift_operation(ctx);
@@ -251,8 +301,9 @@ static PyObject *link_prep_2(PyObject *self, PyObject *args, PyObject *kwargs)
 PyDoc_STRVAR(
     clean__doc__,
     "clean(trace_filename: str, destination: str, working_dir: str = None, "
-    "memssa_check_link: int = None) -> None\n\n"
-    "Clean the bitcode trace. This method produces three output files:\n"
+    "memssa_check_link: int = None, output: str = None, profile: bool = False) -> None\n\n"
+    "Clean the bitcode trace. This method produces up to three output files, depending on "
+    "``output``:\n"
     "  - ``{destination}.bc`` - cleaned bitcode\n"
     "  - ``{destination}.ll`` - cleaned LLVM IR\n"
     "  - ``{destination}-memssa.ll`` - cleaned LLVM IR run through MemorySSA analysis\n\n"
@@ -261,38 +312,54 @@ PyDoc_STRVAR(
     ":param str working_dir: the working directory, which is typically the capture trace "
     "directory\n"
     ":param str memssa_check_limit: the maximum number of stores/phis MemorySSA will consider "
-    "trying to walk past (default = 100)\n");
+    "trying to walk past (default = 100)\n"
+    ":param output: the outputs to write, ``bitcode``, ``text`` to also write LLVM IR, or "
+    "``memssa`` to also write LLVM IR run through MemorySSA analysis (default = ``memssa`` "
+    "in debug mode, ``bitcode`` otherwise)\n"
+    ":param profile: write the wall time, CPU time, peak memory growth, and IR size of "
+    "every pass to ``{destination}-passes.json``\n");
 static PyObject *clean(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    static const char *kwlist[] =
-        {"trace_filename", "destination", "working_dir", "memssa_check_limit", NULL};
+    static const char *kwlist[] = {
+        "trace_filename",
+        "destination",
+        "working_dir",
+        "memssa_check_limit",
+        "output",
+        "profile",
+        NULL};
 
     const char *trace_filename = NULL;
     const char *destination = NULL;
     const char *working_dir = NULL;
     unsigned int memssa_check_limit = 0;
+    const char *output = NULL;
+    int profile = 0;
     binrec::LiftContext ctx;
 
     if (!PyArg_ParseTupleAndKeywords(
             args,
             kwargs,
-            "ss|sI",
+            "ss|sIzp",
             const_cast<char **>(kwlist),
             &trace_filename,
             &destination,
             &working_dir,
-            &memssa_check_limit))
+            &memssa_check_limit,
+            &output,
+            &profile))
     {
         return NULL;
     }
 
-    BinrecCallState state{working_dir, memssa_check_limit};
-    if (!state.good) {
+    BinrecCallState state{working_dir, ctx, memssa_check_limit};
+    if (!state.good || parse_output_policy(output, ctx.output)) {
         return NULL;
     }
 
     ctx.trace_filename = trace_filename;
     ctx.destination = destination;
+    ctx.profile = (bool)profile;
     ctx.clean = true;
 
     int status = run_lift_operation(ctx);
@@ -307,8 +374,9 @@ PyDoc_STRVAR(
     lift__doc__,
     "lift(trace_filename: str, destination: str, working_dir: str = None, "
     "clean_names: bool = False, skip_link: bool = False, trace_calls: bool = False, "
-    "memssa_check_link: int = None) -> None\n\n"
-    "Lift bitcode to an LLVM module. This function outputs multiple files:\n"
+    "memssa_check_link: int = None, output: str = None, profile: bool = False) -> None\n\n"
+    "Lift bitcode to an LLVM module. This function outputs multiple files, depending on "
+    "``output``:\n"
     " - ``{destination}.bc`` - lifted bitcode\n"
     " - ``{destination}.ll`` - lifted LLVM IR\n"
     " - ``{destination}-memssa.ll`` - lifted LLVM IR run through MemorySSA analysis\n"
@@ -321,7 +389,12 @@ PyDoc_STRVAR(
     ":param skip_link: do not lift dynamic symbols\n"
     ":param trace_calls: trace calls and register values of recovered functions\n"
     ":param memssa_check_limit: the maximum number of stores/phis MemorySSA will consider "
-    "trying to walk past (default = 100)\n");
+    "trying to walk past (default = 100)\n"
+    ":param output: the outputs to write, ``bitcode``, ``text`` to also write LLVM IR, or "
+    "``memssa`` to also write LLVM IR run through MemorySSA analysis (default = ``memssa`` "
+    "in debug mode, ``bitcode`` otherwise)\n"
+    ":param profile: write the wall time, CPU time, peak memory growth, and IR size of "
+    "every pass to ``{destination}-passes.json``\n");
 static PyObject *lift(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     static const char *kwlist[] = {
@@ -332,12 +405,16 @@ static PyObject *lift(PyObject *self, PyObject *args, PyObject *kwargs)
         "skip_link",
         "trace_calls",
         "memssa_check_limit",
+        "output",
+        "profile",
         NULL};
 
     const char *trace_filename = NULL;
     const char *destination = NULL;
     const char *working_dir = NULL;
     unsigned int memssa_check_limit = 0;
+    const char *output = NULL;
+    int profile = 0;
     int skip_link = 0;
     int clean_names = 0;
     int trace_calls = 0;
@@ -346,7 +423,7 @@ static PyObject *lift(PyObject *self, PyObject *args, PyObject *kwargs)
     if (!PyArg_ParseTupleAndKeywords(
             args,
             kwargs,
-            "ss|sIppp",
+            "ss|sIpppzp",
             const_cast<char **>(kwlist),
             &trace_filename,
             &destination,
@@ -354,18 +431,21 @@ static PyObject *lift(PyObject *self, PyObject *args, PyObject *kwargs)
             &memssa_check_limit,
             &clean_names,
             &skip_link,
-            &trace_calls))
+            &trace_calls,
+            &output,
+            &profile))
     {
         return NULL;
     }
 
-    BinrecCallState state{working_dir, memssa_check_limit};
-    if (!state.good) {
+    BinrecCallState state{working_dir, ctx, memssa_check_limit};
+    if (!state.good || parse_output_policy(output, ctx.output)) {
         return NULL;
     }
 
     ctx.trace_filename = trace_filename;
     ctx.destination = destination;
+    ctx.profile = (bool)profile;
     ctx.lift = true;
     ctx.clean_names = (bool)clean_names;
     ctx.skip_link = (bool)skip_link;
@@ -382,8 +462,8 @@ static PyObject *lift(PyObject *self, PyObject *args, PyObject *kwargs)
 PyDoc_STRVAR(
     optimize__doc__,
     "optimize(trace_filename: str, destination: str, working_dir: str = None, "
-    "memssa_check_link: int = None) -> None\n\n"
-    "Optimize lifted bitcode. These function outputs multiple files:\n"
+    "memssa_check_link: int = None, output: str = None, profile: bool = False) -> None\n\n"
+    "Optimize lifted bitcode. These function outputs multiple files, depending on ``output``:\n"
     " - ``{destination}.bc`` - optimized bitcode\n"
     " - ``{destination}.ll`` - optimized LLVM IR\n"
     " - ``{destination}-memssa.ll`` - optimized LLVM IR run through MemorySSA analysis\n\n"
@@ -392,38 +472,54 @@ PyDoc_STRVAR(
     ":param working_dir: the working directory, which is typically the capture trace "
     "directory\n"
     ":param memssa_check_limit: the maximum number of stores/phis MemorySSA will consider "
-    "trying to walk past (default = 100)\n");
+    "trying to walk past (default = 100)\n"
+    ":param output: the outputs to write, ``bitcode``, ``text`` to also write LLVM IR, or "
+    "``memssa`` to also write LLVM IR run through MemorySSA analysis (default = ``memssa`` "
+    "in debug mode, ``bitcode`` otherwise)\n"
+    ":param profile: write the wall time, CPU time, peak memory growth, and IR size of "
+    "every pass to ``{destination}-passes.json``\n");
 static PyObject *optimize(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    static const char *kwlist[] =
-        {"trace_filename", "destination", "working_dir", "memssa_check_limit", NULL};
+    static const char *kwlist[] = {
+        "trace_filename",
+        "destination",
+        "working_dir",
+        "memssa_check_limit",
+        "output",
+        "profile",
+        NULL};
 
     const char *trace_filename = NULL;
     const char *destination = NULL;
     const char *working_dir = NULL;
     unsigned int memssa_check_limit = 0;
+    const char *output = NULL;
+    int profile = 0;
     binrec::LiftContext ctx;
 
     if (!PyArg_ParseTupleAndKeywords(
             args,
             kwargs,
-            "ss|sI",
+            "ss|sIzp",
             const_cast<char **>(kwlist),
             &trace_filename,
             &destination,
             &working_dir,
-            &memssa_check_limit))
+            &memssa_check_limit,
+            &output,
+            &profile))
     {
         return NULL;
     }
 
-    BinrecCallState state{working_dir, memssa_check_limit};
-    if (!state.good) {
+    BinrecCallState state{working_dir, ctx, memssa_check_limit};
+    if (!state.good || parse_output_policy(output, ctx.output)) {
         return NULL;
     }
 
     ctx.trace_filename = trace_filename;
     ctx.destination = destination;
+    ctx.profile = (bool)profile;
     ctx.optimize = true;
 
     int status = run_lift_operation(ctx);
@@ -437,9 +533,9 @@ static PyObject *optimize(PyObject *self, PyObject *args, PyObject *kwargs)
 PyDoc_STRVAR(
     optimize_better__doc__,
     "optimize_better(trace_filename: str, destination: str, working_dir: str = None, "
-    "memssa_check_link: int = None) -> None\n\n"
+    "memssa_check_link: int = None, output: str = None, profile: bool = False) -> None\n\n"
     "Optimize lifted bitcode (better than :func:`optimize`). These function outputs "
-    "multiple files:\n"
+    "multiple files, depending on ``output``:\n"
     " - ``{destination}.bc`` - optimized bitcode\n"
     " - ``{destination}.ll`` - optimized LLVM IR\n"
     " - ``{destination}-memssa.ll`` - optimized LLVM IR run through MemorySSA analysis\n\n"
@@ -448,38 +544,54 @@ PyDoc_STRVAR(
     ":param working_dir: the working directory, which is typically the capture trace "
     "directory\n"
     ":param memssa_check_limit: the maximum number of stores/phis MemorySSA will consider "
-    "trying to walk past (default = 100)\n");
+    "trying to walk past (default = 100)\n"
+    ":param output: the outputs to write, ``bitcode``, ``text`` to also write LLVM IR, or "
+    "``memssa`` to also write LLVM IR run through MemorySSA analysis (default = ``memssa`` "
+    "in debug mode, ``bitcode`` otherwise)\n"
+    ":param profile: write the wall time, CPU time, peak memory growth, and IR size of "
+    "every pass to ``{destination}-passes.json``\n");
 static PyObject *optimize_better(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    static const char *kwlist[] =
-        {"trace_filename", "destination", "working_dir", "memssa_check_limit", NULL};
+    static const char *kwlist[] = {
+        "trace_filename",
+        "destination",
+        "working_dir",
+        "memssa_check_limit",
+        "output",
+        "profile",
+        NULL};
 
     const char *trace_filename = NULL;
     const char *destination = NULL;
     const char *working_dir = NULL;
     unsigned int memssa_check_limit = 0;
+    const char *output = NULL;
+    int profile = 0;
     binrec::LiftContext ctx;
 
     if (!PyArg_ParseTupleAndKeywords(
             args,
             kwargs,
-            "ss|sI",
+            "ss|sIzp",
             const_cast<char **>(kwlist),
             &trace_filename,
             &destination,
             &working_dir,
-            &memssa_check_limit))
+            &memssa_check_limit,
+            &output,
+            &profile))
     {
         return NULL;
     }
 
-    BinrecCallState state{working_dir, memssa_check_limit};
-    if (!state.good) {
+    BinrecCallState state{working_dir, ctx, memssa_check_limit};
+    if (!state.good || parse_output_policy(output, ctx.output)) {
         return NULL;
     }
 
     ctx.trace_filename = trace_filename;
     ctx.destination = destination;
+    ctx.profile = (bool)profile;
     ctx.optimize_better = true;
 
     int status = run_lift_operation(ctx);
@@ -493,9 +605,9 @@ static PyObject *optimize_better(PyObject *self, PyObject *args, PyObject *kwarg
 PyDoc_STRVAR(
     compile_prep__doc__,
     "compile_prep(trace_filename: str, destination: str, working_dir: str = None, "
-    "memssa_check_link: int = None) -> None\n\n"
+    "memssa_check_link: int = None, output: str = None, profile: bool = False) -> None\n\n"
     "Prepare a trace for compilation to an object file. This function outputs "
-    "multiple files:\n"
+    "multiple files, depending on ``output``:\n"
     " - ``{destination}.bc`` - prepped bitcode\n"
     " - ``{destination}.ll`` - prepped LLVM IR\n"
     " - ``{destination}-memssa.ll`` - prepped LLVM IR run through MemorySSA analysis\n\n"
@@ -504,38 +616,54 @@ PyDoc_STRVAR(
     ":param working_dir: the working directory, which is typically the capture trace "
     "directory\n"
     ":param memssa_check_limit: the maximum number of stores/phis MemorySSA will consider "
-    "trying to walk past (default = 100)\n");
+    "trying to walk past (default = 100)\n"
+    ":param output: the outputs to write, ``bitcode``, ``text`` to also write LLVM IR, or "
+    "``memssa`` to also write LLVM IR run through MemorySSA analysis (default = ``memssa`` "
+    "in debug mode, ``bitcode`` otherwise)\n"
+    ":param profile: write the wall time, CPU time, peak memory growth, and IR size of "
+    "every pass to ``{destination}-passes.json``\n");
 static PyObject *compile_prep(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    static const char *kwlist[] =
-        {"trace_filename", "destination", "working_dir", "memssa_check_limit", NULL};
+    static const char *kwlist[] = {
+        "trace_filename",
+        "destination",
+        "working_dir",
+        "memssa_check_limit",
+        "output",
+        "profile",
+        NULL};
 
     const char *trace_filename = NULL;
     const char *destination = NULL;
     const char *working_dir = NULL;
     unsigned int memssa_check_limit = 0;
+    const char *output = NULL;
+    int profile = 0;
     binrec::LiftContext ctx;
 
     if (!PyArg_ParseTupleAndKeywords(
             args,
             kwargs,
-            "ss|sI",
+            "ss|sIzp",
             const_cast<char **>(kwlist),
             &trace_filename,
             &destination,
             &working_dir,
-            &memssa_check_limit))
+            &memssa_check_limit,
+            &output,
+            &profile))
     {
         return NULL;
     }
 
-    BinrecCallState state{working_dir, memssa_check_limit};
-    if (!state.good) {
+    BinrecCallState state{working_dir, ctx, memssa_check_limit};
+    if (!state.good || parse_output_policy(output, ctx.output)) {
         return NULL;
     }
 
     ctx.trace_filename = trace_filename;
     ctx.destination = destination;
+    ctx.profile = (bool)profile;
     ctx.compile = true;
 
     int status = run_lift_operation(ctx);
@@ -547,6 +675,196 @@ static PyObject *compile_prep(PyObject *self, PyObject *args, PyObject *kwargs)
 }
 
 
+PyDoc_STRVAR(
+    full_pipeline__doc__,
+    "full_pipeline(trace_filename: str, destination: str, custom_helpers: str, "
+    "working_dir: str = None, optimize_better: bool = False, clean_names: bool = False, "
+    "skip_link: bool = False, trace_calls: bool = False, memssa_check_limit: int = None, "
+    "output: str = None, split_module: bool = False, jobs: int = 0, profile: bool = False) "
+    "-> None\n\n"
+    "Recover an object file from captured bitcode. This parses the capture once and "
+    "performs :func:`clean`, links the custom helpers, and performs :func:`lift`, "
+    ":func:`optimize` (or :func:`optimize_better`), and :func:`compile_prep` on the same "
+    "module before compiling it to ``{destination}.o``. The intermediate bitcode and LLVM IR "
+    "of each stage are written only when ``output`` is ``text`` or ``memssa``, using the "
+    "file names of the individual operations, ``cleaned``, ``linked``, ``lifted``, "
+    "``optimized``, and ``recovered``.\n\n"
+    ":param trace_filename: the bitcode captured trace to recover\n"
+    ":param destination: the output object file basename\n"
+    ":param custom_helpers: the custom helpers bitcode to link with the cleaned trace\n"
+    ":param working_dir: the working directory, which is typically the capture trace "
+    "directory\n"
+    ":param optimize_better: optimize with :func:`optimize_better`\n"
+    ":param clean_names: clean symbol names\n"
+    ":param skip_link: do not lift dynamic symbols\n"
+    ":param trace_calls: trace calls and register values of recovered functions\n"
+    ":param memssa_check_limit: the maximum number of stores/phis MemorySSA will consider "
+    "trying to walk past (default = 100)\n"
+    ":param output: the intermediate outputs to write, ``bitcode`` to write none, ``text`` "
+    "to write bitcode and LLVM IR, or ``memssa`` to also write LLVM IR run through "
+    "MemorySSA analysis (default = ``memssa`` in debug mode, ``bitcode`` otherwise)\n"
+    ":param split_module: optimize and compile shards of the module in parallel, calls "
+    "between shards are not inlined\n"
+    ":param jobs: the number of threads to use (default = all cores)\n"
+    ":param profile: write the wall time, CPU time, peak memory growth, and IR size of "
+    "every pass to ``{destination}-passes.json``\n");
+static PyObject *full_pipeline(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *kwlist[] = {
+        "trace_filename",
+        "destination",
+        "custom_helpers",
+        "working_dir",
+        "optimize_better",
+        "clean_names",
+        "skip_link",
+        "trace_calls",
+        "memssa_check_limit",
+        "output",
+        "split_module",
+        "jobs",
+        "profile",
+        NULL};
+
+    const char *trace_filename = NULL;
+    const char *destination = NULL;
+    const char *custom_helpers = NULL;
+    const char *working_dir = NULL;
+    int optimize_better = 0;
+    int clean_names = 0;
+    int skip_link = 0;
+    int trace_calls = 0;
+    unsigned int memssa_check_limit = 0;
+    const char *output = NULL;
+    int profile = 0;
+    int split_module = 0;
+    unsigned int jobs = 0;
+    binrec::LiftContext ctx;
+
+    if (!PyArg_ParseTupleAndKeywords(
+            args,
+            kwargs,
+            "sss|zppppIzpIp",
+            const_cast<char **>(kwlist),
+            &trace_filename,
+            &destination,
+            &custom_helpers,
+            &working_dir,
+            &optimize_better,
+            &clean_names,
+            &skip_link,
+            &trace_calls,
+            &memssa_check_limit,
+            &output,
+            &split_module,
+            &jobs,
+            &profile))
+    {
+        return NULL;
+    }
+
+    BinrecCallState state{working_dir, ctx, memssa_check_limit};
+    if (!state.good || parse_output_policy(output, ctx.output)) {
+        return NULL;
+    }
+
+    ctx.trace_filename = trace_filename;
+    ctx.destination = destination;
+    ctx.profile = (bool)profile;
+    ctx.custom_helpers_filename = custom_helpers;
+    ctx.optimize_better = (bool)optimize_better;
+    ctx.clean_names = (bool)clean_names;
+    ctx.skip_link = (bool)skip_link;
+    ctx.trace_calls = (bool)trace_calls;
+    ctx.split_module = (bool)split_module;
+    ctx.jobs = jobs;
+
+    int status = 0;
+    try {
+        binrec::run_full_pipeline(ctx);
+    } catch (binrec::lifting_error &err) {
+        PyErr_SetObject(PyLiftError, Py_BuildValue("(ss)", err.pass(), err.what()));
+        status = -1;
+    } catch (std::runtime_error &err) {
+        PyErr_SetString(PyExc_RuntimeError, err.what());
+        status = -1;
+    }
+    if (status) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    merge_captures__doc__,
+    "merge_captures(captures: List[str], destination: str, jobs: int = 0) -> None\n\n"
+    "Prepare captured bitcode for linkage and link it into a single bitcode file. This "
+    "performs :func:`link_prep_1` and :func:`link_prep_2` on every capture in memory and "
+    "links the prepared modules without writing intermediate files. Definitions from "
+    "earlier captures take precedence over definitions from later captures. The trace info "
+    "of each capture is read from the capture's directory.\n\n"
+    ":param captures: the captured bitcode files, in order of precedence\n"
+    ":param destination: the output bitcode file\n"
+    ":param jobs: the number of threads to use (default = all cores)\n");
+static PyObject *merge_captures(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *kwlist[] = {"captures", "destination", "jobs", NULL};
+
+    PyObject *captures_list = NULL;
+    const char *destination = NULL;
+    unsigned int jobs = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(
+            args,
+            kwargs,
+            "Os|I",
+            const_cast<char **>(kwlist),
+            &captures_list,
+            &destination,
+            &jobs))
+    {
+        return NULL;
+    }
+
+    // New reference
+    PyObject *sequence = PySequence_Fast(captures_list, "captures must be a sequence");
+    if (!sequence) {
+        return NULL;
+    }
+
+    std::vector<std::string> captures;
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(sequence);
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        const char *capture = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(sequence, i));
+        if (!capture) {
+            Py_DECREF(sequence);
+            return NULL;
+        }
+        captures.emplace_back(capture);
+    }
+    Py_DECREF(sequence);
+
+    BinrecCallState state{NULL};
+    if (!state.good) {
+        return NULL;
+    }
+
+    int status = 0;
+    try {
+        binrec::merge_captures(captures, destination, jobs);
+    } catch (std::runtime_error &err) {
+        PyErr_SetString(PyExc_RuntimeError, err.what());
+        status = -1;
+    }
+    if (status) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+
 static PyMethodDef LiftMethods[] = {
     {"link_prep_1", (PyCFunction)link_prep_1, METH_VARARGS | METH_KEYWORDS, link_prep_1__doc__},
     {"link_prep_2", (PyCFunction)link_prep_2, METH_VARARGS | METH_KEYWORDS, link_prep_2__doc__},
@@ -558,6 +876,14 @@ static PyMethodDef LiftMethods[] = {
      METH_VARARGS | METH_KEYWORDS,
      optimize_better__doc__},
     {"compile_prep", (PyCFunction)compile_prep, METH_VARARGS | METH_KEYWORDS, compile_prep__doc__},
+    {"full_pipeline",
+     (PyCFunction)full_pipeline,
+     METH_VARARGS | METH_KEYWORDS,
+     full_pipeline__doc__},
+    {"merge_captures",
+     (PyCFunction)merge_captures,
+     METH_VARARGS | METH_KEYWORDS,
+     merge_captures__doc__},
     {NULL, NULL, 0, NULL}};
 
 static struct PyModuleDef lift_module = {
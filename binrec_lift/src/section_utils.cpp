@@ -2,7 +2,6 @@
 #include "section_utils.hpp"
 #include "error.hpp"
 #include "pass_utils.hpp"
-#include <fstream>
 
 #define WRAPPER_SECTION ".wrapper"
 
@@ -11,7 +10,7 @@
 
 using namespace llvm;
 
-auto getSourcePath(Module &m) -> StringRef
+auto getSourcePath(Module &m) -> std::string
 {
     return s2eOutFile("binary");
 }
@@ -115,16 +114,6 @@ auto mapToSections(Module &m, section_map_fn_t fn, void *param) -> bool
     return false;
 }
 
-auto readFromBinary(Module &m, void *buf, unsigned offset, unsigned size) -> bool
-{
-    std::ifstream infile(getSourcePath(m).data(), std::ifstream::binary);
-    infile.seekg(offset, infile.beg);
-    infile.read((char *)buf, size);
-    bool success = (bool)infile;
-    infile.close();
-    return success;
-}
-
 auto findSectionByName(Module &m, const std::string name, section_meta_t &s) -> bool
 {
     NamedMDNode *secs = m.getOrInsertNamedMetadata(SECTIONS_METADATA);
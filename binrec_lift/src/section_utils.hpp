@@ -2,6 +2,7 @@
 #define BINREC_SECTION_UTILS_HPP
 
 #include <cstddef>
+#include <string>
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/Module.h>
 
@@ -27,7 +28,7 @@ struct section_meta_t {
  */
 using section_map_fn_t = bool (*)(section_meta_t &, void *);
 
-auto getSourcePath(Module &m) -> StringRef;
+auto getSourcePath(Module &m) -> std::string;
 
 void writeSectionConfig(StringRef name, size_t loadBase);
 
@@ -44,8 +45,6 @@ void writeSectionMeta(Module &m, section_meta_t &s);
  */
 auto mapToSections(Module &m, section_map_fn_t fn, void *param) -> bool;
 
-auto readFromBinary(Module &m, void *buf, unsigned offset, unsigned size) -> bool;
-
 auto findSectionByName(Module &m, const std::string name, section_meta_t &s) -> bool;
 
 #endif
@@ -14,28 +14,62 @@ using namespace binrec;
 using namespace llvm;
 using namespace std;
 
+// Group (key, value) pairs into a map from each key to the set of its values
+static auto group_pcs(vector<pair<uint32_t, uint32_t>> pairs) -> PcSetMap
+{
+    std::sort(pairs.begin(), pairs.end());
+
+    PcSetMap result;
+    for (auto [key, value] : pairs) {
+        result.emplace_hint(result.end(), key)->second.insert(value);
+    }
+    return result;
+}
+
+static auto get_pcs(const PcSetMap &map, uint32_t pc) -> const FlatSet<uint32_t> &
+{
+    static const FlatSet<uint32_t> empty;
+    auto it = map.find(pc);
+    return it == map.end() ? empty : it->second;
+}
+
 FunctionInfo::FunctionInfo(const TraceInfo &ti)
 {
     const FunctionLog &log = ti.functionLog;
     copy(log.entries.begin(), log.entries.end(), back_inserter(entry_pc));
-    for (auto caller : log.entryToCaller) {
-        entry_pc_to_caller_pcs[caller.first].insert(caller.second);
-    }
+
+    entry_pc_to_caller_pcs =
+        group_pcs({log.entryToCaller.values().begin(), log.entryToCaller.values().end()});
     for (auto return_pc : log.entryToReturn) {
         entry_pc_to_return_pcs[return_pc.first].insert(return_pc.second);
     }
     for (auto follow_up : log.callerToFollowUp) {
         caller_pc_to_follow_up_pc.insert(follow_up);
     }
+
+    vector<pair<uint32_t, uint32_t>> entry_to_bb;
+    vector<pair<uint32_t, uint32_t>> bb_to_entry;
     for (auto &function : log.entryToTbs) {
         for (auto tb : function.second) {
-            entry_pc_to_bb_pcs[function.first].insert(tb);
-            bb_pc_to_entry_pcs[tb].insert(function.first);
+            entry_to_bb.emplace_back(function.first, tb);
+            bb_to_entry.emplace_back(tb, function.first);
         }
     }
+    entry_pc_to_bb_pcs = group_pcs(move(entry_to_bb));
+    bb_pc_to_entry_pcs = group_pcs(move(bb_to_entry));
+}
+
+auto FunctionInfo::get_caller_pcs(uint32_t entry_pc) const -> const FlatSet<uint32_t> &
+{
+    return get_pcs(entry_pc_to_caller_pcs, entry_pc);
 }
 
-auto FunctionInfo::get_tbs_by_function_entry(Module &m) const
+auto FunctionInfo::get_entry_pcs(uint32_t bb_pc) const -> const FlatSet<uint32_t> &
+{
+    return get_pcs(bb_pc_to_entry_pcs, bb_pc);
+}
+
+auto FunctionInfo::get_tbs_by_function_entry(const BlockRegistry &blocks) const
     -> unordered_map<Function *, DenseSet<Function *>>
 {
     unordered_map<Function *, DenseSet<Function *>> result;
@@ -43,10 +77,10 @@ auto FunctionInfo::get_tbs_by_function_entry(Module &m) const
     if (entry_pc_to_bb_pcs.empty()) {
         // TODO (hbrodin): This uses the old method of location "main". See recover_functions.cpp
         // for an updated variant. It seems this part is not reached. Haven't investigated.
-        auto *entry = m.getFunction("Func_" + utohexstr(entry_pc[1]));
+        auto *entry = blocks.function(entry_pc[1]);
         PASS_ASSERT(entry);
         DenseSet<Function *> tbs;
-        for (Function &f : m) {
+        for (Function &f : *entry->getParent()) {
             if (f.getName().startswith("Func_") && f.getName() != "Func_wrapper") {
                 tbs.insert(&f);
             }
@@ -54,13 +88,13 @@ auto FunctionInfo::get_tbs_by_function_entry(Module &m) const
         result.emplace(entry, move(tbs));
     } else {
         for (auto &entry_to_tb_pcs : entry_pc_to_bb_pcs) {
-            auto *entry = m.getFunction("Func_" + utohexstr(entry_to_tb_pcs.first));
+            auto *entry = blocks.function(entry_to_tb_pcs.first);
             if (entry == nullptr) {
                 continue;
             }
             DenseSet<Function *> tbs;
             for (uint32_t pc : entry_to_tb_pcs.second) {
-                Function *f = m.getFunction("Func_" + utohexstr(pc));
+                Function *f = blocks.function(pc);
                 if (f != nullptr) {
                     tbs.insert(f);
                 }
@@ -72,31 +106,23 @@ auto FunctionInfo::get_tbs_by_function_entry(Module &m) const
     return result;
 }
 
-auto FunctionInfo::get_ret_bbs_by_merged_function(const Module &m) const
+auto FunctionInfo::get_ret_bbs_by_merged_function(const BlockRegistry &blocks) const
     -> map<Function *, set<BasicBlock *>>
 {
     map<Function *, set<BasicBlock *>> result;
 
     for (auto &entry_to_returns : entry_pc_to_return_pcs) {
-        string merged_f_name = string("Func_") + utohexstr(entry_to_returns.first);
-        Function *merged_f = m.getFunction(merged_f_name);
+        Function *merged_f = blocks.function(entry_to_returns.first);
         if (merged_f == nullptr) {
             continue;
         }
 
-        map<string, BasicBlock *> bb_by_name;
-        for (BasicBlock &bb : *merged_f) {
-            bb_by_name.emplace(bb.getName(), &bb);
-        }
-
         set<BasicBlock *> return_blocks;
         transform(
             entry_to_returns.second.begin(),
             entry_to_returns.second.end(),
             inserter(return_blocks, return_blocks.begin()),
-            [&bb_by_name](uint32_t block_pc) {
-                return bb_by_name.find(string("BB_") + utohexstr(block_pc))->second;
-            });
+            [&blocks, merged_f](uint32_t block_pc) { return blocks.block(*merged_f, block_pc); });
 
         result.emplace(merged_f, return_blocks);
     }
@@ -104,18 +130,15 @@ auto FunctionInfo::get_ret_bbs_by_merged_function(const Module &m) const
     return result;
 }
 
-auto FunctionInfo::get_entrypoint_functions(const Module &m) const -> vector<Function *>
+auto FunctionInfo::get_entrypoint_functions(const BlockRegistry &blocks) const
+    -> vector<Function *>
 {
     vector<Function *> entrypoints;
     transform(
         entry_pc.begin(),
         entry_pc.end(),
         back_inserter(entrypoints),
-        [&m](uint32_t entrypoint_pc) {
-            string entrypoint_name = string("Func_") + utohexstr(entrypoint_pc);
-            Function *entrypoint = m.getFunction(entrypoint_name);
-            return entrypoint;
-        });
+        [&blocks](uint32_t entrypoint_pc) { return blocks.function(entrypoint_pc); });
     return entrypoints;
 }
 
@@ -1,7 +1,10 @@
 #ifndef BINREC_FUNCTION_INFO_HPP
 #define BINREC_FUNCTION_INFO_HPP
 
+#include "analysis/block_registry.hpp"
 #include "analysis/trace_info_analysis.hpp"
+#include "binrec/flat_map.hpp"
+#include "binrec/flat_set.hpp"
 #include <cstdint>
 #include <llvm/IR/Module.h>
 #include <map>
@@ -9,21 +12,28 @@
 #include <vector>
 
 namespace binrec {
+    using PcSetMap = FlatMap<uint32_t, FlatSet<uint32_t>>;
+
     struct FunctionInfo {
         std::vector<uint32_t> entry_pc;
         std::unordered_map<uint32_t, llvm::DenseSet<uint32_t>> entry_pc_to_return_pcs;
-        std::map<uint32_t, std::set<uint32_t>> entry_pc_to_caller_pcs;
+        PcSetMap entry_pc_to_caller_pcs;
         llvm::DenseMap<uint32_t, uint32_t> caller_pc_to_follow_up_pc;
-        std::map<uint32_t, std::set<uint32_t>> entry_pc_to_bb_pcs;
-        std::map<uint32_t, std::set<uint32_t>> bb_pc_to_entry_pcs;
+        PcSetMap entry_pc_to_bb_pcs;
+        PcSetMap bb_pc_to_entry_pcs;
 
         explicit FunctionInfo(const TraceInfo &ti);
 
-        [[nodiscard]] auto get_tbs_by_function_entry(llvm::Module &m) const
+        /// The pcs that called the function with the given entry pc, if any.
+        [[nodiscard]] auto get_caller_pcs(uint32_t entry_pc) const -> const FlatSet<uint32_t> &;
+        /// The entry pcs of all functions that contain the block with the given pc, if any.
+        [[nodiscard]] auto get_entry_pcs(uint32_t bb_pc) const -> const FlatSet<uint32_t> &;
+
+        [[nodiscard]] auto get_tbs_by_function_entry(const BlockRegistry &blocks) const
             -> std::unordered_map<llvm::Function *, llvm::DenseSet<llvm::Function *>>;
-        [[nodiscard]] auto get_ret_bbs_by_merged_function(const llvm::Module &m) const
+        [[nodiscard]] auto get_ret_bbs_by_merged_function(const BlockRegistry &blocks) const
             -> std::map<llvm::Function *, std::set<llvm::BasicBlock *>>;
-        [[nodiscard]] auto get_entrypoint_functions(const llvm::Module &m) const
+        [[nodiscard]] auto get_entrypoint_functions(const BlockRegistry &blocks) const
             -> std::vector<llvm::Function *>;
         [[nodiscard]] auto get_ret_pcs_for_entry_pcs() const
             -> std::unordered_map<uint32_t, llvm::DenseSet<uint32_t>>;
@@ -0,0 +1,391 @@
+#include "sharded_pipeline.hpp"
+#include "analysis/env_alias_analysis.hpp"
+#include "pass_utils.hpp"
+#include <algorithm>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/raw_ostream.h>
+#include <stdexcept>
+
+using namespace binrec;
+using namespace llvm;
+using namespace std;
+
+namespace {
+    /// Shards with fewer functions do not pay for reading and linking the module.
+    constexpr size_t min_functions_per_shard = 32;
+
+    /// A local symbol as it was before it was made external.
+    struct LocalSymbol {
+        string name;
+        GlobalValue::LinkageTypes linkage;
+        bool dso_local;
+        bool named;
+    };
+
+    auto write_bitcode(const Module &m) -> unique_ptr<MemoryBuffer>
+    {
+        SmallVector<char, 0> bitcode;
+        raw_svector_ostream os{bitcode};
+        WriteBitcodeToFile(m, os);
+        return make_unique<SmallVectorMemoryBuffer>(move(bitcode), m.getModuleIdentifier(), false);
+    }
+
+    /// Whether the shards of m can be linked back into m without changing it.
+    auto is_shardable(Module &m) -> bool
+    {
+        // Distinct debug info would be duplicated by the linker, and block addresses are lost
+        // when the bodies of the functions of other shards are deleted.
+        if (m.getNamedMetadata("llvm.dbg.cu") || !m.alias_empty() || !m.ifunc_empty() ||
+            !m.getComdatSymbolTable().empty())
+        {
+            return false;
+        }
+        for (GlobalValue &gv : m.global_values()) {
+            // Symbols are matched up by name.
+            if (!gv.hasName() && !gv.hasLocalLinkage()) {
+                return false;
+            }
+        }
+        for (Function &f : m) {
+            for (BasicBlock &bb : f) {
+                if (bb.hasAddressTaken()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Make all local symbols external, so the shards link against them by name.
+    auto externalize_locals(Module &m) -> vector<LocalSymbol>
+    {
+        vector<LocalSymbol> locals;
+        for (GlobalValue &gv : m.global_values()) {
+            if (!gv.hasLocalLinkage()) {
+                continue;
+            }
+            bool named = gv.hasName();
+            if (!named) {
+                gv.setName("__binrec_shard_local");
+            }
+            locals.push_back({gv.getName().str(), gv.getLinkage(), gv.isDSOLocal(), named});
+            gv.setLinkage(GlobalValue::ExternalLinkage);
+            gv.setVisibility(GlobalValue::HiddenVisibility);
+        }
+        return locals;
+    }
+
+    void restore_locals(Module &m, const vector<LocalSymbol> &locals)
+    {
+        for (const LocalSymbol &local : locals) {
+            GlobalValue *gv = m.getNamedValue(local.name);
+            if (!gv) {
+                continue;
+            }
+            // Local linkage also resets the visibility.
+            gv->setLinkage(local.linkage);
+            gv->setDSOLocal(local.dso_local);
+            if (!local.named) {
+                gv->setName("");
+            }
+        }
+    }
+
+    /// The position of every symbol in its list, by name.
+    template <typename T> auto positions(SymbolTableList<T> &list) -> StringMap<size_t>
+    {
+        StringMap<size_t> order;
+        for (T &symbol : list) {
+            order.try_emplace(symbol.getName(), order.size());
+        }
+        return order;
+    }
+
+    /// Move the symbols of list back to the positions they had before linking, followed by new
+    /// symbols.
+    template <typename T>
+    void restore_positions(SymbolTableList<T> &list, const StringMap<size_t> &order)
+    {
+        auto position = [&order](T *symbol) {
+            auto it = order.find(symbol->getName());
+            return it == order.end() ? order.size() : it->second;
+        };
+        vector<T *> symbols;
+        for (T &symbol : list) {
+            symbols.push_back(&symbol);
+        }
+        stable_sort(symbols.begin(), symbols.end(), [&position](T *lhs, T *rhs) {
+            return position(lhs) < position(rhs);
+        });
+        for (T *symbol : symbols) {
+            list.remove(symbol);
+            list.push_back(symbol);
+        }
+    }
+
+    /// Assign the function definitions of m to shards with about the same number of
+    /// instructions. Callees are clustered with their callers as long as the cluster is not
+    /// larger than an even share of the module, so most calls stay within a shard. The
+    /// assignment only depends on the module.
+    auto partition(Module &m, size_t shards) -> vector<vector<string>>
+    {
+        vector<Function *> functions;
+        DenseMap<const Function *, unsigned> index;
+        vector<unsigned> leader;
+        vector<size_t> sizes;
+        size_t total = 0;
+        for (Function &f : m) {
+            if (!f.isDeclaration()) {
+                index[&f] = functions.size();
+                leader.push_back(functions.size());
+                functions.push_back(&f);
+                sizes.push_back(f.getInstructionCount());
+                total += sizes.back();
+            }
+        }
+
+        auto find = [&leader](unsigned i) {
+            while (leader[i] != i) {
+                leader[i] = leader[leader[i]];
+                i = leader[i];
+            }
+            return i;
+        };
+        size_t budget = max<size_t>(total / shards, 1);
+        for (unsigned i = 0; i < functions.size(); ++i) {
+            for (Instruction &inst : instructions(functions[i])) {
+                auto *call = dyn_cast<CallBase>(&inst);
+                auto callee = call ? index.find(call->getCalledFunction()) : index.end();
+                if (callee == index.end()) {
+                    continue;
+                }
+                unsigned caller_cluster = find(i);
+                unsigned callee_cluster = find(callee->second);
+                if (caller_cluster != callee_cluster &&
+                    sizes[caller_cluster] + sizes[callee_cluster] <= budget)
+                {
+                    leader[callee_cluster] = caller_cluster;
+                    sizes[caller_cluster] += sizes[callee_cluster];
+                }
+            }
+        }
+
+        // Clusters in the order of their first function, largest first.
+        vector<unsigned> clusters;
+        DenseMap<unsigned, vector<Function *>> members;
+        for (unsigned i = 0; i < functions.size(); ++i) {
+            vector<Function *> &cluster = members[find(i)];
+            if (cluster.empty()) {
+                clusters.push_back(find(i));
+            }
+            cluster.push_back(functions[i]);
+        }
+        stable_sort(clusters.begin(), clusters.end(), [&sizes](unsigned lhs, unsigned rhs) {
+            return sizes[lhs] > sizes[rhs];
+        });
+
+        vector<vector<string>> names(shards);
+        vector<size_t> shard_sizes(shards);
+        for (unsigned cluster : clusters) {
+            size_t shard = min_element(shard_sizes.begin(), shard_sizes.end()) -
+                shard_sizes.begin();
+            for (Function *f : members[cluster]) {
+                names[shard].push_back(f->getName().str());
+            }
+            shard_sizes[shard] += sizes[cluster];
+        }
+        // There may be fewer clusters than shards.
+        names.erase(
+            remove_if(names.begin(), names.end(), [](const auto &shard) { return shard.empty(); }),
+            names.end());
+        return names;
+    }
+
+    /// Runs a pipeline on a shard, in the context of the worker.
+    using ShardRunner = function<void(Module &shard, PassBuilder &pb, ModuleAnalysisManager &mam)>;
+
+    /// Run the pipeline on the given functions of the module in bitcode and return the module
+    /// with only the definitions of these functions and of new global variables.
+    auto run_shard(
+        MemoryBufferRef bitcode,
+        const vector<string> &functions,
+        const ShardRunner &run_pipeline,
+        string &error) -> unique_ptr<MemoryBuffer>
+    {
+        // The function bodies are read lazily, so a worker only reads the bodies of its own
+        // functions and its cost grows with the size of its shard rather than of the module.
+        LLVMContext context;
+        Expected<unique_ptr<Module>> parsed = getLazyBitcodeModule(bitcode, context);
+        if (!parsed) {
+            error = toString(parsed.takeError());
+            return nullptr;
+        }
+        Module &m = **parsed;
+
+        StringSet<> owned;
+        for (const string &name : functions) {
+            owned.insert(name);
+        }
+        for (Function &f : m) {
+            if (!f.isDeclaration() && !owned.contains(f.getName())) {
+                f.deleteBody();
+            }
+        }
+        if (Error err = m.materializeAll()) {
+            error = toString(move(err));
+            return nullptr;
+        }
+        StringSet<> existing;
+        for (GlobalVariable &gv : m.globals()) {
+            existing.insert(gv.getName());
+        }
+
+        PassBuilder pb;
+        AAManager aa = pb.buildDefaultAAPipeline();
+        aa.registerFunctionAnalysis<EnvAa>();
+
+        LoopAnalysisManager lam;
+        FunctionAnalysisManager fam;
+        fam.registerPass([] { return EnvAa{}; });
+        CGSCCAnalysisManager cgam;
+        ModuleAnalysisManager mam;
+        fam.registerPass([&] { return move(aa); });
+
+        pb.registerModuleAnalyses(mam);
+        pb.registerCGSCCAnalyses(cgam);
+        pb.registerFunctionAnalyses(fam);
+        pb.registerLoopAnalyses(lam);
+        pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+        run_pipeline(m, pb, mam);
+
+        // Only the functions and new globals are linked back, the existing globals are still in
+        // the original module.
+        vector<GlobalVariable *> appending;
+        for (GlobalVariable &gv : m.globals()) {
+            if (gv.hasAppendingLinkage()) {
+                appending.push_back(&gv);
+            } else if (!gv.isDeclaration() && existing.contains(gv.getName())) {
+                gv.setInitializer(nullptr);
+                gv.setLinkage(GlobalValue::ExternalLinkage);
+            }
+        }
+        for (GlobalVariable *gv : appending) {
+            gv->eraseFromParent();
+        }
+        vector<NamedMDNode *> named_metadata;
+        for (NamedMDNode &md : m.named_metadata()) {
+            named_metadata.push_back(&md);
+        }
+        for (NamedMDNode *md : named_metadata) {
+            m.eraseNamedMetadata(md);
+        }
+
+        return write_bitcode(m);
+    }
+
+    /// Run the pipeline on the given number of shards of m in parallel and link the results
+    /// back into m.
+    void run_sharded(Module &m, size_t shards, const ShardRunner &run_pipeline)
+    {
+        vector<LocalSymbol> locals = externalize_locals(m);
+        StringMap<size_t> function_order = positions(m.getFunctionList());
+        StringMap<size_t> global_order = positions(m.getGlobalList());
+
+        vector<vector<string>> functions = partition(m, shards);
+        shards = functions.size();
+        unique_ptr<MemoryBuffer> bitcode = write_bitcode(m);
+        vector<unique_ptr<MemoryBuffer>> results(shards);
+        vector<string> errors(shards);
+
+        logging::Level log_level = logging::threshold();
+        ThreadPool pool{hardware_concurrency(shards)};
+        for (size_t i = 0; i < shards; ++i) {
+            pool.async([&bitcode, &functions, &run_pipeline, &results, &errors, log_level, i] {
+                logging::ThresholdScope threshold{log_level};
+                results[i] =
+                    run_shard(bitcode->getMemBufferRef(), functions[i], run_pipeline, errors[i]);
+            });
+        }
+        pool.wait();
+
+        string message;
+        for (const string &error : errors) {
+            if (!error.empty()) {
+                message += error + "\n";
+            }
+        }
+        if (!message.empty()) {
+            restore_locals(m, locals);
+            throw runtime_error{message};
+        }
+
+        // Replace the function definitions by those of the shards.
+        for (const vector<string> &shard : functions) {
+            for (const string &name : shard) {
+                m.getFunction(name)->deleteBody();
+            }
+        }
+        Linker linker{m};
+        for (unique_ptr<MemoryBuffer> &result : results) {
+            Expected<unique_ptr<Module>> shard = parseBitcodeFile(*result, m.getContext());
+            if (!shard) {
+                throw runtime_error{toString(shard.takeError())};
+            }
+            if (linker.linkInModule(move(*shard))) {
+                throw runtime_error{"failed to link shard of " + m.getModuleIdentifier()};
+            }
+        }
+
+        // The linker appends the functions of the shards and may move globals.
+        restore_positions(m.getFunctionList(), function_order);
+        restore_positions(m.getGlobalList(), global_order);
+        restore_locals(m, locals);
+    }
+} // namespace
+
+auto binrec::shard_count(Module &m, unsigned jobs) -> size_t
+{
+    size_t definitions = count_if(m.begin(), m.end(), [](Function &f) {
+        return !f.isDeclaration();
+    });
+    size_t shards = min<size_t>(
+        hardware_concurrency(jobs).compute_thread_count(),
+        definitions / min_functions_per_shard);
+    return shards < 2 || !is_shardable(m) ? 1 : shards;
+}
+
+ShardedModulePassAdaptor::ShardedModulePassAdaptor(
+    PipelineBuilder build_pipeline,
+    unsigned jobs) :
+        build_pipeline{move(build_pipeline)},
+        jobs{jobs}
+{
+}
+
+// NOLINTNEXTLINE
+auto ShardedModulePassAdaptor::run(Module &m, ModuleAnalysisManager &am) -> PreservedAnalyses
+{
+    size_t shards = shard_count(m, jobs);
+    if (shards < 2) {
+        PassBuilder pb;
+        return build_pipeline(pb).run(m, am);
+    }
+
+    run_sharded(
+        m,
+        shards,
+        [this](Module &shard, PassBuilder &pb, ModuleAnalysisManager &mam) {
+            build_pipeline(pb).run(shard, mam);
+        });
+    return PreservedAnalyses::none();
+}
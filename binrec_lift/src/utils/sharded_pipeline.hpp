@@ -0,0 +1,52 @@
+#ifndef BINREC_SHARDED_PIPELINE_HPP
+#define BINREC_SHARDED_PIPELINE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+
+namespace binrec {
+    /// The number of shards that the function definitions of m are split into on up to jobs
+    /// threads (0 uses every core), or 1 if m is too small or cannot be split.
+    ///
+    /// Small modules do not pay for reading and linking the module. Modules with debug info,
+    /// aliases, comdats, or address-taken blocks cannot be split, because the shards are linked
+    /// by name and only keep the bodies of their own functions.
+    auto shard_count(llvm::Module &m, unsigned jobs) -> size_t;
+
+    /// Run a module pipeline on shards of a module, on up to jobs threads (0 uses every core).
+    ///
+    /// An LLVMContext must only be used by one thread, so the module is written to bitcode once
+    /// and every worker reads it into its own context, keeps the bodies of its shard of the
+    /// functions, runs the pipeline on them, and writes them back. The shards are then linked
+    /// into the module in order. Local symbols are made external while the shards are out, and
+    /// the linkage, names, and order of all symbols are restored afterwards.
+    ///
+    /// Writing and linking the module costs more than cheap function pipelines, such as
+    /// InstCombine or DCE, save by running in parallel, so only the optimization pipelines are
+    /// worth sharding. Modules that shard_count does not split are run on the calling thread.
+    ///
+    /// Functions that call each other are kept in the same shard while it stays balanced, so most
+    /// calls can still be inlined. Every shard sees the bodies of its own functions and the
+    /// declarations of all others, and all symbols are external while the pipeline runs, so
+    /// interprocedural passes cannot change the signature or the linkage of a function that is used
+    /// by another shard. New global variables, such as lookup tables, are linked back.
+    ///
+    /// Local functions that are no longer used after the shards are linked back are left to
+    /// a following GlobalDCEPass.
+    class ShardedModulePassAdaptor : public llvm::PassInfoMixin<ShardedModulePassAdaptor> {
+    public:
+        using PipelineBuilder = std::function<llvm::ModulePassManager(llvm::PassBuilder &)>;
+
+        ShardedModulePassAdaptor(PipelineBuilder build_pipeline, unsigned jobs);
+
+        auto run(llvm::Module &m, llvm::ModuleAnalysisManager &am) -> llvm::PreservedAnalyses;
+
+    private:
+        PipelineBuilder build_pipeline;
+        unsigned jobs;
+    };
+} // namespace binrec
+
+#endif
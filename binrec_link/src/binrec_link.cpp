@@ -4,6 +4,7 @@
 #include "stitch.hpp"
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/LineIterator.h>
+#include <llvm/Support/Path.h>
 #include <llvm/Support/raw_ostream.h>
 
 using namespace binrec;
@@ -27,6 +28,19 @@ auto load_dependencies(const string &filename, vector<std::string> &input_paths)
     return Error::success();
 }
 
+// binrec_lift compiles a module in shards to {stem}.o, {stem}.1.o, {stem}.2.o, and so on. Add the
+// shards after the first, which is the recovered object itself.
+void add_recovered_parts(const string &filename, vector<std::string> &input_paths)
+{
+    for (unsigned part = 1;; ++part) {
+        SmallString<128> path{filename};
+        sys::path::replace_extension(path, Twine(part) + ".o");
+        if (!exists(path)) {
+            break;
+        }
+        input_paths.emplace_back(path.str());
+    }
+}
 
 auto binrec::run_link(LinkContext &ctx) -> Error
 {
@@ -42,12 +56,11 @@ auto binrec::run_link(LinkContext &ctx) -> Error
     SmallString<128> temp_output_path = ctx.work_dir;
     temp_output_path += "/output";
 
-    vector<std::string> input_paths{
-        ctx.recovered_filename,
-        ctx.librt_filename,
-        original_object_filename,
-        "-static-libgcc",
-        "-lgcc"};
+    vector<std::string> input_paths{ctx.recovered_filename};
+    add_recovered_parts(ctx.recovered_filename, input_paths);
+    input_paths.insert(
+        input_paths.end(),
+        {ctx.librt_filename, original_object_filename, "-static-libgcc", "-lgcc"});
 
     if (ctx.dependencies_filename.length()) {
         // Load the list of dependencies and add them to the input paths
@@ -68,16 +81,10 @@ auto binrec::run_link(LinkContext &ctx) -> Error
         return err;
     }
 
-    if (error_code ec = stitch(temp_output_path, ctx)) {
+    if (error_code ec = stitch(ctx.output_filename, ctx)) {
         return errorCodeToError(ec);
     }
 
-    if (error_code ec = copy_file(temp_output_path, ctx.output_filename)) {
-        return errorCodeToError(ec);
-    }
-
-    setPermissions(ctx.output_filename, *getPermissions(temp_output_path));
-
     return Error::success();
 }
 
@@ -1,7 +1,19 @@
 #include "elf_exe_to_obj.hpp"
-#include "compiler_command.hpp"
 #include "link_error.hpp"
+#include <llvm/MC/MCAsmBackend.h>
+#include <llvm/MC/MCAsmInfo.h>
+#include <llvm/MC/MCCodeEmitter.h>
+#include <llvm/MC/MCContext.h>
+#include <llvm/MC/MCInstrInfo.h>
+#include <llvm/MC/MCObjectFileInfo.h>
+#include <llvm/MC/MCObjectWriter.h>
+#include <llvm/MC/MCRegisterInfo.h>
+#include <llvm/MC/MCSectionELF.h>
+#include <llvm/MC/MCStreamer.h>
+#include <llvm/MC/MCSubtargetInfo.h>
+#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Object/ELFObjectFile.h>
+#include <llvm/Support/TargetSelect.h>
 
 using namespace binrec;
 using namespace llvm;
@@ -14,11 +26,6 @@ namespace {
         uint64_t length = 0;
         SectionInfo section;
     };
-
-    struct SectionFile {
-        SectionInfo section;
-        SmallString<128> path;
-    };
 } // namespace
 
 template <class ELFT> static auto get_ranges(const ELFFile<ELFT> &elf_exe) -> vector<SectionRange>
@@ -51,39 +58,8 @@ template <class ELFT> static auto get_ranges(const ELFFile<ELFT> &elf_exe) -> ve
     return ranges;
 }
 
-static auto
-copy_ranges(const char *exe_data, const vector<SectionRange> &ranges, StringRef work_dir)
-    -> ErrorOr<vector<SectionFile>>
-{
-    vector<SectionFile> section_files;
-
-    for (const auto &range : ranges) {
-        SectionFile sf;
-        sf.section = range.section;
-
-        if (!range.section.nobits) {
-            sf.path = work_dir;
-            sf.path += "/section-";
-            sf.path += range.section.name;
-            sf.path += ".bin";
-
-            error_code ec;
-            raw_fd_ostream os(sf.path, ec);
-            if (ec) {
-                return ec;
-            }
-            os.write(exe_data + range.offset, range.length);
-        }
-
-        section_files.push_back(sf);
-    }
-
-    return section_files;
-}
-
-static auto copy_sections(LinkContext &ctx) -> ErrorOr<vector<SectionFile>>
+static auto get_ranges(const Binary *exe) -> ErrorOr<vector<SectionRange>>
 {
-    Binary *exe = ctx.original_binary.getBinary();
     if (!exe->isELF()) {
         return LinkError::Bad_Elf;
     }
@@ -100,89 +76,119 @@ static auto copy_sections(LinkContext &ctx) -> ErrorOr<vector<SectionFile>>
     } else {
         return LinkError::Bad_Elf;
     }
-
-    const char *exe_data = exe->getData().data();
-    return copy_ranges(exe_data, ranges, ctx.work_dir);
+    return ranges;
 }
 
-static auto section_flags_to_str(uint64_t flags) -> string
+/// The section flags that the assembler used to accept for the original sections.
+static auto section_flags(uint64_t flags) -> unsigned
 {
-    string result;
-    if (!(flags & ELF::SHF_MASKPROC)) {
-        if (flags & ELF::SHF_WRITE) {
-            result += "w";
-        }
-        if (flags & ELF::SHF_ALLOC) {
-            result += "a";
-        }
-        if (flags & ELF::SHF_EXECINSTR) {
-            result += "x";
-        }
+    if (flags & ELF::SHF_MASKPROC) {
+        return 0;
     }
-    return result;
+    return flags & (ELF::SHF_WRITE | ELF::SHF_ALLOC | ELF::SHF_EXECINSTR);
 }
 
+/// Emit a relocatable object with a copy of every original section, named .orig<name> and
+/// labeled by a global binrec_section<name> symbol. The contents are streamed from the mapped
+/// original binary straight into the object writer.
 static auto
-make_object(const vector<SectionFile> &section_files, StringRef object_filename, StringRef work_dir)
+make_object(const ObjectFile &exe, const vector<SectionRange> &ranges, StringRef object_filename)
     -> error_code
 {
-    SmallString<128> assembly_filename = work_dir;
-    assembly_filename.append("/originalSections.S");
+    LLVMInitializeX86TargetInfo();
+    LLVMInitializeX86TargetMC();
+
+    Triple triple = exe.makeTriple();
+    string error;
+    const Target *target = TargetRegistry::lookupTarget(triple.str(), error);
+    if (!target) {
+        errs() << "error: " << error << "\n";
+        return LinkError::MC_Err;
+    }
+
+    MCTargetOptions options;
+    unique_ptr<MCRegisterInfo> mri{target->createMCRegInfo(triple.str())};
+    unique_ptr<MCAsmInfo> mai{target->createMCAsmInfo(*mri, triple.str(), options)};
+    unique_ptr<MCSubtargetInfo> sti{target->createMCSubtargetInfo(triple.str(), "", "")};
+    unique_ptr<MCInstrInfo> mii{target->createMCInstrInfo()};
+    MCContext mc{triple, mai.get(), mri.get(), sti.get(), nullptr, &options};
+    unique_ptr<MCObjectFileInfo> mofi{target->createMCObjectFileInfo(mc, false)};
+    mc.setObjectFileInfo(mofi.get());
 
     error_code ec;
-    raw_fd_ostream assembly_file(assembly_filename, ec);
+    raw_fd_ostream object_file(object_filename, ec);
     if (ec) {
         return ec;
     }
 
-    for (const SectionFile &file : section_files) {
-        const SectionInfo &section = file.section;
-
-        const char *progbits = section.nobits ? "" : ",@progbits";
+    unique_ptr<MCAsmBackend> backend{target->createMCAsmBackend(*sti, *mri, options)};
+    unique_ptr<MCObjectWriter> writer = backend->createObjectWriter(object_file);
+    unique_ptr<MCStreamer> streamer{target->createMCObjectStreamer(
+        triple,
+        mc,
+        move(backend),
+        move(writer),
+        unique_ptr<MCCodeEmitter>{target->createMCCodeEmitter(*mii, *mri, mc)},
+        *sti,
+        false,
+        false,
+        false)};
+    streamer->initSections(false, *sti);
+
+    StringRef exe_data = exe.getData();
+    for (const SectionRange &range : ranges) {
+        const SectionInfo &section = range.section;
 
         auto normalized_section_name = section.name;
         replace(normalized_section_name.begin(), normalized_section_name.end(), '.', '_');
         replace(normalized_section_name.begin(), normalized_section_name.end(), '-', '_');
 
-        assembly_file << "\t.global binrec_section" << normalized_section_name << "\n"
-                      << "\t.section\t.orig" << section.name << ",\""
-                      << section_flags_to_str(section.flags) << "\"" << progbits << "\n"
-                      << "binrec_section" << normalized_section_name << ":\n";
+        // Sections without contents used to be zero-filled progbits sections, which keeps the
+        // layout of the original segment in the linked binary.
+        streamer->SwitchSection(mc.getELFSection(
+            ".orig" + section.name,
+            ELF::SHT_PROGBITS,
+            section_flags(section.flags)));
+        MCSymbol *symbol = mc.getOrCreateSymbol("binrec_section" + normalized_section_name);
+        streamer->emitSymbolAttribute(symbol, MCSA_Global);
+        streamer->emitLabel(symbol);
 
         if (section.nobits) {
-            assembly_file << "\t.zero " << section.size << '\n';
+            streamer->emitZeros(section.size);
         } else {
-            assembly_file << "\t.incbin \"" << file.path << "\"\n";
+            if (range.offset > exe_data.size() || range.length > exe_data.size() - range.offset) {
+                return LinkError::Bad_Elf;
+            }
+            streamer->emitBytes(exe_data.substr(range.offset, range.length));
         }
-
-        assembly_file << "\n";
     }
-    assembly_file.close();
-
-    CompilerCommand cc{CompilerCommandMode::Compile};
-    cc.output_path = object_filename;
-    cc.input_paths.push_back(assembly_filename.c_str());
+    streamer->Finish();
 
-    return cc.run();
+    if (mc.hadError()) {
+        return LinkError::MC_Err;
+    }
+    object_file.close();
+    return object_file.error();
 }
 
 auto binrec::elf_exe_to_obj(StringRef output_path, LinkContext &ctx) -> ErrorOr<vector<SectionInfo>>
 {
-    auto section_files_or_err = copy_sections(ctx);
-    if (error_code ec = section_files_or_err.getError()) {
+    const Binary *exe = ctx.original_binary.getBinary();
+    auto ranges_or_err = get_ranges(exe);
+    if (error_code ec = ranges_or_err.getError()) {
         return ec;
     }
-    auto &section_files = section_files_or_err.get();
+    auto &ranges = ranges_or_err.get();
 
-    if (error_code ec = make_object(section_files, output_path, ctx.work_dir)) {
+    if (error_code ec = make_object(*cast<ObjectFile>(exe), ranges, output_path)) {
         return ec;
     }
 
     vector<SectionInfo> sections;
     transform(
-        section_files.begin(),
-        section_files.end(),
+        ranges.begin(),
+        ranges.end(),
         back_inserter(sections),
-        [](const SectionFile &file) { return file.section; });
+        [](const SectionRange &range) { return range.section; });
     return sections;
 }
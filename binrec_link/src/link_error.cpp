@@ -20,6 +20,8 @@ namespace {
                 return "Bad elf";
             case LinkError::CC_Err:
                 return "Error running cc";
+            case LinkError::MC_Err:
+                return "Error emitting object";
             }
             llvm_unreachable("Unknown error type!");
         }
@@ -11,7 +11,7 @@
     }
 
 namespace binrec {
-    enum class LinkError { Bad_Elf = 1, CC_Err };
+    enum class LinkError { Bad_Elf = 1, CC_Err, MC_Err };
     auto make_error_code(LinkError e) noexcept -> std::error_code;
 } // namespace binrec
 
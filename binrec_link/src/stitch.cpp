@@ -1,8 +1,7 @@
 #include "stitch.hpp"
 #include "link_error.hpp"
 #include <llvm/Object/ELFObjectFile.h>
-#include <llvm/Support/FileSystem.h>
-#include <llvm/Support/Process.h>
+#include <llvm/Support/FileOutputBuffer.h>
 
 using namespace llvm;
 using namespace llvm::object;
@@ -159,33 +158,25 @@ static auto get_patches(const Binary *original_binary, const Binary *recovered_b
     llvm_unreachable("Binary is not an ELF file.");
 }
 
-auto binrec::stitch(StringRef binary_path, LinkContext &ctx) -> error_code
+auto binrec::stitch(StringRef output_path, LinkContext &ctx) -> error_code
 {
     auto patches = get_patches(ctx.original_binary.getBinary(), ctx.recovered_binary.getBinary());
 
-    uint64_t binary_size = 0;
-    error_code ec = sys::fs::file_size(binary_path, binary_size);
-    if (ec) {
-        return ec;
+    // The linked binary is already mapped, so it is copied into the output buffer and patched
+    // there. The buffer is written to a temporary file next to output_path and renamed on
+    // commit, so the output is written once and never left half patched.
+    StringRef recovered_data = ctx.recovered_binary.getBinary()->getData();
+    auto buffer_or_err = FileOutputBuffer::create(
+        output_path,
+        recovered_data.size(),
+        FileOutputBuffer::F_executable);
+    if (auto err = buffer_or_err.takeError()) {
+        return errorToErrorCode(move(err));
     }
+    auto &buffer = buffer_or_err.get();
 
-    int fd = 0;
-    ec = sys::fs::openFileForReadWrite(binary_path, fd, sys::fs::CD_OpenExisting, sys::fs::OF_None);
-    if (ec) {
-        return ec;
-    }
-
-    sys::fs::mapped_file_region
-        mapped_binary{fd, sys::fs::mapped_file_region::readwrite, binary_size, 0, ec};
-    error_code ec2 = sys::Process::SafelyCloseFileDescriptor(fd);
-    if (ec) {
-        return ec;
-    }
-    if (ec2) {
-        return ec2;
-    }
-
-    char *data = mapped_binary.data();
+    auto *data = reinterpret_cast<char *>(buffer->getBufferStart());
+    copy(recovered_data.begin(), recovered_data.end(), data);
     for (auto &patch : patches) {
         const char *source_begin;
         if (patch.from_original) {
@@ -196,5 +187,8 @@ auto binrec::stitch(StringRef binary_path, LinkContext &ctx) -> error_code
         copy(source_begin, source_begin + patch.length, data + patch.target_offset);
     }
 
+    if (auto err = buffer->commit()) {
+        return errorToErrorCode(move(err));
+    }
     return error_code();
 }
@@ -4,7 +4,9 @@
 #include "link_context.hpp"
 
 namespace binrec {
-    auto stitch(llvm::StringRef binary_path, LinkContext &ctx) -> std::error_code;
+    /// Write the linked binary in LinkContext::recovered_binary to output_path, patched with
+    /// the parts of the original binary it must keep.
+    auto stitch(llvm::StringRef output_path, LinkContext &ctx) -> std::error_code;
 } // namespace binrec
 
 #endif
@@ -48,6 +48,7 @@ namespace s2e::plugins {
     void Export::initialize()
     {
         ti = TraceInfo::get();
+        journal = TraceInfoJournal::get();
     }
 
     static inline auto fileExists(const string &name) -> bool
@@ -507,16 +508,29 @@ namespace s2e::plugins {
 
     auto Export::addSuccessor(uint64_t predPc, uint64_t pc) -> bool
     {
-        if (!predPc || !getBB(pc))
+        if (!predPc)
+            return false;
+        // Most executed blocks repeat an edge that was recorded already
+        if (m_successorCache.contains(predPc, pc))
+            return true;
+        if (!getBB(pc))
             return false;
 
+        m_successorCache.insert(predPc, pc);
         Successor successor;
         successor.pc = predPc;
         successor.successor = pc;
-        ti->successors.insert(successor);
+        if (ti->successors.insert(successor)) {
+            journal->addSuccessor(predPc, pc);
+        }
         return true;
     }
 
+    void Export::clearSuccessorCache()
+    {
+        m_successorCache.clear();
+    }
+
     auto Export::getMetadataInst(uint64_t pc) -> Instruction *
     {
         auto func = getBB(pc);
@@ -1,7 +1,9 @@
 #ifndef __PLUGIN_EXPORT_H__
 #define __PLUGIN_EXPORT_H__
 
+#include "binrec/tracing/edge_cache.hpp"
 #include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_journal.hpp"
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Module.h>
 #include <map>
@@ -35,6 +37,8 @@ namespace s2e::plugins {
         void saveLLVMModule(bool intermediate);
         void saveLLVMModule(bool intermediate, int stateNum);
         auto addSuccessor(uint64_t predPc, uint64_t pc) -> bool;
+        /// Forget the successors that were recorded in the trace info of the previous state.
+        void clearSuccessorCache();
         auto getMetadataInst(uint64_t pc) -> llvm::Instruction *;
         auto getBB(uint64_t pc) -> llvm::Function *;
 
@@ -45,6 +49,9 @@ namespace s2e::plugins {
         tb_map_t m_tbs;
 
         std::shared_ptr<binrec::TraceInfo> ti;
+        std::shared_ptr<binrec::TraceInfoJournal> journal;
+        // Successors that are known to be recorded in ti
+        binrec::EdgeCache m_successorCache;
 
         unsigned m_exportCounter;
 
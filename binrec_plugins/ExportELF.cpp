@@ -67,6 +67,8 @@ namespace s2e {
         void ExportELF::slotStateSwitch(S2EExecutionState *state, S2EExecutionState *newState)
         {
             saveLLVMModule(false, state->getID());
+            // FunctionLog restores the trace info of the new state
+            clearSuccessorCache();
         }
 
         ExportELFState::ExportELFState() : prevPc(0), doExport(true) {}
@@ -1,6 +1,7 @@
 #include "FunctionLog.h"
 #include "ModuleSelector.h"
 #include "util.h"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <llvm/IR/Constants.h>
@@ -27,6 +28,37 @@ namespace s2e::plugins {
     {
         ti = TraceInfo::get();
 
+        std::string format =
+            s2e()->getConfig()->getString(getConfigKey() + ".traceInfoFormat", "json");
+        if (!parseTraceInfoFormat(format, m_traceInfoFormat)) {
+            s2e()->getWarningsStream() << "[FunctionLog] Unknown trace info format " << format
+                                       << ", falling back to json\n";
+            m_traceInfoFormat = TraceInfoFormat::Json;
+        }
+
+        // With a journal, trace info is appended in batches while tracing instead of being
+        // written in full at every state switch and at exit.
+        m_journal = TraceInfoJournal::get();
+        if (s2e()->getConfig()->getBool(getConfigKey() + ".traceInfoJournal", false)) {
+            std::string path = s2e()->getOutputFilename(
+                std::string{TraceInfo::defaultName} + TraceInfoJournal::suffix);
+            int64_t batchSize = s2e()->getConfig()->getInt(
+                getConfigKey() + ".journalBatchSize",
+                TraceInfoJournal::defaultBatchSize);
+            if (!m_journal->open(path, std::max<int64_t>(batchSize, 1))) {
+                s2e()->getWarningsStream() << "[FunctionLog] Failed to open journal " << path
+                                           << ", falling back to full trace info dumps\n";
+            }
+        }
+
+        // Executed blocks are buffered and folded into the trace info in batches, which is much
+        // cheaper than inserting every block into the function log while it runs.
+        int64_t blockBufferSize = s2e()->getConfig()->getInt(
+            getConfigKey() + ".blockBufferSize",
+            FunctionLogBuffer::defaultCapacity);
+        m_blocks =
+            FunctionLogBuffer{static_cast<std::size_t>(std::max<int64_t>(blockBufferSize, 1))};
+
         ModuleSelector *selector = (ModuleSelector *)(s2e()->getPlugin("ModuleSelector"));
         selector->onModuleLoad.connect(sigc::mem_fun(*this, &FunctionLog::slotModuleLoad));
         selector->onModuleExecute.connect(sigc::mem_fun(*this, &FunctionLog::slotModuleExecute));
@@ -45,6 +77,15 @@ namespace s2e::plugins {
 
     FunctionLog::~FunctionLog()
     {
+        flushBlocks();
+
+        if (m_journal->isOpen()) {
+            if (!m_journal->close()) {
+                s2e()->getWarningsStream() << "[FunctionLog] Failed to write journal\n";
+            }
+            return;
+        }
+
         if (ti->functionLog.entries.back() == 0) {
             ti->functionLog.entries.pop_back();
         }
@@ -57,16 +98,16 @@ namespace s2e::plugins {
         s2e()->getDebugStream() << "[FunctionLog] Saving Trace Info... \n";
 
         std::string fileName = TraceInfo::defaultName;
-        std::string suffix = ".json";
+        std::string suffix = traceInfoSuffix(m_traceInfoFormat);
 
         if (stateNum >= 0) {
             fileName += "_" + std::to_string(stateNum);
         }
 
-        std::ofstream traceInfoOut(
-            s2e()->getOutputFilename(fileName + suffix).c_str(),
-            std::ios::out | std::ios::trunc);
-        traceInfoOut << *ti;
+        std::string path = s2e()->getOutputFilename(fileName + suffix);
+        if (!binrec::saveTraceInfo(path, *ti, m_traceInfoFormat)) {
+            s2e()->getWarningsStream() << "[FunctionLog] Failed to save " << path << '\n';
+        }
     }
 
     uint64_t entrypoint;
@@ -82,27 +123,32 @@ namespace s2e::plugins {
         if (!ti->functionLog.entries.back()) {
             s2e()->getDebugStream(state) << "[FunctionLog] New entry " << hexval(pc) << '\n';
             ti->functionLog.entries.back() = pc;
+            m_journal->addEntry(ti->functionLog.entries.size() - 1, pc);
             // NOTE (hbrodin): Push the top-level entry onto the call stack to track it's translated
             // blocks as well
             m_callStack.push(pc);
         }
 
-        m_modulePcs.insert(pc);
-
         m_executedBBPc = pc;
 
         if (!m_callStack.empty()) {
-            ti->functionLog.entryToTbs[m_callStack.top()].insert(pc);
-            if (m_callerPc) {
-                ti->functionLog.callerToFollowUp.insert(std::make_pair(m_callerPc, pc));
-                m_callerPc = 0;
+            // Blocks that follow a call are rare, all others are mostly repeats
+            bool recorded = !m_callerPc && !m_recordedBlocks.insert(m_callStack.top(), pc);
+            if (!recorded && m_blocks.append(m_callStack.top(), pc, m_callerPc)) {
+                flushBlocks();
             }
+            m_callerPc = 0;
         } else {
             s2e()->getWarningsStream(state)
                 << "[FunctionLog] Call stack is empty: " << hexval(pc) << "\n";
         }
     }
 
+    void FunctionLog::flushBlocks()
+    {
+        m_blocks.flush(ti->functionLog, *m_journal);
+    }
+
     void FunctionLog::onFunctionCall(
         S2EExecutionState *state,
         const ModuleDescriptorConstPtr &source,
@@ -194,8 +240,12 @@ namespace s2e::plugins {
         m_callerPc = func_caller;
         std::pair<uint32_t, uint32_t> entryToCaller(func_begin, func_caller);
         std::pair<uint32_t, uint32_t> entryToReturn(func_begin, m_executedBBPc);
-        ti->functionLog.entryToCaller.insert(entryToCaller);
-        ti->functionLog.entryToReturn.insert(entryToReturn);
+        if (ti->functionLog.entryToCaller.insert(entryToCaller)) {
+            m_journal->addEntryToCaller(func_begin, func_caller);
+        }
+        if (ti->functionLog.entryToReturn.insert(entryToReturn)) {
+            m_journal->addEntryToReturn(func_begin, m_executedBBPc);
+        }
     }
 
     void FunctionLog::slotStateFork(
@@ -203,6 +253,9 @@ namespace s2e::plugins {
         const std::vector<S2EExecutionState *> &newStates,
         const std::vector<klee::ref<klee::Expr>> &newCondition)
     {
+        // The buffered blocks were executed before the fork, so they belong to every new state
+        flushBlocks();
+
         // Store a copy the current private vars for each new state for eventual state switch
         for (auto newState : newStates) {
             int newStateID = newState->getID();
@@ -210,7 +263,7 @@ namespace s2e::plugins {
             s2e()->getDebugStream()
                 << "[FunctionLog] Storing copy of tracing vars for state: " << newState->getID()
                 << "\n";
-            m_tracesByState.emplace(std::make_pair(newStateID, ti->getCopy()));
+            m_tracesByState.emplace(newStateID, *ti);
 
             std::stack<uint32_t> stackCopy(m_callStack);
             m_stacksByState.emplace(std::make_pair(newStateID, stackCopy));
@@ -225,7 +278,11 @@ namespace s2e::plugins {
         int curStateID = state->getID();
         int newStateID = newState->getID();
 
-        saveTraceInfo(curStateID);
+        flushBlocks();
+        m_recordedBlocks.clear();
+        if (!m_journal->isOpen()) {
+            saveTraceInfo(curStateID);
+        }
 
         // Restore the private vars we have from the fork point
         s2e()->getDebugStream() << "[FunctionLog] Restoring tracing vars for state: " << newStateID
@@ -234,24 +291,18 @@ namespace s2e::plugins {
             m_tracesByState.find(newStateID) != m_tracesByState.end() &&
             " Could not restore traceinfo state!");
 
-        TraceInfo *copyTi = m_tracesByState.at(newStateID);
-        ti->restoreFromCopy(copyTi);
+        *ti = std::move(m_tracesByState.at(newStateID));
         m_callStack = m_stacksByState.at(newStateID);
         m_executedBBPc = m_execPcByState.at(newStateID);
         m_callerPc = m_callerPcByState.at(newStateID);
 
         // Delete the copies we just restored
         m_tracesByState.erase(newStateID);
-        delete copyTi;
         m_stacksByState.erase(newStateID);
         m_execPcByState.erase(newStateID);
         m_callerPcByState.erase(newStateID);
 
-        // Also check if we need to remove the previous state's copies
-        if (m_tracesByState.find(curStateID) != m_tracesByState.end()) {
-            TraceInfo *prevTi = m_tracesByState.at(curStateID);
-            delete prevTi;
-        }
+        // Also remove the previous state's copies
         m_tracesByState.erase(curStateID);
         m_stacksByState.erase(curStateID);
         m_execPcByState.erase(curStateID);
@@ -1,7 +1,11 @@
 #ifndef __PLUGIN_FUNCTIONLOG_H__
 #define __PLUGIN_FUNCTIONLOG_H__
 
+#include "binrec/tracing/edge_cache.hpp"
+#include "binrec/tracing/function_log_buffer.hpp"
 #include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include "binrec/tracing/trace_info_journal.hpp"
 #include <fstream>
 #include <map>
 #include <s2e/ConfigFile.h>
@@ -31,6 +35,7 @@ namespace s2e::plugins {
     private:
         void slotModuleLoad(S2EExecutionState *state, const ModuleDescriptor &module);
         void slotModuleExecute(S2EExecutionState *state, uint64_t pc);
+        void flushBlocks();
 
         void onFunctionCall(
             S2EExecutionState *state,
@@ -56,13 +61,17 @@ namespace s2e::plugins {
     private:
         FunctionMonitor *m_functionMonitor;
         std::shared_ptr<binrec::TraceInfo> ti;
+        binrec::TraceInfoFormat m_traceInfoFormat;
+        std::shared_ptr<binrec::TraceInfoJournal> m_journal;
         uint32_t m_executedBBPc;
         uint32_t m_callerPc;
         uint64_t m_moduleEntryPoint;
-        std::set<uint32_t> m_modulePcs;
+        binrec::FunctionLogBuffer m_blocks;
+        // (entry, pc) pairs that are known to be recorded in m_blocks or ti
+        binrec::EdgeCache m_recordedBlocks;
         std::stack<uint32_t> m_callStack;
 
-        std::map<int, binrec::TraceInfo *> m_tracesByState;
+        std::map<int, binrec::TraceInfo> m_tracesByState;
         std::map<int, uint32_t> m_execPcByState;
         std::map<int, uint32_t> m_callerPcByState;
         std::map<int, std::stack<uint32_t>> m_stacksByState;
@@ -0,0 +1,149 @@
+#include "binrec/tracing/call_stack.hpp"
+#include "binrec/tracing/stack_frame.hpp"
+#include <benchmark/benchmark.h>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <vector>
+
+namespace binrec {
+    namespace {
+        constexpr uint64_t stackTop = 0xbffff000;
+        constexpr uint64_t frameSize = 64;
+
+        /// Discard what CallStack logs to stdout while a benchmark runs. The log messages are
+        /// still formatted, so their cost is part of the measurement.
+        class SilenceStdout {
+            class NullBuffer : public std::streambuf {
+            protected:
+                auto overflow(int_type c) -> int_type override
+                {
+                    return traits_type::not_eof(c);
+                }
+                auto xsputn(const char *, std::streamsize count) -> std::streamsize override
+                {
+                    return count;
+                }
+            };
+
+            NullBuffer buffer;
+            std::streambuf *previous;
+
+        public:
+            SilenceStdout() : previous{std::cout.rdbuf(&buffer)} {}
+            ~SilenceStdout()
+            {
+                std::cout.rdbuf(previous);
+            }
+
+            SilenceStdout(const SilenceStdout &) = delete;
+            auto operator=(const SilenceStdout &) -> SilenceStdout & = delete;
+        };
+
+        auto callSite(int64_t depth) -> InstructionAddress
+        {
+            return InstructionAddress{0x8048000 + static_cast<uint64_t>(depth) * 16};
+        }
+
+        auto target(int64_t depth) -> FunctionAddress
+        {
+            return FunctionAddress{0x8050000 + static_cast<uint64_t>(depth) * 256};
+        }
+
+        auto frameTop(int64_t depth) -> StackAddress
+        {
+            return StackAddress{stackTop - static_cast<uint64_t>(depth + 1) * frameSize};
+        }
+
+        /// Enter depth nested calls, moving the stack pointer in every frame.
+        void enter(CallStack &stack, int64_t depth)
+        {
+            for (int64_t i = 0; i < depth; ++i) {
+                stack.recordCall(target(i), callSite(i), frameTop(i));
+                stack.recordStackPointerUpdate(
+                    callSite(i),
+                    StackAddress{frameTop(i).value - frameSize + 4});
+            }
+        }
+
+        void leave(CallStack &stack, int64_t depth)
+        {
+            for (int64_t i = depth - 1; i >= 0; --i) {
+                stack.recordReturn(target(i));
+            }
+        }
+
+        void callStackCallReturn(benchmark::State &state)
+        {
+            SilenceStdout silence;
+            CallStack stack;
+            stack.recordStackPointerUpdate(InstructionAddress{1}, StackAddress{stackTop});
+            for (auto _ : state) {
+                enter(stack, state.range(0));
+                leave(stack, state.range(0));
+            }
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(callStackCallReturn)->RangeMultiplier(4)->Range(1, 1 << 10);
+
+        /// Record writes to random stack locations with depth live frames.
+        void callStackMemoryWrite(benchmark::State &state)
+        {
+            SilenceStdout silence;
+            CallStack stack;
+            stack.recordStackPointerUpdate(InstructionAddress{1}, StackAddress{stackTop});
+            enter(stack, state.range(0));
+
+            std::mt19937_64 random{0};
+            std::uniform_int_distribution<uint64_t> location{
+                frameTop(state.range(0)).value,
+                stackTop};
+            std::vector<StackAddress> writes;
+            for (int i = 0; i < 4096; ++i) {
+                writes.emplace_back(location(random));
+            }
+
+            for (auto _ : state) {
+                for (StackAddress write : writes) {
+                    stack.recordMemoryWrite(callSite(0), write);
+                }
+            }
+            state.SetItemsProcessed(state.iterations() * writes.size());
+            leave(stack, state.range(0));
+        }
+        BENCHMARK(callStackMemoryWrite)->RangeMultiplier(4)->Range(1, 1 << 10);
+
+        /// Record stack and frame pointer updates at distinct instructions of a new frame.
+        void stackFrameUpdates(benchmark::State &state)
+        {
+            for (auto _ : state) {
+                StackFrame frame{FunctionAddress{0x8050000}, InstructionAddress{0x8048000}};
+                for (int64_t i = 0; i < state.range(0); ++i) {
+                    InstructionAddress at{0x8050000 + static_cast<uint64_t>(i) * 4};
+                    frame.recordStackPointerUpdate(at, Bytes{-4 * (i % 64)});
+                    frame.recordFramePointerUpdate(at, Bytes{-4});
+                }
+                benchmark::ClobberMemory();
+            }
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(stackFrameUpdates)->RangeMultiplier(8)->Range(8, 1 << 15);
+
+        void stackFrameAsData(benchmark::State &state)
+        {
+            StackFrame frame{FunctionAddress{0x8050000}, InstructionAddress{0x8048000}};
+            for (int64_t i = 0; i < state.range(0); ++i) {
+                InstructionAddress at{0x8050000 + static_cast<uint64_t>(i) * 4};
+                frame.recordStackPointerUpdate(at, Bytes{-4 * (i % 64)});
+                frame.recordFramePointerUpdate(at, Bytes{-4});
+            }
+            for (auto _ : state) {
+                StackFrame::Data data = frame.asData();
+                benchmark::DoNotOptimize(data);
+            }
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+        }
+        BENCHMARK(stackFrameAsData)->RangeMultiplier(8)->Range(8, 1 << 15);
+
+    } // namespace
+} // namespace binrec
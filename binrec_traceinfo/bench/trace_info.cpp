@@ -0,0 +1,119 @@
+#include "binrec/tracing/synthetic_trace_info.hpp"
+#include "binrec/tracing/trace_info.hpp"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+using nlohmann::json;
+
+namespace binrec {
+    namespace {
+
+        void traceInfoArguments(benchmark::internal::Benchmark *bench)
+        {
+            bench->RangeMultiplier(8)->Range(1 << 8, 1 << 15)->Complexity(benchmark::oN);
+        }
+
+        void processed(benchmark::State &state)
+        {
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+            state.SetComplexityN(state.range(0));
+        }
+
+        void traceInfoToJson(benchmark::State &state)
+        {
+            TraceInfo ti = syntheticTraceInfo(state.range(0), 0);
+            for (auto _ : state) {
+                json j = ti;
+                benchmark::DoNotOptimize(j);
+            }
+            processed(state);
+        }
+        BENCHMARK(traceInfoToJson)->Apply(traceInfoArguments);
+
+        void traceInfoFromJson(benchmark::State &state)
+        {
+            json j = syntheticTraceInfo(state.range(0), 0);
+            for (auto _ : state) {
+                TraceInfo ti = j.get<TraceInfo>();
+                benchmark::DoNotOptimize(ti);
+            }
+            processed(state);
+        }
+        BENCHMARK(traceInfoFromJson)->Apply(traceInfoArguments);
+
+        void traceInfoDump(benchmark::State &state)
+        {
+            json j = syntheticTraceInfo(state.range(0), 0);
+            for (auto _ : state) {
+                std::string text = j.dump();
+                benchmark::DoNotOptimize(text);
+            }
+            processed(state);
+        }
+        BENCHMARK(traceInfoDump)->Apply(traceInfoArguments);
+
+        void traceInfoParse(benchmark::State &state)
+        {
+            std::string text = json(syntheticTraceInfo(state.range(0), 0)).dump();
+            for (auto _ : state) {
+                json j = json::parse(text);
+                benchmark::DoNotOptimize(j);
+            }
+            state.SetBytesProcessed(state.iterations() * text.size());
+            processed(state);
+        }
+        BENCHMARK(traceInfoParse)->Apply(traceInfoArguments);
+
+        /// Merge a second run into a trace info, like binrec_tracemerge does for every input.
+        void traceInfoAdd(benchmark::State &state)
+        {
+            TraceInfo first = syntheticTraceInfo(state.range(0), 1);
+            TraceInfo second = syntheticTraceInfo(state.range(0), 2);
+            for (auto _ : state) {
+                state.PauseTiming();
+                TraceInfo merged;
+                merged.add(first);
+                state.ResumeTiming();
+
+                merged.add(second);
+                benchmark::DoNotOptimize(merged);
+
+                state.PauseTiming();
+                merged = TraceInfo{};
+                state.ResumeTiming();
+            }
+            processed(state);
+        }
+        BENCHMARK(traceInfoAdd)->Apply(traceInfoArguments);
+
+        /// Keep a snapshot of the trace for a forked state, which the S2E plugins do on every
+        /// fork.
+        void traceInfoSnapshot(benchmark::State &state)
+        {
+            TraceInfo ti = syntheticTraceInfo(state.range(0), 0);
+            for (auto _ : state) {
+                TraceInfo snapshot = ti;
+                benchmark::DoNotOptimize(snapshot);
+            }
+            processed(state);
+        }
+        BENCHMARK(traceInfoSnapshot)->Apply(traceInfoArguments);
+
+        /// Record the first successor and call of a forked state, which clones the storage it
+        /// shared with its snapshot.
+        void traceInfoSnapshotWrite(benchmark::State &state)
+        {
+            TraceInfo ti = syntheticTraceInfo(state.range(0), 0);
+            for (auto _ : state) {
+                TraceInfo forked = ti;
+                forked.successors.insert({1, 2});
+                forked.functionLog.entryToCaller.insert({3, 4});
+                forked.functionLog.entryToTbs[5].insert(6);
+                benchmark::DoNotOptimize(forked);
+            }
+            processed(state);
+        }
+        BENCHMARK(traceInfoSnapshotWrite)->Apply(traceInfoArguments);
+
+    } // namespace
+} // namespace binrec
@@ -0,0 +1,53 @@
+#ifndef BINREC_COPY_ON_WRITE_HPP
+#define BINREC_COPY_ON_WRITE_HPP
+
+#include <memory>
+
+namespace binrec {
+    /// A value that is shared between copies until one of them is modified.
+    ///
+    /// Copying takes constant time. The first write through a copy whose value is shared clones
+    /// the value, so only copies that are actually modified pay for it. A default constructed
+    /// instance allocates nothing and reads as a default constructed value.
+    template <typename T> class CopyOnWrite {
+        std::shared_ptr<T> value;
+
+        static auto empty() -> const T &
+        {
+            static const T emptyValue{};
+            return emptyValue;
+        }
+
+    public:
+        CopyOnWrite() = default;
+        explicit CopyOnWrite(T initial) : value{std::make_shared<T>(std::move(initial))} {}
+
+        [[nodiscard]] auto read() const -> const T &
+        {
+            return value ? *value : empty();
+        }
+
+        /// Get the value for modification, cloning it first if it is shared with another copy.
+        auto write() -> T &
+        {
+            if (!value) {
+                value = std::make_shared<T>();
+            } else if (value.use_count() > 1) {
+                value = std::make_shared<T>(*value);
+            }
+            return *value;
+        }
+
+        [[nodiscard]] auto sharesWith(const CopyOnWrite &other) const -> bool
+        {
+            return value && value == other.value;
+        }
+
+        void reset()
+        {
+            value.reset();
+        }
+    };
+} // namespace binrec
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef BINREC_FLAT_MAP_HPP
+#define BINREC_FLAT_MAP_HPP
+
+#include "binrec/copy_on_write.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace binrec {
+    /// A map stored as a vector of key/value pairs sorted by key.
+    ///
+    /// Meant for maps with comparatively few keys that are mostly looked up, such as the
+    /// translation blocks of each function. Keys must not be modified through iterators.
+    ///
+    /// Copies share their storage until one of them is modified, so copying a map takes constant
+    /// time. Everything that hands out mutable access, including the non-const iterators,
+    /// detaches the map from its copies first.
+    template <typename K, typename V, typename Compare = std::less<K>> class FlatMap {
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+        using size_type = std::size_t;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    private:
+        CopyOnWrite<std::vector<value_type>> storage;
+
+        [[nodiscard]] auto items() const -> const std::vector<value_type> &
+        {
+            return storage.read();
+        }
+
+        static auto keyLess(const value_type &item, const K &key) -> bool
+        {
+            return Compare{}(item.first, key);
+        }
+
+        auto lowerBound(const K &key) const -> const_iterator
+        {
+            return std::lower_bound(items().begin(), items().end(), key, keyLess);
+        }
+
+        auto matches(const_iterator it, const K &key) const -> bool
+        {
+            return it != items().end() && !Compare{}(key, it->first);
+        }
+
+        /// Turn an iterator into the shared storage into one into the detached storage.
+        auto detach(const_iterator it) -> iterator
+        {
+            auto offset = it - items().begin();
+            return storage.write().begin() + offset;
+        }
+
+    public:
+        FlatMap() = default;
+        /// Keys that occur more than once keep their first value, like std::map.
+        FlatMap(std::initializer_list<value_type> values)
+        {
+            std::vector<value_type> sorted{values};
+            std::stable_sort(sorted.begin(), sorted.end(), [](const auto &lhs, const auto &rhs) {
+                return Compare{}(lhs.first, rhs.first);
+            });
+            auto last =
+                std::unique(sorted.begin(), sorted.end(), [](const auto &lhs, const auto &rhs) {
+                    return !Compare{}(lhs.first, rhs.first);
+                });
+            sorted.erase(last, sorted.end());
+            storage = CopyOnWrite<std::vector<value_type>>{std::move(sorted)};
+        }
+
+        template <typename... Args>
+        auto try_emplace(const K &key, Args &&...args) -> std::pair<iterator, bool>
+        {
+            auto it = lowerBound(key);
+            if (matches(it, key)) {
+                return {detach(it), false};
+            }
+            auto offset = it - items().begin();
+            std::vector<value_type> &data = storage.write();
+            auto inserted = data.emplace(
+                data.begin() + offset,
+                std::piecewise_construct,
+                std::forward_as_tuple(key),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+            return {inserted, true};
+        }
+
+        /// Insert a key unless it exists. Takes constant time when hint is end() and the key is
+        /// not smaller than any stored key, which makes building a map from sorted keys linear.
+        template <typename... Args>
+        auto emplace_hint(const_iterator hint, const K &key, Args &&...args) -> iterator
+        {
+            const std::vector<value_type> &current = items();
+            bool append = hint == current.cend() &&
+                (current.empty() || !Compare{}(key, current.back().first));
+            if (!append) {
+                return try_emplace(key, std::forward<Args>(args)...).first;
+            }
+
+            std::vector<value_type> &data = storage.write();
+            if (!data.empty() && !Compare{}(data.back().first, key)) {
+                return data.end() - 1;
+            }
+            data.emplace_back(
+                std::piecewise_construct,
+                std::forward_as_tuple(key),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+            return data.end() - 1;
+        }
+
+        auto insert(const value_type &value) -> std::pair<iterator, bool>
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        auto operator[](const K &key) -> V &
+        {
+            return try_emplace(key).first->second;
+        }
+
+        [[nodiscard]] auto find(const K &key) -> iterator
+        {
+            auto it = lowerBound(key);
+            return matches(it, key) ? detach(it) : end();
+        }
+        [[nodiscard]] auto find(const K &key) const -> const_iterator
+        {
+            auto it = lowerBound(key);
+            return matches(it, key) ? it : items().end();
+        }
+        [[nodiscard]] auto count(const K &key) const -> size_type
+        {
+            return contains(key) ? 1 : 0;
+        }
+        [[nodiscard]] auto contains(const K &key) const -> bool
+        {
+            return matches(lowerBound(key), key);
+        }
+
+        void reserve(size_type capacity)
+        {
+            storage.write().reserve(capacity);
+        }
+        void clear()
+        {
+            storage.reset();
+        }
+
+        [[nodiscard]] auto size() const -> size_type
+        {
+            return items().size();
+        }
+        [[nodiscard]] auto empty() const -> bool
+        {
+            return items().empty();
+        }
+
+        [[nodiscard]] auto begin() -> iterator
+        {
+            return storage.write().begin();
+        }
+        [[nodiscard]] auto end() -> iterator
+        {
+            return storage.write().end();
+        }
+        [[nodiscard]] auto begin() const -> const_iterator
+        {
+            return items().begin();
+        }
+        [[nodiscard]] auto end() const -> const_iterator
+        {
+            return items().end();
+        }
+
+        auto operator==(const FlatMap &other) const -> bool
+        {
+            return storage.sharesWith(other.storage) || items() == other.items();
+        }
+        auto operator!=(const FlatMap &other) const -> bool
+        {
+            return !(*this == other);
+        }
+    };
+} // namespace binrec
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef BINREC_FLAT_SET_HPP
+#define BINREC_FLAT_SET_HPP
+
+#include "binrec/copy_on_write.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace binrec {
+    /// A set stored as a sorted vector without duplicates.
+    ///
+    /// Single inserts of values that are not larger than every stored value are appended to an
+    /// unsorted tail, which is sorted, merged and deduplicated in bulk once it is as large as the
+    /// sorted part or once the set is read. This keeps inserts amortized logarithmic while
+    /// lookups and iteration work on contiguous memory.
+    ///
+    /// Copies share their storage until one of them is modified, so copying a set takes constant
+    /// time. A set is normalized before its storage is shared, so shared storage is never sorted
+    /// in place.
+    template <typename T, typename Compare = std::less<T>> class FlatSet {
+        struct Storage {
+            std::vector<T> items;
+            /// The number of leading items that are sorted and unique.
+            std::size_t sortedSize{};
+        };
+        mutable CopyOnWrite<Storage> storage;
+
+        static constexpr std::size_t minTailSize = 64;
+
+        static auto equivalent(const T &lhs, const T &rhs) -> bool
+        {
+            return !Compare{}(lhs, rhs) && !Compare{}(rhs, lhs);
+        }
+
+        [[nodiscard]] auto items() const -> const std::vector<T> &
+        {
+            return storage.read().items;
+        }
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using const_iterator = typename std::vector<T>::const_iterator;
+        using iterator = const_iterator;
+        using const_reverse_iterator = typename std::vector<T>::const_reverse_iterator;
+        using reverse_iterator = const_reverse_iterator;
+
+        FlatSet() = default;
+        FlatSet(std::initializer_list<T> values) : storage{Storage{values}}
+        {
+            normalize();
+        }
+        template <typename It>
+        FlatSet(It first, It last) : storage{Storage{std::vector<T>(first, last)}}
+        {
+            normalize();
+        }
+
+        FlatSet(const FlatSet &other) : storage{(other.normalize(), other.storage)} {}
+        FlatSet(FlatSet &&other) noexcept = default;
+        auto operator=(const FlatSet &other) -> FlatSet &
+        {
+            other.normalize();
+            storage = other.storage;
+            return *this;
+        }
+        auto operator=(FlatSet &&other) noexcept -> FlatSet & = default;
+        ~FlatSet() = default;
+
+        /// Insert a single value. Returns false if the value is known to be stored already. The
+        /// unsorted tail is not searched, so a value that is inserted again before the next
+        /// normalization is reported as new more than once.
+        auto insert(const T &value) -> bool
+        {
+            const Storage &current = storage.read();
+            if (current.sortedSize == current.items.size() &&
+                (current.items.empty() || Compare{}(current.items.back(), value)))
+            {
+                Storage &data = storage.write();
+                data.items.push_back(value);
+                ++data.sortedSize;
+                return true;
+            }
+
+            auto sortedEnd =
+                current.items.begin() + static_cast<std::ptrdiff_t>(current.sortedSize);
+            if (std::binary_search(current.items.begin(), sortedEnd, value, Compare{})) {
+                return false;
+            }
+
+            Storage &data = storage.write();
+            data.items.push_back(value);
+            if (data.items.size() - data.sortedSize >= std::max(data.sortedSize, minTailSize)) {
+                normalize();
+            }
+            return true;
+        }
+
+        template <typename It> void insert(It first, It last)
+        {
+            if (first == last) {
+                return;
+            }
+            Storage &data = storage.write();
+            data.items.insert(data.items.end(), first, last);
+            normalize();
+        }
+
+        /// Replace the contents with the given values, which do not need to be sorted. Sorted
+        /// values are adopted without sorting them again.
+        void assign(std::vector<T> values)
+        {
+            storage = CopyOnWrite<Storage>{Storage{std::move(values)}};
+            normalize();
+        }
+
+        /// Sort and deduplicate the unsorted tail now. Reads normalize the set on demand, so a
+        /// set must be normalized before it is read from several threads at once.
+        void normalize() const
+        {
+            if (storage.read().sortedSize == items().size()) {
+                return;
+            }
+            Storage &data = storage.write();
+
+            // Values that were appended in ascending order after every sorted value are adopted
+            // without sorting them again.
+            auto tail = data.items.begin() + static_cast<std::ptrdiff_t>(data.sortedSize);
+            auto unordered =
+                std::adjacent_find(tail, data.items.end(), [](const T &lhs, const T &rhs) {
+                    return !Compare{}(lhs, rhs);
+                });
+            if (unordered == data.items.end() &&
+                (tail == data.items.begin() || Compare{}(*(tail - 1), *tail)))
+            {
+                data.sortedSize = data.items.size();
+                return;
+            }
+
+            std::sort(tail, data.items.end(), Compare{});
+            std::inplace_merge(data.items.begin(), tail, data.items.end(), Compare{});
+            data.items.erase(
+                std::unique(data.items.begin(), data.items.end(), equivalent),
+                data.items.end());
+            data.sortedSize = data.items.size();
+        }
+
+        /// The stored values as a sorted vector without duplicates.
+        [[nodiscard]] auto values() const -> const std::vector<T> &
+        {
+            normalize();
+            return items();
+        }
+
+        void reserve(size_type capacity)
+        {
+            storage.write().items.reserve(capacity);
+        }
+
+        void clear()
+        {
+            storage.reset();
+        }
+
+        [[nodiscard]] auto find(const T &value) const -> const_iterator
+        {
+            const std::vector<T> &sorted = values();
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), value, Compare{});
+            return it != sorted.end() && equivalent(*it, value) ? it : sorted.cend();
+        }
+        [[nodiscard]] auto count(const T &value) const -> size_type
+        {
+            return find(value) != end() ? 1 : 0;
+        }
+        [[nodiscard]] auto contains(const T &value) const -> bool
+        {
+            return find(value) != end();
+        }
+
+        [[nodiscard]] auto size() const -> size_type
+        {
+            return values().size();
+        }
+        [[nodiscard]] auto empty() const -> bool
+        {
+            return items().empty();
+        }
+
+        [[nodiscard]] auto begin() const -> const_iterator
+        {
+            return values().cbegin();
+        }
+        [[nodiscard]] auto end() const -> const_iterator
+        {
+            return values().cend();
+        }
+        [[nodiscard]] auto rbegin() const -> const_reverse_iterator
+        {
+            return values().crbegin();
+        }
+        [[nodiscard]] auto rend() const -> const_reverse_iterator
+        {
+            return values().crend();
+        }
+
+        auto operator==(const FlatSet &other) const -> bool
+        {
+            if (storage.sharesWith(other.storage)) {
+                return true;
+            }
+            const std::vector<T> &lhs = values();
+            const std::vector<T> &rhs = other.values();
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), equivalent);
+        }
+        auto operator!=(const FlatSet &other) const -> bool
+        {
+            return !(*this == other);
+        }
+    };
+} // namespace binrec
+
+#endif
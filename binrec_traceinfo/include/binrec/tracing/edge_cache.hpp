@@ -0,0 +1,84 @@
+#ifndef BINREC_EDGE_CACHE_HPP
+#define BINREC_EDGE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace binrec {
+    /// A direct-mapped cache of pairs of addresses that were recently recorded, such as the
+    /// successors of a block or the blocks of a function.
+    ///
+    /// Most blocks of a long trace are repeats, so checking the cache first spares the sets of
+    /// the trace info a lookup for almost every executed block. Every slot stores one pair and
+    /// a colliding pair replaces it, so a pair may be missed and recorded again, but a pair
+    /// that was not recorded is never reported as cached.
+    ///
+    /// The cache must be cleared whenever the recorded pairs are replaced, such as when the
+    /// trace info of another state is restored.
+    class EdgeCache {
+    public:
+        static constexpr std::size_t defaultSlots = 4096;
+
+        /// Create a cache with at least slots slots, rounded up to a power of two.
+        explicit EdgeCache(std::size_t slots = defaultSlots) : mask{roundUp(slots) - 1}
+        {
+            clear();
+        }
+
+        /// Returns true if the pair is cached, without caching it.
+        [[nodiscard]] auto contains(uint64_t first, uint64_t second) const -> bool
+        {
+            const Slot &slot = slots[index(first, second)];
+            return slot.first == first && slot.second == second;
+        }
+
+        /// Cache the pair. Returns false if it was cached already and does not need to be
+        /// recorded again.
+        auto insert(uint64_t first, uint64_t second) -> bool
+        {
+            Slot &slot = slots[index(first, second)];
+            if (slot.first == first && slot.second == second) {
+                return false;
+            }
+            slot = {first, second};
+            return true;
+        }
+
+        void clear()
+        {
+            slots.assign(mask + 1, Slot{emptyAddress, emptyAddress});
+        }
+
+    private:
+        struct Slot {
+            uint64_t first;
+            uint64_t second;
+        };
+
+        /// No recorded pair consists of two maximum addresses.
+        static constexpr uint64_t emptyAddress = UINT64_MAX;
+
+        std::size_t mask;
+        std::vector<Slot> slots;
+
+        static auto roundUp(std::size_t slots) -> std::size_t
+        {
+            std::size_t result = 1;
+            while (result < slots) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        [[nodiscard]] auto index(uint64_t first, uint64_t second) const -> std::size_t
+        {
+            // Fibonacci hashing spreads neighbouring blocks over the whole cache.
+            uint64_t hash = (first * 0x9e3779b97f4a7c15ULL) ^ second;
+            hash *= 0x9e3779b97f4a7c15ULL;
+            return static_cast<std::size_t>(hash >> 32) & mask;
+        }
+    };
+} // namespace binrec
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef BINREC_FUNCTION_LOG_BUFFER_HPP
+#define BINREC_FUNCTION_LOG_BUFFER_HPP
+
+#include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_journal.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace binrec {
+    /// Collects the translation blocks executed by a traced function in a fixed-size buffer and
+    /// folds them into a FunctionLog in batches.
+    ///
+    /// Appending a block is a store into a preallocated vector, so the emulation loop does not
+    /// search or grow the sets of the function log for every executed block. A block that is
+    /// executed again right after itself, such as the body of a tight loop, is only stored
+    /// once. A flush sorts and deduplicates the buffered blocks before it inserts them, so a
+    /// loop over several blocks costs one insert per distinct block and batch.
+    ///
+    /// The buffer belongs to the state that is currently executing. It must be flushed before
+    /// the function log is copied or saved, such as when a state forks or is switched out.
+    class FunctionLogBuffer {
+    public:
+        static constexpr std::size_t defaultCapacity = 4096;
+
+        struct BlockEvent {
+            /// The entry of the function that executed the block.
+            uint32_t entry;
+            uint32_t pc;
+            /// The call site that returned right before the block, or 0.
+            uint32_t caller;
+
+            auto operator==(const BlockEvent &other) const -> bool
+            {
+                return entry == other.entry && pc == other.pc && caller == other.caller;
+            }
+            auto operator<(const BlockEvent &other) const -> bool;
+        };
+
+        explicit FunctionLogBuffer(std::size_t capacity = defaultCapacity);
+
+        /// Record that the function at entry executed the block at pc, after the call at caller
+        /// returned if caller is not 0. Returns true once the buffer is full and must be
+        /// flushed.
+        auto append(uint32_t entry, uint32_t pc, uint32_t caller) -> bool
+        {
+            BlockEvent event{entry, pc, caller};
+            if (size > 0 && events[size - 1] == event) {
+                return false;
+            }
+            events[size++] = event;
+            return size == events.size();
+        }
+
+        /// Add the buffered blocks to FunctionLog::entryToTbs and their callers to
+        /// FunctionLog::callerToFollowUp, record the new facts in journal, and empty the buffer.
+        void flush(FunctionLog &log, TraceInfoJournal &journal);
+
+        [[nodiscard]] auto empty() const -> bool
+        {
+            return size == 0;
+        }
+
+    private:
+        std::vector<BlockEvent> events;
+        std::size_t size{};
+    };
+} // namespace binrec
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef BINREC_SYNTHETIC_TRACE_INFO_HPP
+#define BINREC_SYNTHETIC_TRACE_INFO_HPP
+
+#include "binrec/tracing/trace_info.hpp"
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace binrec {
+    /// The start of the text section of a typical 32-bit executable.
+    constexpr uint64_t syntheticTextStart = 0x8048000;
+
+    /// Generate a trace info with size successors and memory accesses, and one function per 64
+    /// of them. Trace infos of different seeds draw from the same addresses, so they overlap
+    /// like the trace infos of separate runs of a binary.
+    ///
+    /// Shared by the microbenchmarks and binrec_bench, so both measure the same workload.
+    inline auto syntheticTraceInfo(std::size_t size, uint64_t seed) -> TraceInfo
+    {
+        std::mt19937_64 random{seed};
+        std::uniform_int_distribution<uint64_t> block{
+            syntheticTextStart,
+            syntheticTextStart + size * 16};
+        std::size_t functions = std::max<std::size_t>(size / 64, 1);
+        std::uniform_int_distribution<uint64_t> function{
+            syntheticTextStart,
+            syntheticTextStart + functions * 1024};
+
+        TraceInfo ti;
+        for (std::size_t i = 0; i < size; ++i) {
+            ti.successors.insert({block(random), block(random)});
+
+            bool isLocal = random() % 4 != 0;
+            int64_t offset = isLocal ? -static_cast<int64_t>(random() % 256) * 4
+                                     : static_cast<int64_t>(random() % 4096);
+            ti.memoryAccesses.push_back(
+                {block(random),
+                 offset,
+                 random() % 2 == 0,
+                 isLocal,
+                 4,
+                 random() % 8 != 0,
+                 function(random)});
+        }
+
+        FunctionLog &log = ti.functionLog;
+        for (std::size_t i = 0; i < functions; ++i) {
+            uint64_t entry = function(random);
+            log.entries.push_back(entry);
+            log.entryToCaller.insert({entry, block(random)});
+            log.entryToReturn.insert({entry, block(random)});
+            log.callerToFollowUp.insert({block(random), block(random)});
+
+            FlatSet<uint64_t> &tbs = log.entryToTbs[entry];
+            for (int j = 0; j < 16; ++j) {
+                tbs.insert(block(random));
+            }
+
+            std::string name = "func_" + std::to_string(entry);
+            ti.stackFrameSizes[name] = (random() % 64) * 4;
+            // TraceInfo::add requires the same stack difference in every run.
+            ti.stackDifference[name] = (entry % 4) * 4;
+        }
+        return ti;
+    }
+} // namespace binrec
+
+#endif
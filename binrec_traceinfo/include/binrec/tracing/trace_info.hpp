@@ -1,17 +1,52 @@
 #ifndef BINREC_TRACE_INFO_HPP
 #define BINREC_TRACE_INFO_HPP
 
+#include "binrec/flat_map.hpp"
+#include "binrec/flat_set.hpp"
 #include <cstdint>
 #include <istream>
-#include <map>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <ostream>
-#include <set>
 #include <unordered_map>
 #include <vector>
 
 namespace binrec {
+    template <typename T, typename Compare>
+    // NOLINTNEXTLINE
+    void to_json(nlohmann::json &j, const FlatSet<T, Compare> &s)
+    {
+        j = s.values();
+    }
+
+    template <typename T, typename Compare>
+    // NOLINTNEXTLINE
+    void from_json(const nlohmann::json &j, FlatSet<T, Compare> &s)
+    {
+        s.assign(j.get<std::vector<T>>());
+    }
+
+    template <typename K, typename V, typename Compare>
+    // NOLINTNEXTLINE
+    void to_json(nlohmann::json &j, const FlatMap<K, V, Compare> &m)
+    {
+        j = nlohmann::json::array();
+        for (const auto &item : m) {
+            j.push_back(item);
+        }
+    }
+
+    template <typename K, typename V, typename Compare>
+    // NOLINTNEXTLINE
+    void from_json(const nlohmann::json &j, FlatMap<K, V, Compare> &m)
+    {
+        m.clear();
+        m.reserve(j.size());
+        for (const auto &item : j) {
+            m.emplace_hint(m.end(), item.at(0).get<K>(), item.at(1).get<V>());
+        }
+    }
+
     struct MemoryAccess {
         uint64_t pc;
         int64_t offset;
@@ -20,6 +55,9 @@ namespace binrec {
         uint64_t size;
         bool isDirect;
         uint64_t fnBase;
+
+        auto operator<(const MemoryAccess &other) const -> bool;
+        auto operator==(const MemoryAccess &other) const -> bool;
     };
     void to_json(nlohmann::json &j, const MemoryAccess &ma);
     void from_json(const nlohmann::json &j, MemoryAccess &ma);
@@ -33,31 +71,34 @@ namespace binrec {
     void to_json(nlohmann::json &j, const Successor &s);
     void from_json(const nlohmann::json &j, Successor &s);
 
+    using AddressPairSet = FlatSet<std::pair<uint64_t, uint64_t>>;
+
     struct FunctionLog {
         std::vector<uint64_t> entries;
-        std::set<std::pair<uint64_t, uint64_t>> entryToCaller;
-        std::set<std::pair<uint64_t, uint64_t>> entryToReturn;
-        std::set<std::pair<uint64_t, uint64_t>> callerToFollowUp;
-        std::map<uint64_t, std::set<uint64_t>> entryToTbs;
+        AddressPairSet entryToCaller;
+        AddressPairSet entryToReturn;
+        AddressPairSet callerToFollowUp;
+        FlatMap<uint64_t, FlatSet<uint64_t>> entryToTbs;
     };
     void to_json(nlohmann::json &j, const FunctionLog &s);
     void from_json(const nlohmann::json &j, FunctionLog &s);
 
-
+    /// Copies share the storage of the sets and maps until either side modifies them, so the
+    /// S2E plugins can keep a snapshot of the trace for every forked state.
     struct TraceInfo {
         static constexpr const char *defaultFilename = "traceInfo.json";
         static constexpr const char *defaultName = "traceInfo";
         static constexpr const char *defaultSuffix = ".json";
+        static constexpr const char *defaultBinaryFilename = "traceInfo.bin";
+        static constexpr const char *binarySuffix = ".bin";
         static auto get() -> std::shared_ptr<TraceInfo>;
 
         std::unordered_map<std::string, std::uint32_t> stackFrameSizes;
         std::unordered_map<std::string, std::uint32_t> stackDifference;
         std::vector<MemoryAccess> memoryAccesses;
-        std::set<Successor> successors;
+        FlatSet<Successor> successors;
         FunctionLog functionLog;
 
-        void restoreFromCopy(TraceInfo *copyTi);
-        auto getCopy() -> TraceInfo *;
         void add(const TraceInfo &ti);
     };
     void to_json(nlohmann::json &j, const TraceInfo &s);
@@ -0,0 +1,170 @@
+#ifndef BINREC_TRACE_INFO_BINARY_HPP
+#define BINREC_TRACE_INFO_BINARY_HPP
+
+#include "trace_info.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace binrec {
+    enum class TraceInfoFormat { Json, Binary };
+
+    auto parseTraceInfoFormat(const std::string &name, TraceInfoFormat &format) -> bool;
+    auto traceInfoSuffix(TraceInfoFormat format) -> const char *;
+
+    /// Versioned columnar encoding of TraceInfo.
+    ///
+    /// A file starts with a fixed header followed by one column per TraceInfo field. Every
+    /// column stores its values with a single fixed width (1, 2, 4 or 8 bytes) that is chosen
+    /// by the writer, so a mapped file can be decoded without any parsing. Sorted key columns
+    /// are stored as deltas to the previous value and the second column of sorted pairs is
+    /// stored as a delta to the previous value with the same key.
+    namespace binary {
+        constexpr char magic[4] = {'B', 'R', 'T', 'I'};
+        constexpr uint32_t version = 1;
+
+        enum class Encoding : uint8_t {
+            /// Values are stored as is.
+            Raw = 0,
+            /// Each value is stored as the difference to the previous value.
+            Delta = 1,
+            /// Like Delta, but restarts from zero whenever the key column changes.
+            KeyedDelta = 2,
+            /// Signed values stored in zig-zag encoding.
+            ZigZag = 3,
+        };
+
+        enum ColumnId : uint32_t {
+            Entries = 0,
+            EntryToCallerEntry,
+            EntryToCallerCaller,
+            EntryToReturnEntry,
+            EntryToReturnReturn,
+            CallerToFollowUpCaller,
+            CallerToFollowUpFollowUp,
+            EntryToTbsEntry,
+            EntryToTbsTb,
+            SuccessorsPc,
+            SuccessorsSuccessor,
+            MemoryAccessesPc,
+            MemoryAccessesOffset,
+            MemoryAccessesSize,
+            MemoryAccessesFnBase,
+            MemoryAccessesFlags,
+            StackFrameSizesNameLength,
+            StackFrameSizesNameBytes,
+            StackFrameSizesValue,
+            StackDifferenceNameLength,
+            StackDifferenceNameBytes,
+            StackDifferenceValue,
+            ColumnCount
+        };
+
+        enum MemoryAccessFlags : uint8_t {
+            IsWrite = 1U << 0U,
+            IsLocalAccess = 1U << 1U,
+            IsDirect = 1U << 2U,
+        };
+
+        /// A read-only view of a single encoded column.
+        class Column {
+        public:
+            uint64_t size{};
+            uint8_t width{};
+            Encoding encoding{};
+            const uint8_t *data{};
+
+            /// The stored (still encoded) value at the given index.
+            [[nodiscard]] auto stored(uint64_t index) const -> uint64_t;
+            /// Decode the entire column. Keyed columns require the decoded key column.
+            [[nodiscard]] auto decode(const std::vector<uint64_t> *keys = nullptr) const
+                -> std::vector<uint64_t>;
+        };
+
+        /// Decodes a key column and its value column one pair at a time, so a sorted run can be
+        /// walked without decoding it up front. Both columns must have the same size.
+        class PairCursor {
+            const Column *keys{};
+            const Column *values{};
+            uint64_t index{};
+            std::pair<uint64_t, uint64_t> current_{};
+
+            void decodeCurrent(bool first);
+
+        public:
+            PairCursor(const Column &keys, const Column &values);
+
+            [[nodiscard]] auto valid() const -> bool
+            {
+                return index < keys->size;
+            }
+            [[nodiscard]] auto current() const -> const std::pair<uint64_t, uint64_t> &
+            {
+                return current_;
+            }
+            void next();
+        };
+
+        /// A validated view of an encoded trace info buffer, typically a mapped file.
+        class TraceInfoView {
+            Column columns[ColumnCount];
+
+        public:
+            /// Validate the buffer and index its columns. The buffer must outlive the view.
+            /// Columns that describe the same members are checked to have matching sizes.
+            auto open(const uint8_t *data, std::size_t size) -> bool;
+
+            [[nodiscard]] auto column(ColumnId id) const -> const Column &;
+        };
+
+        auto isBinary(const uint8_t *data, std::size_t size) -> bool;
+
+        void write(std::ostream &os, const TraceInfo &ti);
+        auto read(const TraceInfoView &view, TraceInfo &ti) -> bool;
+        /// Decode the memory access columns and append them to result.
+        void readMemoryAccesses(const TraceInfoView &view, std::vector<MemoryAccess> &result);
+        /// Decode one of the stack frame size or stack difference maps, starting at the given
+        /// name length column.
+        auto readStringMap(
+            const TraceInfoView &view,
+            ColumnId lengthId,
+            std::unordered_map<std::string, std::uint32_t> &result) -> bool;
+    } // namespace binary
+
+    /// A read-only memory mapping of an entire file.
+    class MappedFile {
+        const uint8_t *data_{};
+        std::size_t size_{};
+
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+        auto open(const std::string &path) -> bool;
+        void close();
+
+        [[nodiscard]] auto data() const -> const uint8_t *
+        {
+            return data_;
+        }
+        [[nodiscard]] auto size() const -> std::size_t
+        {
+            return size_;
+        }
+    };
+
+    /// Load a trace info file, detecting whether it is stored as JSON, in the binary format or
+    /// as a journal.
+    auto loadTraceInfo(const std::string &path, TraceInfo &ti) -> bool;
+    auto saveTraceInfo(const std::string &path, const TraceInfo &ti, TraceInfoFormat format)
+        -> bool;
+} // namespace binrec
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef BINREC_TRACE_INFO_JOURNAL_HPP
+#define BINREC_TRACE_INFO_JOURNAL_HPP
+
+#include "binrec/tracing/trace_info.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace binrec {
+    /// Append-only log of the facts that tracing adds to a TraceInfo.
+    ///
+    /// A journal starts with a fixed header followed by batches of fixed size records. Each
+    /// batch is written with a single call, so a journal whose writer was killed ends in at most
+    /// one truncated batch, which is ignored on replay. Records only ever add to a trace info,
+    /// so replaying journals of several states yields the union of their traces.
+    namespace journal {
+        constexpr char magic[4] = {'B', 'R', 'T', 'J'};
+        constexpr uint32_t version = 1;
+
+        enum class RecordKind : uint8_t {
+            /// The entry at index first of FunctionLog::entries is the pc second. The first
+            /// record for an index wins.
+            Entry,
+            EntryToCaller,
+            EntryToReturn,
+            CallerToFollowUp,
+            EntryToTb,
+            Successor,
+        };
+
+        struct Record {
+            uint64_t first;
+            uint64_t second;
+            RecordKind kind;
+            uint8_t reserved[7];
+        };
+        static_assert(sizeof(Record) == 24);
+
+        auto isJournal(const uint8_t *data, std::size_t size) -> bool;
+        /// Add the records of every complete batch to ti.
+        auto replay(const uint8_t *data, std::size_t size, TraceInfo &ti) -> bool;
+    } // namespace journal
+
+    /// Buffers journal records and appends them to a file in batches.
+    class TraceInfoJournal {
+        int fd{-1};
+        std::size_t batchSize{defaultBatchSize};
+        std::vector<journal::Record> pending;
+
+        void add(journal::RecordKind kind, uint64_t first, uint64_t second);
+
+    public:
+        static constexpr const char *suffix = ".journal";
+        static constexpr std::size_t defaultBatchSize = 4096;
+        /// The journal shared by all plugins of an S2E process. It records nothing until it is
+        /// opened.
+        static auto get() -> std::shared_ptr<TraceInfoJournal>;
+
+        TraceInfoJournal() = default;
+        ~TraceInfoJournal();
+
+        TraceInfoJournal(const TraceInfoJournal &) = delete;
+        auto operator=(const TraceInfoJournal &) -> TraceInfoJournal & = delete;
+
+        /// Create or truncate the journal file and write its header.
+        auto open(const std::string &path, std::size_t batchSize = defaultBatchSize) -> bool;
+        /// Write the pending records and close the file.
+        auto close() -> bool;
+        /// Write the pending records as one batch.
+        auto flush() -> bool;
+
+        [[nodiscard]] auto isOpen() const -> bool
+        {
+            return fd >= 0;
+        }
+
+        void addEntry(std::size_t index, uint64_t pc);
+        void addEntryToCaller(uint64_t entry, uint64_t caller);
+        void addEntryToReturn(uint64_t entry, uint64_t returnPc);
+        void addCallerToFollowUp(uint64_t caller, uint64_t followUp);
+        void addEntryToTb(uint64_t entry, uint64_t tb);
+        void addSuccessor(uint64_t pc, uint64_t successor);
+    };
+} // namespace binrec
+
+#endif
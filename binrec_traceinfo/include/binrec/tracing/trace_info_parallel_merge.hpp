@@ -0,0 +1,22 @@
+#ifndef BINREC_TRACE_INFO_PARALLEL_MERGE_HPP
+#define BINREC_TRACE_INFO_PARALLEL_MERGE_HPP
+
+#include "trace_info.hpp"
+#include <string>
+#include <vector>
+
+namespace binrec {
+    /// Merge trace info files using up to the given number of threads.
+    ///
+    /// The inputs are parsed concurrently into sorted flat vectors. Neighbouring results are
+    /// then merged pairwise, level by level, in a balanced reduction tree. Each merge is a
+    /// linear set union, so duplicate memory accesses are dropped just like with
+    /// streamMergeTraceInfo. Stack frame sizes, stack differences and function entries are
+    /// merged in input order and match TraceInfo::add.
+    auto parallelMergeTraceInfo(
+        const std::vector<std::string> &paths,
+        unsigned jobs,
+        TraceInfo &result) -> bool;
+} // namespace binrec
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef BINREC_TRACE_INFO_STREAM_MERGE_HPP
+#define BINREC_TRACE_INFO_STREAM_MERGE_HPP
+
+#include "trace_info.hpp"
+#include <string>
+#include <vector>
+
+namespace binrec {
+    /// Merge trace info files with a single k-way merge over their sorted runs.
+    ///
+    /// Binary inputs are mapped and merged directly from their columns. JSON inputs are parsed
+    /// one at a time and spilled to a temporary binary run first. Unlike TraceInfo::add,
+    /// duplicate memory accesses are dropped and the merged memory accesses are sorted. Peak
+    /// memory is bounded by the size of the merged result rather than the sum of the inputs.
+    auto streamMergeTraceInfo(const std::vector<std::string> &paths, TraceInfo &result) -> bool;
+} // namespace binrec
+
+#endif
@@ -0,0 +1,45 @@
+#include "binrec/tracing/function_log_buffer.hpp"
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+using namespace binrec;
+
+auto FunctionLogBuffer::BlockEvent::operator<(const BlockEvent &other) const -> bool
+{
+    return std::tie(entry, pc, caller) < std::tie(other.entry, other.pc, other.caller);
+}
+
+FunctionLogBuffer::FunctionLogBuffer(std::size_t capacity) :
+        events(std::max<std::size_t>(capacity, 1))
+{
+}
+
+void FunctionLogBuffer::flush(FunctionLog &log, TraceInfoJournal &journal)
+{
+    auto first = events.begin();
+    auto last = first + static_cast<std::ptrdiff_t>(size);
+    std::sort(first, last);
+    last = std::unique(first, last);
+
+    // The events are grouped by entry, so the blocks of every function are looked up once and
+    // inserted in ascending order.
+    FlatSet<uint64_t> *tbs = nullptr;
+    uint32_t tbsEntry = 0;
+    for (auto it = first; it != last; ++it) {
+        if (!tbs || it->entry != tbsEntry) {
+            tbs = &log.entryToTbs[it->entry];
+            tbsEntry = it->entry;
+        }
+        if ((it == first || std::prev(it)->entry != it->entry || std::prev(it)->pc != it->pc) &&
+            tbs->insert(it->pc))
+        {
+            journal.addEntryToTb(it->entry, it->pc);
+        }
+        if (it->caller && log.callerToFollowUp.insert(std::make_pair(it->caller, it->pc))) {
+            journal.addCallerToFollowUp(it->caller, it->pc);
+        }
+    }
+
+    size = 0;
+}
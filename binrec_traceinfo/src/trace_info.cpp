@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <iterator>
 #include <nlohmann/json.hpp>
+#include <tuple>
 
 using namespace binrec;
 using nlohmann::json;
@@ -113,74 +114,6 @@ auto TraceInfo::get() -> std::shared_ptr<TraceInfo>
     return sptr;
 }
 
-// Create a deep copy of the current trace info
-auto TraceInfo::getCopy() -> TraceInfo *
-{
-    TraceInfo *tiCopy = new TraceInfo();
-
-    std::copy(
-        stackFrameSizes.begin(),
-        stackFrameSizes.end(),
-        std::inserter(tiCopy->stackFrameSizes, tiCopy->stackFrameSizes.begin()));
-    std::copy(
-        stackDifference.begin(),
-        stackDifference.end(),
-        std::inserter(tiCopy->stackDifference, tiCopy->stackDifference.begin()));
-    std::copy(
-        memoryAccesses.begin(),
-        memoryAccesses.end(),
-        std::inserter(tiCopy->memoryAccesses, tiCopy->memoryAccesses.begin()));
-    std::copy(
-        successors.begin(),
-        successors.end(),
-        std::inserter(tiCopy->successors, tiCopy->successors.begin()));
-    std::copy(
-        functionLog.entries.begin(),
-        functionLog.entries.end(),
-        std::inserter(tiCopy->functionLog.entries, tiCopy->functionLog.entries.begin()));
-    std::copy(
-        functionLog.entryToCaller.begin(),
-        functionLog.entryToCaller.end(),
-        std::inserter(
-            tiCopy->functionLog.entryToCaller,
-            tiCopy->functionLog.entryToCaller.begin()));
-    std::copy(
-        functionLog.entryToReturn.begin(),
-        functionLog.entryToReturn.end(),
-        std::inserter(
-            tiCopy->functionLog.entryToReturn,
-            tiCopy->functionLog.entryToReturn.begin()));
-    std::copy(
-        functionLog.callerToFollowUp.begin(),
-        functionLog.callerToFollowUp.end(),
-        std::inserter(
-            tiCopy->functionLog.callerToFollowUp,
-            tiCopy->functionLog.callerToFollowUp.begin()));
-    std::copy(
-        functionLog.entryToTbs.begin(),
-        functionLog.entryToTbs.end(),
-        std::inserter(tiCopy->functionLog.entryToTbs, tiCopy->functionLog.entryToTbs.begin()));
-
-    return tiCopy;
-}
-
-void TraceInfo::restoreFromCopy(TraceInfo *copyTi)
-{
-    stackFrameSizes.clear();
-    stackDifference.clear();
-    memoryAccesses.clear();
-    successors.clear();
-    functionLog.entries.clear();
-    functionLog.entryToCaller.clear();
-    functionLog.entryToReturn.clear();
-    functionLog.callerToFollowUp.clear();
-    functionLog.entryToTbs.clear();
-
-    add(*copyTi);
-
-    return;
-}
-
 void TraceInfo::add(const TraceInfo &ti)
 {
     for (auto &[function, size] : ti.stackFrameSizes) {
@@ -205,10 +138,7 @@ void TraceInfo::add(const TraceInfo &ti)
         ti.memoryAccesses.begin(),
         ti.memoryAccesses.end(),
         std::back_inserter(memoryAccesses));
-    std::copy(
-        ti.successors.begin(),
-        ti.successors.end(),
-        std::inserter(successors, successors.begin()));
+    successors.insert(ti.successors.begin(), ti.successors.end());
 
     if (functionLog.entries.empty()) {
         std::copy(
@@ -216,27 +146,44 @@ void TraceInfo::add(const TraceInfo &ti)
             ti.functionLog.entries.end(),
             std::back_inserter(functionLog.entries));
     }
-    std::copy(
+    functionLog.entryToCaller.insert(
         ti.functionLog.entryToCaller.begin(),
-        ti.functionLog.entryToCaller.end(),
-        std::inserter(functionLog.entryToCaller, functionLog.entryToCaller.begin()));
-    std::copy(
+        ti.functionLog.entryToCaller.end());
+    functionLog.entryToReturn.insert(
         ti.functionLog.entryToReturn.begin(),
-        ti.functionLog.entryToReturn.end(),
-        std::inserter(functionLog.entryToReturn, functionLog.entryToReturn.begin()));
-    std::copy(
+        ti.functionLog.entryToReturn.end());
+    functionLog.callerToFollowUp.insert(
         ti.functionLog.callerToFollowUp.begin(),
-        ti.functionLog.callerToFollowUp.end(),
-        std::inserter(functionLog.callerToFollowUp, functionLog.callerToFollowUp.begin()));
-    for (auto &entry : ti.functionLog.entryToTbs) {
-        auto targetEntry = functionLog.entryToTbs.insert({entry.first, {}});
-        std::copy(
-            entry.second.begin(),
-            entry.second.end(),
-            std::inserter(targetEntry.first->second, targetEntry.first->second.begin()));
+        ti.functionLog.callerToFollowUp.end());
+    for (auto &[entry, tbs] : ti.functionLog.entryToTbs) {
+        functionLog.entryToTbs[entry].insert(tbs.begin(), tbs.end());
     }
 }
 
+namespace {
+    auto memoryAccessKey(const MemoryAccess &ma)
+    {
+        return std::tie(
+            ma.pc,
+            ma.offset,
+            ma.size,
+            ma.fnBase,
+            ma.isWrite,
+            ma.isLocalAccess,
+            ma.isDirect);
+    }
+} // namespace
+
+auto MemoryAccess::operator<(const MemoryAccess &other) const -> bool
+{
+    return memoryAccessKey(*this) < memoryAccessKey(other);
+}
+
+auto MemoryAccess::operator==(const MemoryAccess &other) const -> bool
+{
+    return memoryAccessKey(*this) == memoryAccessKey(other);
+}
+
 auto Successor::operator<(const Successor &other) const -> bool
 {
     if (pc == other.pc) {
@@ -0,0 +1,553 @@
+#include "binrec/tracing/trace_info_binary.hpp"
+#include "binrec/tracing/trace_info_journal.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace binrec;
+using namespace binrec::binary;
+using nlohmann::json;
+
+namespace {
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t columnCount;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(FileHeader) == 16);
+
+    struct ColumnHeader {
+        uint64_t size;
+        uint8_t width;
+        uint8_t encoding;
+        uint8_t reserved[6];
+    };
+    static_assert(sizeof(ColumnHeader) == 16);
+
+    constexpr std::size_t columnAlignment = 8;
+
+    /// The encoding that write() uses for every column. The readers rely on it, for example
+    /// only the values of pairs are decoded with their keys, so a file that stores a column in
+    /// any other encoding is rejected.
+    constexpr Encoding columnEncodings[ColumnCount] = {
+        Encoding::Raw,        // Entries
+        Encoding::Delta,      // EntryToCallerEntry
+        Encoding::KeyedDelta, // EntryToCallerCaller
+        Encoding::Delta,      // EntryToReturnEntry
+        Encoding::KeyedDelta, // EntryToReturnReturn
+        Encoding::Delta,      // CallerToFollowUpCaller
+        Encoding::KeyedDelta, // CallerToFollowUpFollowUp
+        Encoding::Delta,      // EntryToTbsEntry
+        Encoding::KeyedDelta, // EntryToTbsTb
+        Encoding::Delta,      // SuccessorsPc
+        Encoding::KeyedDelta, // SuccessorsSuccessor
+        Encoding::Raw,        // MemoryAccessesPc
+        Encoding::ZigZag,     // MemoryAccessesOffset
+        Encoding::Raw,        // MemoryAccessesSize
+        Encoding::Raw,        // MemoryAccessesFnBase
+        Encoding::Raw,        // MemoryAccessesFlags
+        Encoding::Raw,        // StackFrameSizesNameLength
+        Encoding::Raw,        // StackFrameSizesNameBytes
+        Encoding::Raw,        // StackFrameSizesValue
+        Encoding::Raw,        // StackDifferenceNameLength
+        Encoding::Raw,        // StackDifferenceNameBytes
+        Encoding::Raw,        // StackDifferenceValue
+    };
+
+    auto paddingFor(std::size_t length) -> std::size_t
+    {
+        return (columnAlignment - length % columnAlignment) % columnAlignment;
+    }
+
+    auto widthFor(uint64_t maxValue) -> uint8_t
+    {
+        if (maxValue <= UINT8_MAX) {
+            return 1;
+        }
+        if (maxValue <= UINT16_MAX) {
+            return 2;
+        }
+        if (maxValue <= UINT32_MAX) {
+            return 4;
+        }
+        return 8;
+    }
+
+    /// Decode a stored value given the previously decoded value of the same column.
+    auto decodeValue(Encoding encoding, uint64_t stored, uint64_t previous, bool keyChanged)
+        -> uint64_t
+    {
+        switch (encoding) {
+        case Encoding::Raw:
+            return stored;
+        case Encoding::Delta:
+            return previous + stored;
+        case Encoding::KeyedDelta:
+            return (keyChanged ? 0 : previous) + stored;
+        case Encoding::ZigZag:
+            return (stored >> 1U) ^ -(stored & 1U);
+        }
+        return stored;
+    }
+
+    auto encode(
+        const std::vector<uint64_t> &values,
+        Encoding encoding,
+        const std::vector<uint64_t> *keys) -> std::vector<uint64_t>
+    {
+        std::vector<uint64_t> stored;
+        stored.reserve(values.size());
+
+        uint64_t previous = 0;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            uint64_t value = values[i];
+            switch (encoding) {
+            case Encoding::Raw:
+                stored.push_back(value);
+                break;
+            case Encoding::Delta:
+                stored.push_back(value - previous);
+                previous = value;
+                break;
+            case Encoding::KeyedDelta:
+                if (i == 0 || (*keys)[i] != (*keys)[i - 1]) {
+                    previous = 0;
+                }
+                stored.push_back(value - previous);
+                previous = value;
+                break;
+            case Encoding::ZigZag:
+                stored.push_back(
+                    (value << 1U) ^ static_cast<uint64_t>(static_cast<int64_t>(value) >> 63));
+                break;
+            }
+        }
+
+        return stored;
+    }
+
+    void writeColumn(
+        std::ostream &os,
+        const std::vector<uint64_t> &values,
+        Encoding encoding,
+        const std::vector<uint64_t> *keys = nullptr)
+    {
+        std::vector<uint64_t> stored = encode(values, encoding, keys);
+        uint64_t maxValue = 0;
+        for (uint64_t value : stored) {
+            maxValue = std::max(maxValue, value);
+        }
+
+        ColumnHeader header{};
+        header.size = stored.size();
+        header.width = widthFor(maxValue);
+        header.encoding = static_cast<uint8_t>(encoding);
+        os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        // The format is little endian, which is also the byte order of every host binrec
+        // supports, so the low bytes of each value can be copied directly.
+        std::vector<char> packed(stored.size() * header.width);
+        for (std::size_t i = 0; i < stored.size(); ++i) {
+            std::memcpy(&packed[i * header.width], &stored[i], header.width);
+        }
+        os.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+
+        static const char zeros[columnAlignment] = {};
+        os.write(zeros, static_cast<std::streamsize>(paddingFor(packed.size())));
+    }
+
+    template <typename Pairs>
+    void writePairColumns(std::ostream &os, const Pairs &pairs)
+    {
+        std::vector<uint64_t> first;
+        std::vector<uint64_t> second;
+        first.reserve(pairs.size());
+        second.reserve(pairs.size());
+        for (const auto &[key, value] : pairs) {
+            first.push_back(key);
+            second.push_back(value);
+        }
+        writeColumn(os, first, Encoding::Delta);
+        writeColumn(os, second, Encoding::KeyedDelta, &first);
+    }
+
+    void writeStringMapColumns(
+        std::ostream &os,
+        const std::unordered_map<std::string, std::uint32_t> &values)
+    {
+        std::vector<uint64_t> lengths;
+        std::vector<uint64_t> bytes;
+        std::vector<uint64_t> numbers;
+        for (const auto &[name, value] : values) {
+            lengths.push_back(name.size());
+            for (unsigned char c : name) {
+                bytes.push_back(c);
+            }
+            numbers.push_back(value);
+        }
+        writeColumn(os, lengths, Encoding::Raw);
+        writeColumn(os, bytes, Encoding::Raw);
+        writeColumn(os, numbers, Encoding::Raw);
+    }
+
+    auto decodePairs(const TraceInfoView &view, ColumnId keyId, ColumnId valueId)
+        -> AddressPairSet
+    {
+        std::vector<uint64_t> keys = view.column(keyId).decode();
+        std::vector<uint64_t> values = view.column(valueId).decode(&keys);
+
+        std::vector<std::pair<uint64_t, uint64_t>> pairs;
+        pairs.reserve(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            pairs.emplace_back(keys[i], values[i]);
+        }
+
+        AddressPairSet result;
+        result.assign(std::move(pairs));
+        return result;
+    }
+} // namespace
+
+void binary::readMemoryAccesses(const TraceInfoView &view, std::vector<MemoryAccess> &result)
+{
+    const Column &pcs = view.column(MemoryAccessesPc);
+    std::vector<uint64_t> offsets = view.column(MemoryAccessesOffset).decode();
+    const Column &sizes = view.column(MemoryAccessesSize);
+    const Column &fnBases = view.column(MemoryAccessesFnBase);
+    const Column &flagsColumn = view.column(MemoryAccessesFlags);
+
+    result.reserve(result.size() + pcs.size);
+    for (uint64_t i = 0; i < pcs.size; ++i) {
+        uint64_t flags = flagsColumn.stored(i);
+        result.push_back(MemoryAccess{
+            pcs.stored(i),
+            static_cast<int64_t>(offsets[i]),
+            (flags & IsWrite) != 0,
+            (flags & IsLocalAccess) != 0,
+            sizes.stored(i),
+            (flags & IsDirect) != 0,
+            fnBases.stored(i)});
+    }
+}
+
+auto binary::readStringMap(
+    const TraceInfoView &view,
+    ColumnId lengthId,
+    std::unordered_map<std::string, std::uint32_t> &result) -> bool
+{
+    const Column &lengths = view.column(lengthId);
+    const Column &bytes = view.column(static_cast<ColumnId>(lengthId + 1));
+    const Column &values = view.column(static_cast<ColumnId>(lengthId + 2));
+    if (lengths.size != values.size || bytes.width != 1) {
+        return false;
+    }
+
+    uint64_t offset = 0;
+    for (uint64_t i = 0; i < lengths.size; ++i) {
+        uint64_t length = lengths.stored(i);
+        if (length > bytes.size - offset) {
+            return false;
+        }
+        std::string name{reinterpret_cast<const char *>(bytes.data + offset), length};
+        result.emplace(std::move(name), values.stored(i));
+        offset += length;
+    }
+    return offset == bytes.size;
+}
+
+auto binrec::parseTraceInfoFormat(const std::string &name, TraceInfoFormat &format) -> bool
+{
+    if (name == "json") {
+        format = TraceInfoFormat::Json;
+        return true;
+    }
+    if (name == "binary") {
+        format = TraceInfoFormat::Binary;
+        return true;
+    }
+    return false;
+}
+
+auto binrec::traceInfoSuffix(TraceInfoFormat format) -> const char *
+{
+    return format == TraceInfoFormat::Binary ? TraceInfo::binarySuffix : TraceInfo::defaultSuffix;
+}
+
+auto Column::stored(uint64_t index) const -> uint64_t
+{
+    uint64_t value = 0;
+    std::memcpy(&value, data + index * width, width);
+    return value;
+}
+
+auto Column::decode(const std::vector<uint64_t> *keys) const -> std::vector<uint64_t>
+{
+    std::vector<uint64_t> values;
+    values.reserve(size);
+
+    uint64_t previous = 0;
+    for (uint64_t i = 0; i < size; ++i) {
+        bool keyChanged = encoding == Encoding::KeyedDelta &&
+            (i == 0 || (*keys)[i] != (*keys)[i - 1]);
+        previous = decodeValue(encoding, stored(i), previous, keyChanged);
+        values.push_back(previous);
+    }
+
+    return values;
+}
+
+PairCursor::PairCursor(const Column &keys, const Column &values) : keys{&keys}, values{&values}
+{
+    if (valid()) {
+        decodeCurrent(true);
+    }
+}
+
+void PairCursor::decodeCurrent(bool first)
+{
+    uint64_t key = decodeValue(keys->encoding, keys->stored(index), current_.first, false);
+    bool keyChanged = first || key != current_.first;
+    current_.second =
+        decodeValue(values->encoding, values->stored(index), current_.second, keyChanged);
+    current_.first = key;
+}
+
+void PairCursor::next()
+{
+    ++index;
+    if (valid()) {
+        decodeCurrent(false);
+    }
+}
+
+auto TraceInfoView::open(const uint8_t *data, std::size_t size) -> bool
+{
+    if (!isBinary(data, size) || size < sizeof(FileHeader)) {
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != version || header.columnCount != ColumnCount) {
+        return false;
+    }
+
+    std::size_t offset = sizeof(FileHeader);
+    for (uint32_t id = 0; id < ColumnCount; ++id) {
+        Column &column = columns[id];
+        if (size - offset < sizeof(ColumnHeader)) {
+            return false;
+        }
+
+        ColumnHeader columnHeader{};
+        std::memcpy(&columnHeader, data + offset, sizeof(columnHeader));
+        offset += sizeof(ColumnHeader);
+
+        uint8_t width = columnHeader.width;
+        if ((width != 1 && width != 2 && width != 4 && width != 8) ||
+            columnHeader.encoding != static_cast<uint8_t>(columnEncodings[id]) ||
+            columnHeader.size > (size - offset) / width)
+        {
+            return false;
+        }
+
+        column.size = columnHeader.size;
+        column.width = width;
+        column.encoding = static_cast<Encoding>(columnHeader.encoding);
+        column.data = data + offset;
+
+        std::size_t length = column.size * width;
+        offset += length;
+        offset += std::min(paddingFor(length), size - offset);
+    }
+
+    static constexpr std::pair<ColumnId, ColumnId> parallelColumns[] = {
+        {EntryToCallerEntry, EntryToCallerCaller},
+        {EntryToReturnEntry, EntryToReturnReturn},
+        {CallerToFollowUpCaller, CallerToFollowUpFollowUp},
+        {EntryToTbsEntry, EntryToTbsTb},
+        {SuccessorsPc, SuccessorsSuccessor},
+        {MemoryAccessesPc, MemoryAccessesOffset},
+        {MemoryAccessesPc, MemoryAccessesSize},
+        {MemoryAccessesPc, MemoryAccessesFnBase},
+        {MemoryAccessesPc, MemoryAccessesFlags}};
+    for (auto [keyId, valueId] : parallelColumns) {
+        if (columns[keyId].size != columns[valueId].size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto TraceInfoView::column(ColumnId id) const -> const Column &
+{
+    return columns[id];
+}
+
+auto binary::isBinary(const uint8_t *data, std::size_t size) -> bool
+{
+    return size >= sizeof(magic) && std::memcmp(data, magic, sizeof(magic)) == 0;
+}
+
+void binary::write(std::ostream &os, const TraceInfo &ti)
+{
+    FileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.columnCount = ColumnCount;
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    writeColumn(os, ti.functionLog.entries, Encoding::Raw);
+    writePairColumns(os, ti.functionLog.entryToCaller);
+    writePairColumns(os, ti.functionLog.entryToReturn);
+    writePairColumns(os, ti.functionLog.callerToFollowUp);
+
+    std::vector<std::pair<uint64_t, uint64_t>> entryToTbs;
+    for (const auto &[entry, tbs] : ti.functionLog.entryToTbs) {
+        for (uint64_t tb : tbs) {
+            entryToTbs.emplace_back(entry, tb);
+        }
+    }
+    writePairColumns(os, entryToTbs);
+
+    std::vector<std::pair<uint64_t, uint64_t>> successors;
+    successors.reserve(ti.successors.size());
+    for (const Successor &successor : ti.successors) {
+        successors.emplace_back(successor.pc, successor.successor);
+    }
+    writePairColumns(os, successors);
+
+    std::vector<uint64_t> pcs;
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> sizes;
+    std::vector<uint64_t> fnBases;
+    std::vector<uint64_t> flags;
+    for (const MemoryAccess &ma : ti.memoryAccesses) {
+        pcs.push_back(ma.pc);
+        offsets.push_back(static_cast<uint64_t>(ma.offset));
+        sizes.push_back(ma.size);
+        fnBases.push_back(ma.fnBase);
+        flags.push_back(
+            (ma.isWrite ? IsWrite : 0U) | (ma.isLocalAccess ? IsLocalAccess : 0U) |
+            (ma.isDirect ? IsDirect : 0U));
+    }
+    writeColumn(os, pcs, Encoding::Raw);
+    writeColumn(os, offsets, Encoding::ZigZag);
+    writeColumn(os, sizes, Encoding::Raw);
+    writeColumn(os, fnBases, Encoding::Raw);
+    writeColumn(os, flags, Encoding::Raw);
+
+    writeStringMapColumns(os, ti.stackFrameSizes);
+    writeStringMapColumns(os, ti.stackDifference);
+}
+
+auto binary::read(const TraceInfoView &view, TraceInfo &ti) -> bool
+{
+    ti = TraceInfo{};
+
+    ti.functionLog.entries = view.column(Entries).decode();
+    ti.functionLog.entryToCaller = decodePairs(view, EntryToCallerEntry, EntryToCallerCaller);
+    ti.functionLog.entryToReturn = decodePairs(view, EntryToReturnEntry, EntryToReturnReturn);
+    ti.functionLog.callerToFollowUp =
+        decodePairs(view, CallerToFollowUpCaller, CallerToFollowUpFollowUp);
+
+    for (const auto &[entry, tb] : decodePairs(view, EntryToTbsEntry, EntryToTbsTb)) {
+        auto &entryToTbs = ti.functionLog.entryToTbs;
+        auto &tbs = entryToTbs.emplace_hint(entryToTbs.end(), entry)->second;
+        tbs.insert(tb);
+    }
+
+    for (const auto &[pc, successor] : decodePairs(view, SuccessorsPc, SuccessorsSuccessor)) {
+        ti.successors.insert(Successor{pc, successor});
+    }
+
+    readMemoryAccesses(view, ti.memoryAccesses);
+
+    return readStringMap(view, StackFrameSizesNameLength, ti.stackFrameSizes) &&
+        readStringMap(view, StackDifferenceNameLength, ti.stackDifference);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+auto MappedFile::open(const std::string &path) -> bool
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st {};
+    bool good = fstat(fd, &st) == 0;
+    if (good && st.st_size > 0) {
+        void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            good = false;
+        } else {
+            data_ = static_cast<const uint8_t *>(mapping);
+            size_ = st.st_size;
+        }
+    }
+
+    ::close(fd);
+    return good;
+}
+
+void MappedFile::close()
+{
+    if (data_) {
+        munmap(const_cast<uint8_t *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+auto binrec::loadTraceInfo(const std::string &path, TraceInfo &ti) -> bool
+{
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    if (binary::isBinary(file.data(), file.size())) {
+        binary::TraceInfoView view;
+        return view.open(file.data(), file.size()) && binary::read(view, ti);
+    }
+    if (journal::isJournal(file.data(), file.size())) {
+        ti = TraceInfo{};
+        return journal::replay(file.data(), file.size(), ti);
+    }
+
+    json j = json::parse(file.data(), file.data() + file.size(), nullptr, false);
+    if (j.is_discarded()) {
+        return false;
+    }
+    ti = j.get<TraceInfo>();
+    return true;
+}
+
+auto binrec::saveTraceInfo(const std::string &path, const TraceInfo &ti, TraceInfoFormat format)
+    -> bool
+{
+    std::ofstream os{path, std::ios::out | std::ios::trunc | std::ios::binary};
+    if (!os) {
+        return false;
+    }
+
+    if (format == TraceInfoFormat::Binary) {
+        binary::write(os, ti);
+    } else {
+        os << ti;
+    }
+    return os.good();
+}
@@ -0,0 +1,251 @@
+#include "binrec/tracing/trace_info_journal.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace binrec;
+using namespace binrec::journal;
+
+namespace {
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+    };
+    static_assert(sizeof(FileHeader) == 8);
+
+    struct BatchHeader {
+        uint32_t recordCount;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(BatchHeader) == 8);
+
+    auto writeAll(int fd, const void *data, std::size_t size) -> bool
+    {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        while (size > 0) {
+            ssize_t written = ::write(fd, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    using Pairs = std::vector<std::pair<uint64_t, uint64_t>>;
+
+    void addEntry(std::vector<uint64_t> &entries, uint64_t index, uint64_t pc)
+    {
+        if (index >= entries.size()) {
+            entries.resize(index + 1);
+        }
+        if (!entries[index]) {
+            entries[index] = pc;
+        }
+    }
+
+    void addEntryToTbs(FlatMap<uint64_t, FlatSet<uint64_t>> &entryToTbs, Pairs &pairs)
+    {
+        std::sort(pairs.begin(), pairs.end());
+        for (const auto &[entry, tb] : pairs) {
+            entryToTbs[entry].insert(tb);
+        }
+    }
+
+    void addSuccessors(FlatSet<Successor> &successors, const Pairs &pairs)
+    {
+        std::vector<Successor> values;
+        values.reserve(pairs.size());
+        for (const auto &[pc, successor] : pairs) {
+            values.push_back(Successor{pc, successor});
+        }
+        successors.insert(values.begin(), values.end());
+    }
+} // namespace
+
+auto journal::isJournal(const uint8_t *data, std::size_t size) -> bool
+{
+    return size >= sizeof(FileHeader) && std::memcmp(data, magic, sizeof(magic)) == 0;
+}
+
+auto journal::replay(const uint8_t *data, std::size_t size, TraceInfo &ti) -> bool
+{
+    FileHeader header{};
+    if (!isJournal(data, size)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != version) {
+        return false;
+    }
+
+    // Records are gathered per member first, so every set is sorted once.
+    Pairs entryToCaller;
+    Pairs entryToReturn;
+    Pairs callerToFollowUp;
+    Pairs entryToTbs;
+    Pairs successors;
+
+    std::size_t offset = sizeof(FileHeader);
+    while (size - offset >= sizeof(BatchHeader)) {
+        BatchHeader batch{};
+        std::memcpy(&batch, data + offset, sizeof(batch));
+        std::size_t batchSize = sizeof(BatchHeader) + batch.recordCount * sizeof(Record);
+        if (size - offset < batchSize) {
+            // The writer was interrupted while appending this batch.
+            break;
+        }
+
+        const uint8_t *records = data + offset + sizeof(BatchHeader);
+        for (uint32_t i = 0; i < batch.recordCount; ++i) {
+            Record record{};
+            std::memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+            std::pair<uint64_t, uint64_t> pair{record.first, record.second};
+            switch (record.kind) {
+            case RecordKind::Entry:
+                addEntry(ti.functionLog.entries, record.first, record.second);
+                break;
+            case RecordKind::EntryToCaller:
+                entryToCaller.push_back(pair);
+                break;
+            case RecordKind::EntryToReturn:
+                entryToReturn.push_back(pair);
+                break;
+            case RecordKind::CallerToFollowUp:
+                callerToFollowUp.push_back(pair);
+                break;
+            case RecordKind::EntryToTb:
+                entryToTbs.push_back(pair);
+                break;
+            case RecordKind::Successor:
+                successors.push_back(pair);
+                break;
+            default:
+                return false;
+            }
+        }
+        offset += batchSize;
+    }
+
+    FunctionLog &fl = ti.functionLog;
+    fl.entryToCaller.insert(entryToCaller.begin(), entryToCaller.end());
+    fl.entryToReturn.insert(entryToReturn.begin(), entryToReturn.end());
+    fl.callerToFollowUp.insert(callerToFollowUp.begin(), callerToFollowUp.end());
+    addEntryToTbs(fl.entryToTbs, entryToTbs);
+    addSuccessors(ti.successors, successors);
+    return true;
+}
+
+namespace {
+    std::weak_ptr<TraceInfoJournal> ptr;
+} // namespace
+
+auto TraceInfoJournal::get() -> std::shared_ptr<TraceInfoJournal>
+{
+    std::shared_ptr<TraceInfoJournal> sptr = ptr.lock();
+    if (!sptr) {
+        sptr = std::make_shared<TraceInfoJournal>();
+        ptr = sptr;
+    }
+    return sptr;
+}
+
+TraceInfoJournal::~TraceInfoJournal()
+{
+    close();
+}
+
+auto TraceInfoJournal::open(const std::string &path, std::size_t batchSize) -> bool
+{
+    close();
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    this->batchSize = std::max<std::size_t>(batchSize, 1);
+    pending.reserve(this->batchSize);
+
+    FileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    if (!writeAll(fd, &header, sizeof(header))) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+auto TraceInfoJournal::close() -> bool
+{
+    if (!isOpen()) {
+        return true;
+    }
+    bool good = flush();
+    good = ::close(fd) == 0 && good;
+    fd = -1;
+    return good;
+}
+
+auto TraceInfoJournal::flush() -> bool
+{
+    if (!isOpen() || pending.empty()) {
+        return true;
+    }
+
+    std::vector<uint8_t> buffer(sizeof(BatchHeader) + pending.size() * sizeof(Record));
+    BatchHeader batch{static_cast<uint32_t>(pending.size()), 0};
+    std::memcpy(buffer.data(), &batch, sizeof(batch));
+    std::memcpy(buffer.data() + sizeof(batch), pending.data(), pending.size() * sizeof(Record));
+    pending.clear();
+
+    return writeAll(fd, buffer.data(), buffer.size());
+}
+
+void TraceInfoJournal::add(RecordKind kind, uint64_t first, uint64_t second)
+{
+    if (!isOpen()) {
+        return;
+    }
+    pending.push_back(Record{first, second, kind, {}});
+    if (pending.size() >= batchSize) {
+        flush();
+    }
+}
+
+void TraceInfoJournal::addEntry(std::size_t index, uint64_t pc)
+{
+    add(RecordKind::Entry, index, pc);
+}
+
+void TraceInfoJournal::addEntryToCaller(uint64_t entry, uint64_t caller)
+{
+    add(RecordKind::EntryToCaller, entry, caller);
+}
+
+void TraceInfoJournal::addEntryToReturn(uint64_t entry, uint64_t returnPc)
+{
+    add(RecordKind::EntryToReturn, entry, returnPc);
+}
+
+void TraceInfoJournal::addCallerToFollowUp(uint64_t caller, uint64_t followUp)
+{
+    add(RecordKind::CallerToFollowUp, caller, followUp);
+}
+
+void TraceInfoJournal::addEntryToTb(uint64_t entry, uint64_t tb)
+{
+    add(RecordKind::EntryToTb, entry, tb);
+}
+
+void TraceInfoJournal::addSuccessor(uint64_t pc, uint64_t successor)
+{
+    add(RecordKind::Successor, pc, successor);
+}
@@ -0,0 +1,207 @@
+#include "binrec/tracing/trace_info_parallel_merge.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+using namespace binrec;
+using namespace binrec::binary;
+
+namespace {
+    using Pairs = std::vector<std::pair<uint64_t, uint64_t>>;
+
+    /// A trace info whose sorted members are stored as sorted vectors without duplicates.
+    struct FlatTraceInfo {
+        std::vector<uint64_t> entries;
+        Pairs entryToCaller;
+        Pairs entryToReturn;
+        Pairs callerToFollowUp;
+        Pairs entryToTbs;
+        Pairs successors;
+        std::vector<MemoryAccess> memoryAccesses;
+        /// Only the stack frame sizes and stack differences are used.
+        TraceInfo stack;
+    };
+
+    auto decodePairs(const TraceInfoView &view, ColumnId keyId, ColumnId valueId) -> Pairs
+    {
+        Pairs result;
+        result.reserve(view.column(keyId).size);
+        for (PairCursor cursor{view.column(keyId), view.column(valueId)}; cursor.valid();
+             cursor.next())
+        {
+            result.push_back(cursor.current());
+        }
+        return result;
+    }
+
+    void sortUnique(std::vector<MemoryAccess> &accesses)
+    {
+        std::sort(accesses.begin(), accesses.end());
+        accesses.erase(std::unique(accesses.begin(), accesses.end()), accesses.end());
+    }
+
+    auto loadBinary(const TraceInfoView &view, FlatTraceInfo &flat) -> bool
+    {
+        flat.entries = view.column(Entries).decode();
+        flat.entryToCaller = decodePairs(view, EntryToCallerEntry, EntryToCallerCaller);
+        flat.entryToReturn = decodePairs(view, EntryToReturnEntry, EntryToReturnReturn);
+        flat.callerToFollowUp = decodePairs(view, CallerToFollowUpCaller, CallerToFollowUpFollowUp);
+        flat.entryToTbs = decodePairs(view, EntryToTbsEntry, EntryToTbsTb);
+        flat.successors = decodePairs(view, SuccessorsPc, SuccessorsSuccessor);
+        readMemoryAccesses(view, flat.memoryAccesses);
+        sortUnique(flat.memoryAccesses);
+
+        return readStringMap(view, StackFrameSizesNameLength, flat.stack.stackFrameSizes) &&
+            readStringMap(view, StackDifferenceNameLength, flat.stack.stackDifference);
+    }
+
+    void flatten(TraceInfo &ti, FlatTraceInfo &flat)
+    {
+        FunctionLog &fl = ti.functionLog;
+        flat.entries = std::move(fl.entries);
+        flat.entryToCaller = fl.entryToCaller.values();
+        flat.entryToReturn = fl.entryToReturn.values();
+        flat.callerToFollowUp = fl.callerToFollowUp.values();
+        for (const auto &[entry, tbs] : fl.entryToTbs) {
+            for (uint64_t tb : tbs) {
+                flat.entryToTbs.emplace_back(entry, tb);
+            }
+        }
+
+        flat.successors.reserve(ti.successors.size());
+        for (const Successor &successor : ti.successors) {
+            flat.successors.emplace_back(successor.pc, successor.successor);
+        }
+
+        flat.memoryAccesses = std::move(ti.memoryAccesses);
+        sortUnique(flat.memoryAccesses);
+
+        flat.stack.stackFrameSizes = std::move(ti.stackFrameSizes);
+        flat.stack.stackDifference = std::move(ti.stackDifference);
+    }
+
+    auto load(const std::string &path, FlatTraceInfo &flat) -> bool
+    {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        if (isBinary(file.data(), file.size())) {
+            TraceInfoView view;
+            return view.open(file.data(), file.size()) && loadBinary(view, flat);
+        }
+        file.close();
+
+        TraceInfo ti;
+        if (!loadTraceInfo(path, ti)) {
+            return false;
+        }
+        flatten(ti, flat);
+        return true;
+    }
+
+    template <typename T> void unite(std::vector<T> &lhs, const std::vector<T> &rhs)
+    {
+        std::vector<T> result;
+        result.reserve(lhs.size() + rhs.size());
+        std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result));
+        lhs = std::move(result);
+    }
+
+    /// Merge rhs into lhs, where rhs follows lhs in input order, and release rhs.
+    void mergeInto(FlatTraceInfo &lhs, FlatTraceInfo &rhs)
+    {
+        if (lhs.entries.empty()) {
+            lhs.entries = std::move(rhs.entries);
+        }
+        unite(lhs.entryToCaller, rhs.entryToCaller);
+        unite(lhs.entryToReturn, rhs.entryToReturn);
+        unite(lhs.callerToFollowUp, rhs.callerToFollowUp);
+        unite(lhs.entryToTbs, rhs.entryToTbs);
+        unite(lhs.successors, rhs.successors);
+        unite(lhs.memoryAccesses, rhs.memoryAccesses);
+        lhs.stack.add(rhs.stack);
+
+        rhs = FlatTraceInfo{};
+    }
+
+    void unflatten(FlatTraceInfo &flat, TraceInfo &ti)
+    {
+        FunctionLog &fl = ti.functionLog;
+        fl.entries = std::move(flat.entries);
+        fl.entryToCaller.assign(std::move(flat.entryToCaller));
+        fl.entryToReturn.assign(std::move(flat.entryToReturn));
+        fl.callerToFollowUp.assign(std::move(flat.callerToFollowUp));
+        auto &entryToTbs = fl.entryToTbs;
+        for (const auto &[entry, tb] : flat.entryToTbs) {
+            entryToTbs.emplace_hint(entryToTbs.end(), entry)->second.insert(tb);
+        }
+
+        std::vector<Successor> successors;
+        successors.reserve(flat.successors.size());
+        for (const auto &[pc, successor] : flat.successors) {
+            successors.push_back(Successor{pc, successor});
+        }
+        ti.successors.assign(std::move(successors));
+
+        ti.memoryAccesses = std::move(flat.memoryAccesses);
+        ti.stackFrameSizes = std::move(flat.stack.stackFrameSizes);
+        ti.stackDifference = std::move(flat.stack.stackDifference);
+    }
+
+    /// Call fn for every index in [0, count) using up to the given number of threads.
+    template <typename Fn> void parallelFor(std::size_t count, unsigned jobs, Fn fn)
+    {
+        std::atomic<std::size_t> next{0};
+        auto worker = [&next, count, &fn]() {
+            for (std::size_t i = next++; i < count; i = next++) {
+                fn(i);
+            }
+        };
+
+        std::size_t threadCount = std::min<std::size_t>(std::max(jobs, 1U), count);
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+} // namespace
+
+auto binrec::parallelMergeTraceInfo(
+    const std::vector<std::string> &paths,
+    unsigned jobs,
+    TraceInfo &result) -> bool
+{
+    std::vector<FlatTraceInfo> runs(paths.size());
+    std::vector<char> loaded(paths.size());
+    parallelFor(paths.size(), jobs, [&paths, &runs, &loaded](std::size_t i) {
+        loaded[i] = load(paths[i], runs[i]);
+    });
+    if (std::find(loaded.begin(), loaded.end(), 0) != loaded.end()) {
+        return false;
+    }
+
+    // Each level merges every run into its left neighbour at the current stride, so the tree
+    // stays balanced and the input order is kept for the members where order matters.
+    for (std::size_t stride = 1; stride < runs.size(); stride *= 2) {
+        std::size_t merges = (runs.size() + 2 * stride - 1) / (2 * stride);
+        parallelFor(merges, jobs, [&runs, stride](std::size_t i) {
+            std::size_t lhs = i * 2 * stride;
+            if (lhs + stride < runs.size()) {
+                mergeInto(runs[lhs], runs[lhs + stride]);
+            }
+        });
+    }
+
+    result = TraceInfo{};
+    if (!runs.empty()) {
+        unflatten(runs.front(), result);
+    }
+    return true;
+}
@@ -0,0 +1,176 @@
+#include "binrec/tracing/trace_info_stream_merge.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <queue>
+#include <unistd.h>
+
+using namespace binrec;
+using namespace binrec::binary;
+
+namespace {
+    /// A mapped binary trace info of one input.
+    struct Run {
+        MappedFile file;
+        TraceInfoView view;
+    };
+
+    /// Map a binary input as is. JSON inputs are parsed and written to a temporary binary
+    /// file, which is unlinked as soon as it is mapped.
+    auto openRun(const std::string &path, Run &run) -> bool
+    {
+        if (!run.file.open(path)) {
+            return false;
+        }
+        if (isBinary(run.file.data(), run.file.size())) {
+            return run.view.open(run.file.data(), run.file.size());
+        }
+        run.file.close();
+
+        TraceInfo ti;
+        if (!loadTraceInfo(path, ti)) {
+            return false;
+        }
+
+        const char *tmpdir = std::getenv("TMPDIR");
+        std::string tempPath = std::string{tmpdir ? tmpdir : "/tmp"} + "/binrec-run-XXXXXX";
+        int fd = mkstemp(tempPath.data());
+        if (fd < 0) {
+            return false;
+        }
+        close(fd);
+
+        bool good = saveTraceInfo(tempPath, ti, TraceInfoFormat::Binary) &&
+            run.file.open(tempPath);
+        unlink(tempPath.c_str());
+
+        return good && run.view.open(run.file.data(), run.file.size());
+    }
+
+    /// Merge the sorted runs of a pair of columns across all inputs, calling emit once for
+    /// every distinct pair in ascending order.
+    template <typename Emit>
+    void mergePairs(
+        const std::vector<std::unique_ptr<Run>> &runs,
+        ColumnId keyId,
+        ColumnId valueId,
+        Emit emit)
+    {
+        std::vector<PairCursor> cursors;
+        cursors.reserve(runs.size());
+        for (const auto &run : runs) {
+            cursors.emplace_back(run->view.column(keyId), run->view.column(valueId));
+        }
+
+        auto greater = [&cursors](std::size_t lhs, std::size_t rhs) {
+            return cursors[rhs].current() < cursors[lhs].current();
+        };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heap{
+            greater};
+        for (std::size_t i = 0; i < cursors.size(); ++i) {
+            if (cursors[i].valid()) {
+                heap.push(i);
+            }
+        }
+
+        bool first = true;
+        std::pair<uint64_t, uint64_t> last{};
+        while (!heap.empty()) {
+            std::size_t i = heap.top();
+            heap.pop();
+
+            if (first || cursors[i].current() != last) {
+                last = cursors[i].current();
+                first = false;
+                emit(last);
+            }
+
+            cursors[i].next();
+            if (cursors[i].valid()) {
+                heap.push(i);
+            }
+        }
+    }
+
+    template <typename Pairs>
+    void mergePairsInto(
+        const std::vector<std::unique_ptr<Run>> &runs,
+        ColumnId keyId,
+        ColumnId valueId,
+        Pairs &result)
+    {
+        mergePairs(runs, keyId, valueId, [&result](const std::pair<uint64_t, uint64_t> &pair) {
+            result.insert(pair);
+        });
+    }
+
+    void sortUnique(std::vector<MemoryAccess> &accesses)
+    {
+        std::sort(accesses.begin(), accesses.end());
+        accesses.erase(std::unique(accesses.begin(), accesses.end()), accesses.end());
+    }
+} // namespace
+
+auto binrec::streamMergeTraceInfo(const std::vector<std::string> &paths, TraceInfo &result)
+    -> bool
+{
+    std::vector<std::unique_ptr<Run>> runs;
+    runs.reserve(paths.size());
+    for (const std::string &path : paths) {
+        auto run = std::make_unique<Run>();
+        if (!openRun(path, *run)) {
+            return false;
+        }
+        runs.push_back(std::move(run));
+    }
+
+    result = TraceInfo{};
+    FunctionLog &fl = result.functionLog;
+
+    for (const auto &run : runs) {
+        const Column &entries = run->view.column(Entries);
+        if (entries.size > 0) {
+            fl.entries = entries.decode();
+            break;
+        }
+    }
+
+    mergePairsInto(runs, EntryToCallerEntry, EntryToCallerCaller, fl.entryToCaller);
+    mergePairsInto(runs, EntryToReturnEntry, EntryToReturnReturn, fl.entryToReturn);
+    mergePairsInto(runs, CallerToFollowUpCaller, CallerToFollowUpFollowUp, fl.callerToFollowUp);
+
+    auto &entryToTbs = fl.entryToTbs;
+    mergePairs(runs, EntryToTbsEntry, EntryToTbsTb, [&entryToTbs](const auto &pair) {
+        entryToTbs.emplace_hint(entryToTbs.end(), pair.first)->second.insert(pair.second);
+    });
+
+    mergePairs(runs, SuccessorsPc, SuccessorsSuccessor, [&result](const auto &pair) {
+        result.successors.insert(Successor{pair.first, pair.second});
+    });
+
+    // Memory accesses are not stored sorted, so deduplicate them whenever the buffer has grown
+    // to twice its last deduplicated size. This keeps the buffer within a constant factor of
+    // the merged result.
+    std::size_t compactedSize = 0;
+    for (const auto &run : runs) {
+        readMemoryAccesses(run->view, result.memoryAccesses);
+        if (result.memoryAccesses.size() > 2 * compactedSize) {
+            sortUnique(result.memoryAccesses);
+            compactedSize = result.memoryAccesses.size();
+        }
+    }
+    sortUnique(result.memoryAccesses);
+
+    for (const auto &run : runs) {
+        TraceInfo stack;
+        if (!readStringMap(run->view, StackFrameSizesNameLength, stack.stackFrameSizes) ||
+            !readStringMap(run->view, StackDifferenceNameLength, stack.stackDifference))
+        {
+            return false;
+        }
+        result.add(stack);
+    }
+
+    return true;
+}
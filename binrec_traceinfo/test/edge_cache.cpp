@@ -0,0 +1,43 @@
+#include "binrec/tracing/edge_cache.hpp"
+#include <gtest/gtest.h>
+
+namespace binrec {
+    namespace {
+
+        TEST(edge_cache, insert_reports_cached_pairs)
+        {
+            EdgeCache cache;
+            EXPECT_FALSE(cache.contains(0x100, 0x110));
+            EXPECT_TRUE(cache.insert(0x100, 0x110));
+            EXPECT_TRUE(cache.contains(0x100, 0x110));
+            EXPECT_FALSE(cache.insert(0x100, 0x110));
+
+            // The order of the pair matters.
+            EXPECT_FALSE(cache.contains(0x110, 0x100));
+            EXPECT_TRUE(cache.insert(0x110, 0x100));
+        }
+
+        TEST(edge_cache, collisions_replace_pairs)
+        {
+            // With a single slot, every pair collides with the previous one.
+            EdgeCache cache{1};
+            EXPECT_TRUE(cache.insert(0x100, 0x110));
+            EXPECT_TRUE(cache.insert(0x200, 0x210));
+            EXPECT_FALSE(cache.contains(0x100, 0x110));
+            EXPECT_TRUE(cache.insert(0x100, 0x110));
+        }
+
+        TEST(edge_cache, clear_forgets_pairs)
+        {
+            EdgeCache cache;
+            for (uint64_t pc = 0; pc < 100; ++pc) {
+                cache.insert(0x100, pc);
+            }
+            cache.clear();
+            for (uint64_t pc = 0; pc < 100; ++pc) {
+                EXPECT_FALSE(cache.contains(0x100, pc));
+            }
+        }
+
+    } // namespace
+} // namespace binrec
@@ -0,0 +1,161 @@
+#include "binrec/flat_map.hpp"
+#include "binrec/flat_set.hpp"
+#include <gmock/gmock.h>
+#include <utility>
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+namespace binrec {
+    namespace {
+
+        TEST(flat_set, initializer_list)
+        {
+            FlatSet<int> set{3, 1, 2, 1};
+            EXPECT_THAT(set, ElementsAre(1, 2, 3));
+            EXPECT_EQ(set.size(), 3);
+        }
+
+        TEST(flat_set, insert_unordered)
+        {
+            FlatSet<int> set;
+            for (int i = 0; i < 1000; ++i) {
+                set.insert((i * 7919) % 500);
+            }
+
+            ASSERT_EQ(set.size(), 500);
+            EXPECT_EQ(*set.begin(), 0);
+            EXPECT_EQ(*set.rbegin(), 499);
+            EXPECT_TRUE(std::is_sorted(set.begin(), set.end()));
+        }
+
+        TEST(flat_set, find_pending)
+        {
+            FlatSet<int> set{10, 20};
+            set.insert(15);
+
+            EXPECT_TRUE(set.contains(15));
+            EXPECT_EQ(set.count(16), 0);
+            EXPECT_EQ(set.find(30), set.end());
+            EXPECT_THAT(set, ElementsAre(10, 15, 20));
+        }
+
+        TEST(flat_set, normalize)
+        {
+            FlatSet<int> set{10, 20};
+            set.insert(15);
+            set.insert(5);
+            set.insert(15);
+            set.normalize();
+
+            const FlatSet<int> &shared = set;
+            const int *first = &*shared.begin();
+            EXPECT_THAT(shared, ElementsAre(5, 10, 15, 20));
+            EXPECT_EQ(&*shared.begin(), first);
+        }
+
+        TEST(flat_set, bulk_insert)
+        {
+            FlatSet<int> set{1, 5, 9};
+            std::vector<int> values{9, 2, 5, 7};
+            set.insert(values.begin(), values.end());
+            EXPECT_THAT(set, ElementsAre(1, 2, 5, 7, 9));
+        }
+
+        TEST(flat_set, assign_sorted)
+        {
+            FlatSet<int> set{100};
+            set.assign({1, 2, 3});
+            EXPECT_THAT(set, ElementsAre(1, 2, 3));
+
+            set.assign({3, 1, 3});
+            EXPECT_THAT(set, ElementsAre(1, 3));
+        }
+
+        TEST(flat_set, equality)
+        {
+            FlatSet<int> lhs{1, 2};
+            FlatSet<int> rhs;
+            rhs.insert(2);
+            rhs.insert(1);
+            EXPECT_EQ(lhs, rhs);
+
+            rhs.insert(3);
+            EXPECT_NE(lhs, rhs);
+        }
+
+        TEST(flat_set, copy_on_write)
+        {
+            FlatSet<int> original{1, 2};
+            original.insert(0);
+            FlatSet<int> copy = original;
+            EXPECT_EQ(&*copy.begin(), &*original.begin());
+
+            copy.insert(3);
+            original.insert(-1);
+            EXPECT_THAT(original, ElementsAre(-1, 0, 1, 2));
+            EXPECT_THAT(copy, ElementsAre(0, 1, 2, 3));
+
+            copy = original;
+            original.clear();
+            EXPECT_TRUE(original.empty());
+            EXPECT_THAT(copy, ElementsAre(-1, 0, 1, 2));
+        }
+
+        TEST(flat_map, initializer_list_keeps_first)
+        {
+            FlatMap<int, int> map{{2, 20}, {1, 10}, {2, 30}};
+            EXPECT_THAT(map, ElementsAre(Pair(1, 10), Pair(2, 20)));
+        }
+
+        TEST(flat_map, subscript_inserts_sorted)
+        {
+            FlatMap<int, FlatSet<int>> map;
+            map[5].insert(1);
+            map[1].insert(2);
+            map[5].insert(3);
+
+            EXPECT_THAT(map, ElementsAre(Pair(1, ElementsAre(2)), Pair(5, ElementsAre(1, 3))));
+        }
+
+        TEST(flat_map, emplace_hint)
+        {
+            FlatMap<int, int> map;
+            map.emplace_hint(map.end(), 1, 10);
+            map.emplace_hint(map.end(), 3, 30);
+            map.emplace_hint(map.end(), 2, 20);
+            auto it = map.emplace_hint(map.end(), 3, 40);
+
+            EXPECT_EQ(it->second, 30);
+            EXPECT_THAT(map, ElementsAre(Pair(1, 10), Pair(2, 20), Pair(3, 30)));
+        }
+
+        TEST(flat_map, find)
+        {
+            const FlatMap<int, int> map{{1, 10}, {3, 30}};
+            ASSERT_NE(map.find(3), map.end());
+            EXPECT_EQ(map.find(3)->second, 30);
+            EXPECT_EQ(map.find(2), map.end());
+            EXPECT_TRUE(map.contains(1));
+        }
+
+        TEST(flat_map, copy_on_write)
+        {
+            FlatMap<int, FlatSet<int>> original{{1, {10}}, {2, {20}}};
+            const FlatMap<int, FlatSet<int>> copy = original;
+            EXPECT_EQ(&*copy.begin(), &*std::as_const(original).begin());
+
+            original[2].insert(21);
+            original[3].insert(30);
+            EXPECT_THAT(
+                original,
+                ElementsAre(
+                    Pair(1, ElementsAre(10)),
+                    Pair(2, ElementsAre(20, 21)),
+                    Pair(3, ElementsAre(30))));
+            EXPECT_THAT(copy, ElementsAre(Pair(1, ElementsAre(10)), Pair(2, ElementsAre(20))));
+            EXPECT_EQ(&*copy.begin()->second.begin(), &*original.find(1)->second.begin());
+        }
+
+    } // namespace
+} // namespace binrec
@@ -0,0 +1,62 @@
+#include "binrec/tracing/function_log_buffer.hpp"
+#include "binrec/tracing/trace_info_journal.hpp"
+#include <gmock/gmock.h>
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+namespace binrec {
+    namespace {
+
+        TEST(function_log_buffer, flush_folds_blocks)
+        {
+            FunctionLog log;
+            log.entryToTbs[0x100].insert(0x110);
+            TraceInfoJournal journal;
+            FunctionLogBuffer buffer;
+
+            EXPECT_FALSE(buffer.append(0x200, 0x230, 0));
+            EXPECT_FALSE(buffer.append(0x200, 0x210, 0x150));
+            EXPECT_FALSE(buffer.append(0x100, 0x120, 0));
+            EXPECT_FALSE(buffer.append(0x100, 0x110, 0));
+            EXPECT_FALSE(buffer.empty());
+            buffer.flush(log, journal);
+
+            EXPECT_TRUE(buffer.empty());
+            EXPECT_THAT(log.entryToTbs[0x100], ElementsAre(0x110, 0x120));
+            EXPECT_THAT(log.entryToTbs[0x200], ElementsAre(0x210, 0x230));
+            EXPECT_THAT(log.callerToFollowUp, ElementsAre(Pair(0x150, 0x210)));
+        }
+
+        TEST(function_log_buffer, loops_are_deduplicated)
+        {
+            FunctionLog log;
+            TraceInfoJournal journal;
+            FunctionLogBuffer buffer{4};
+
+            // A tight loop only fills a single slot.
+            for (int i = 0; i < 100; ++i) {
+                EXPECT_FALSE(buffer.append(0x100, 0x110, 0));
+            }
+            // A loop over several blocks fills the buffer, but each block is only folded once.
+            EXPECT_FALSE(buffer.append(0x100, 0x120, 0));
+            EXPECT_FALSE(buffer.append(0x100, 0x110, 0));
+            EXPECT_TRUE(buffer.append(0x100, 0x120, 0));
+            buffer.flush(log, journal);
+
+            EXPECT_THAT(log.entryToTbs[0x100], ElementsAre(0x110, 0x120));
+            EXPECT_THAT(log.callerToFollowUp, IsEmpty());
+        }
+
+        TEST(function_log_buffer, flush_empty)
+        {
+            FunctionLog log;
+            TraceInfoJournal journal;
+            FunctionLogBuffer buffer;
+            buffer.flush(log, journal);
+            EXPECT_TRUE(log.entryToTbs.empty());
+        }
+
+    } // namespace
+} // namespace binrec
@@ -0,0 +1,185 @@
+#include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include <cstdio>
+#include <gmock/gmock.h>
+#include <sstream>
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+namespace binrec {
+    namespace {
+
+        auto sampleTraceInfo() -> TraceInfo
+        {
+            return TraceInfo{
+                {{"hello", 1}, {"world", 70000}},
+                {{"asdf", 2}},
+                {{100, -200, true, false, 300, true, 400},
+                 {0x8048000, 16, false, true, 4, false, 0}},
+                {{500, 600}, {500, 0x8049000}, {0x8049000, 500}},
+                {{1, 2, 3},
+                 {{4, 5}, {4, 6}},
+                 {{6, 7}},
+                 {{8, 9}, {0xffffffff, 0}},
+                 {{10, {11, 12}}, {0x80480a0, {0x80480a0, 0x80480b3}}}}};
+        }
+
+        auto roundTrip(const TraceInfo &ti, TraceInfo &result) -> bool
+        {
+            std::stringstream ss;
+            binary::write(ss, ti);
+            std::string buffer = ss.str();
+
+            binary::TraceInfoView view;
+            const auto *data = reinterpret_cast<const uint8_t *>(buffer.data());
+            return view.open(data, buffer.size()) && binary::read(view, result);
+        }
+
+        TEST(trace_info_binary, round_trip)
+        {
+            TraceInfo ti;
+            ASSERT_TRUE(roundTrip(sampleTraceInfo(), ti));
+
+            FunctionLog &fl = ti.functionLog;
+            EXPECT_THAT(fl.entries, ElementsAre(1, 2, 3));
+            EXPECT_THAT(fl.entryToCaller, ElementsAre(Pair(4, 5), Pair(4, 6)));
+            EXPECT_THAT(fl.entryToReturn, ElementsAre(Pair(6, 7)));
+            EXPECT_THAT(fl.callerToFollowUp, ElementsAre(Pair(8, 9), Pair(0xffffffff, 0)));
+            EXPECT_THAT(
+                fl.entryToTbs,
+                ElementsAre(
+                    Pair(10, ElementsAre(11, 12)),
+                    Pair(0x80480a0, ElementsAre(0x80480a0, 0x80480b3))));
+
+            ASSERT_EQ(ti.successors.size(), 3);
+            EXPECT_EQ(ti.successors.begin()->pc, 500);
+            EXPECT_EQ(ti.successors.begin()->successor, 600);
+            EXPECT_EQ(ti.successors.rbegin()->pc, 0x8049000);
+
+            ASSERT_EQ(ti.memoryAccesses.size(), 2);
+            MemoryAccess &ma = ti.memoryAccesses[0];
+            EXPECT_EQ(ma.pc, 100);
+            EXPECT_EQ(ma.offset, -200);
+            EXPECT_EQ(ma.isWrite, true);
+            EXPECT_EQ(ma.isLocalAccess, false);
+            EXPECT_EQ(ma.size, 300);
+            EXPECT_EQ(ma.isDirect, true);
+            EXPECT_EQ(ma.fnBase, 400);
+            EXPECT_EQ(ti.memoryAccesses[1].pc, 0x8048000);
+            EXPECT_EQ(ti.memoryAccesses[1].isLocalAccess, true);
+
+            EXPECT_THAT(
+                ti.stackFrameSizes,
+                UnorderedElementsAre(Pair("hello", 1), Pair("world", 70000)));
+            EXPECT_THAT(ti.stackDifference, ElementsAre(Pair("asdf", 2)));
+        }
+
+        TEST(trace_info_binary, round_trip_empty)
+        {
+            TraceInfo ti = sampleTraceInfo();
+            ASSERT_TRUE(roundTrip(TraceInfo{}, ti));
+
+            EXPECT_TRUE(ti.functionLog.entries.empty());
+            EXPECT_TRUE(ti.functionLog.entryToTbs.empty());
+            EXPECT_TRUE(ti.successors.empty());
+            EXPECT_TRUE(ti.memoryAccesses.empty());
+            EXPECT_TRUE(ti.stackFrameSizes.empty());
+        }
+
+        TEST(trace_info_binary, narrow_columns)
+        {
+            std::stringstream ss;
+            binary::write(ss, sampleTraceInfo());
+            std::string buffer = ss.str();
+
+            binary::TraceInfoView view;
+            const auto *data = reinterpret_cast<const uint8_t *>(buffer.data());
+            ASSERT_TRUE(view.open(data, buffer.size()));
+            EXPECT_EQ(view.column(binary::Entries).width, 1);
+            EXPECT_EQ(view.column(binary::EntryToTbsTb).encoding, binary::Encoding::KeyedDelta);
+            EXPECT_EQ(view.column(binary::EntryToTbsTb).width, 4);
+            EXPECT_EQ(view.column(binary::MemoryAccessesOffset).encoding, binary::Encoding::ZigZag);
+            EXPECT_EQ(view.column(binary::MemoryAccessesOffset).width, 2);
+            EXPECT_EQ(view.column(binary::MemoryAccessesFlags).width, 1);
+        }
+
+        TEST(trace_info_binary, reject_truncated)
+        {
+            std::stringstream ss;
+            binary::write(ss, sampleTraceInfo());
+            std::string buffer = ss.str();
+
+            binary::TraceInfoView view;
+            const auto *data = reinterpret_cast<const uint8_t *>(buffer.data());
+            EXPECT_FALSE(view.open(data, buffer.size() / 2));
+            EXPECT_FALSE(view.open(data, 3));
+        }
+
+        TEST(trace_info_binary, reject_version)
+        {
+            std::stringstream ss;
+            binary::write(ss, sampleTraceInfo());
+            std::string buffer = ss.str();
+            buffer[4] = static_cast<char>(binary::version + 1);
+
+            binary::TraceInfoView view;
+            const auto *data = reinterpret_cast<const uint8_t *>(buffer.data());
+            EXPECT_FALSE(view.open(data, buffer.size()));
+        }
+
+        TEST(trace_info_binary, reject_encoding)
+        {
+            std::stringstream ss;
+            binary::write(ss, sampleTraceInfo());
+            std::string buffer = ss.str();
+
+            // The encoding of the Entries column, which has no keys to decode deltas with.
+            std::size_t entriesEncoding = 16 + 9;
+            ASSERT_EQ(buffer[entriesEncoding], static_cast<char>(binary::Encoding::Raw));
+            buffer[entriesEncoding] = static_cast<char>(binary::Encoding::KeyedDelta);
+
+            binary::TraceInfoView view;
+            const auto *data = reinterpret_cast<const uint8_t *>(buffer.data());
+            EXPECT_FALSE(view.open(data, buffer.size()));
+        }
+
+        TEST(trace_info_binary, load_detects_format)
+        {
+            std::string jsonPath = testing::TempDir() + "trace_info_binary.json";
+            std::string binaryPath = testing::TempDir() + "trace_info_binary.bin";
+            ASSERT_TRUE(saveTraceInfo(jsonPath, sampleTraceInfo(), TraceInfoFormat::Json));
+            ASSERT_TRUE(saveTraceInfo(binaryPath, sampleTraceInfo(), TraceInfoFormat::Binary));
+
+            TraceInfo fromJson;
+            TraceInfo fromBinary;
+            ASSERT_TRUE(loadTraceInfo(jsonPath, fromJson));
+            ASSERT_TRUE(loadTraceInfo(binaryPath, fromBinary));
+
+            nlohmann::json expected = fromJson;
+            nlohmann::json actual = fromBinary;
+            EXPECT_EQ(actual, expected);
+
+            std::remove(jsonPath.c_str());
+            std::remove(binaryPath.c_str());
+        }
+
+        TEST(trace_info_binary, load_missing)
+        {
+            TraceInfo ti;
+            EXPECT_FALSE(loadTraceInfo(testing::TempDir() + "does-not-exist.bin", ti));
+        }
+
+        TEST(trace_info_binary, parse_format)
+        {
+            TraceInfoFormat format = TraceInfoFormat::Json;
+            EXPECT_TRUE(parseTraceInfoFormat("binary", format));
+            EXPECT_EQ(format, TraceInfoFormat::Binary);
+            EXPECT_TRUE(parseTraceInfoFormat("json", format));
+            EXPECT_EQ(format, TraceInfoFormat::Json);
+            EXPECT_FALSE(parseTraceInfoFormat("yaml", format));
+        }
+
+    } // namespace
+} // namespace binrec
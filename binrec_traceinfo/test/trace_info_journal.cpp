@@ -0,0 +1,113 @@
+#include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include "binrec/tracing/trace_info_journal.hpp"
+#include <cstdio>
+#include <fstream>
+#include <gmock/gmock.h>
+#include <iterator>
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+namespace binrec {
+    namespace {
+
+        class trace_info_journal : public ::testing::Test {
+        protected:
+            std::string path = testing::TempDir() + "traceInfo.journal";
+
+            void TearDown() override
+            {
+                std::remove(path.c_str());
+            }
+
+            void record(TraceInfoJournal &journal)
+            {
+                journal.addEntry(0, 0x100);
+                journal.addEntryToCaller(0x200, 0x110);
+                journal.addEntryToReturn(0x200, 0x210);
+                journal.addCallerToFollowUp(0x110, 0x115);
+                journal.addEntryToTb(0x200, 0x220);
+                journal.addEntryToTb(0x100, 0x110);
+                journal.addEntryToTb(0x200, 0x200);
+                journal.addSuccessor(0x110, 0x200);
+                journal.addEntry(1, 0x300);
+                journal.addEntry(0, 0x400);
+                journal.addEntryToTb(0x200, 0x220);
+            }
+
+            void truncate(std::size_t removed)
+            {
+                std::ifstream is{path, std::ios::binary};
+                std::string data{std::istreambuf_iterator<char>{is}, {}};
+                is.close();
+                std::ofstream os{path, std::ios::binary | std::ios::trunc};
+                os << data.substr(0, data.size() - removed);
+            }
+        };
+
+        TEST_F(trace_info_journal, replay)
+        {
+            TraceInfoJournal journal;
+            ASSERT_TRUE(journal.open(path, 3));
+            record(journal);
+            ASSERT_TRUE(journal.close());
+
+            TraceInfo ti;
+            ASSERT_TRUE(loadTraceInfo(path, ti));
+
+            const FunctionLog &fl = ti.functionLog;
+            EXPECT_THAT(fl.entries, ElementsAre(0x100, 0x300));
+            EXPECT_THAT(fl.entryToCaller, ElementsAre(Pair(0x200, 0x110)));
+            EXPECT_THAT(fl.entryToReturn, ElementsAre(Pair(0x200, 0x210)));
+            EXPECT_THAT(fl.callerToFollowUp, ElementsAre(Pair(0x110, 0x115)));
+            EXPECT_THAT(
+                fl.entryToTbs,
+                ElementsAre(
+                    Pair(0x100, ElementsAre(0x110)),
+                    Pair(0x200, ElementsAre(0x200, 0x220))));
+            ASSERT_EQ(ti.successors.size(), 1);
+            EXPECT_EQ(ti.successors.begin()->pc, 0x110);
+            EXPECT_EQ(ti.successors.begin()->successor, 0x200);
+        }
+
+        TEST_F(trace_info_journal, truncated_batch)
+        {
+            TraceInfoJournal journal;
+            ASSERT_TRUE(journal.open(path, 3));
+            record(journal);
+            ASSERT_TRUE(journal.flush());
+            truncate(1);
+
+            // The last two records form the incomplete last batch.
+            TraceInfo ti;
+            ASSERT_TRUE(loadTraceInfo(path, ti));
+            EXPECT_THAT(ti.functionLog.entries, ElementsAre(0x100, 0x300));
+            EXPECT_EQ(ti.functionLog.entryToTbs.size(), 2);
+        }
+
+        TEST_F(trace_info_journal, pending_records)
+        {
+            TraceInfoJournal journal;
+            ASSERT_TRUE(journal.open(path));
+            journal.addEntry(0, 0x100);
+
+            TraceInfo ti;
+            ASSERT_TRUE(loadTraceInfo(path, ti));
+            EXPECT_TRUE(ti.functionLog.entries.empty());
+
+            ASSERT_TRUE(journal.flush());
+            ASSERT_TRUE(loadTraceInfo(path, ti));
+            EXPECT_THAT(ti.functionLog.entries, ElementsAre(0x100));
+        }
+
+        TEST_F(trace_info_journal, closed)
+        {
+            TraceInfoJournal journal;
+            EXPECT_FALSE(journal.isOpen());
+            journal.addEntry(0, 0x100);
+            EXPECT_TRUE(journal.flush());
+        }
+
+    } // namespace
+} // namespace binrec
@@ -0,0 +1,100 @@
+#include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include "binrec/tracing/trace_info_parallel_merge.hpp"
+#include "binrec/tracing/trace_info_stream_merge.hpp"
+#include <cstdio>
+#include <gmock/gmock.h>
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+namespace binrec {
+    namespace {
+
+        auto stateTraceInfo(unsigned state) -> TraceInfo
+        {
+            TraceInfo ti;
+            ti.stackFrameSizes.emplace("main", state);
+            ti.stackDifference.emplace("main", 4);
+            ti.memoryAccesses.push_back({100, -8, true, true, 4, true, 100});
+            ti.memoryAccesses.push_back({200 + state, 0, false, false, 4, false, 100});
+            ti.successors.insert({1, 2});
+            ti.successors.insert({state, state + 1});
+            if (state > 0) {
+                ti.functionLog.entries = {state};
+            }
+            ti.functionLog.entryToCaller = {{10, state}};
+            ti.functionLog.callerToFollowUp = {{20, 21}};
+            ti.functionLog.entryToTbs = {{30, {state}}, {state, {31}}};
+            return ti;
+        }
+
+        class trace_info_parallel_merge : public ::testing::Test {
+        protected:
+            std::vector<std::string> paths;
+
+            void SetUp() override
+            {
+                for (unsigned state = 0; state < 7; ++state) {
+                    auto format = state % 2 ? TraceInfoFormat::Binary : TraceInfoFormat::Json;
+                    paths.push_back(
+                        testing::TempDir() + "parallel_merge_" + std::to_string(state) +
+                        traceInfoSuffix(format));
+                    ASSERT_TRUE(saveTraceInfo(paths.back(), stateTraceInfo(state), format));
+                }
+            }
+
+            void TearDown() override
+            {
+                for (const std::string &path : paths) {
+                    std::remove(path.c_str());
+                }
+            }
+        };
+
+        TEST_F(trace_info_parallel_merge, matches_stream_merge)
+        {
+            TraceInfo streamed;
+            ASSERT_TRUE(streamMergeTraceInfo(paths, streamed));
+
+            for (unsigned jobs : {1U, 3U, 8U}) {
+                TraceInfo merged;
+                ASSERT_TRUE(parallelMergeTraceInfo(paths, jobs, merged));
+
+                nlohmann::json expected = streamed;
+                nlohmann::json actual = merged;
+                EXPECT_EQ(actual, expected) << "jobs = " << jobs;
+            }
+        }
+
+        TEST_F(trace_info_parallel_merge, input_order)
+        {
+            TraceInfo ti;
+            ASSERT_TRUE(parallelMergeTraceInfo(paths, 4, ti));
+
+            EXPECT_THAT(ti.functionLog.entries, ElementsAre(1));
+            EXPECT_THAT(ti.stackFrameSizes, UnorderedElementsAre(Pair("main", 6)));
+            EXPECT_THAT(ti.functionLog.callerToFollowUp, ElementsAre(Pair(20, 21)));
+            EXPECT_EQ(ti.memoryAccesses.size(), 8);
+            EXPECT_EQ(ti.successors.size(), 7);
+        }
+
+        TEST_F(trace_info_parallel_merge, missing_input)
+        {
+            paths.push_back(testing::TempDir() + "does-not-exist.json");
+
+            TraceInfo ti;
+            EXPECT_FALSE(parallelMergeTraceInfo(paths, 4, ti));
+        }
+
+        TEST(trace_info_parallel_merge_empty, no_inputs)
+        {
+            TraceInfo ti;
+            ti.successors.insert({1, 2});
+            ASSERT_TRUE(parallelMergeTraceInfo({}, 4, ti));
+            EXPECT_TRUE(ti.successors.empty());
+        }
+
+    } // namespace
+} // namespace binrec
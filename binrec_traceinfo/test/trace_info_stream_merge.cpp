@@ -0,0 +1,127 @@
+#include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include "binrec/tracing/trace_info_stream_merge.hpp"
+#include <cstdio>
+#include <gmock/gmock.h>
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+namespace binrec {
+    namespace {
+
+        auto first() -> TraceInfo
+        {
+            TraceInfo ti;
+            ti.stackFrameSizes.emplace("main", 8);
+            ti.stackDifference.emplace("main", 4);
+            ti.memoryAccesses.push_back({200, -8, true, true, 4, true, 100});
+            ti.memoryAccesses.push_back({100, 16, false, false, 4, false, 100});
+            ti.successors.insert({1, 2});
+            ti.successors.insert({3, 4});
+            ti.functionLog.entries = {1, 2};
+            ti.functionLog.entryToCaller = {{10, 11}, {12, 13}};
+            ti.functionLog.entryToTbs = {{20, {21, 22}}};
+            return ti;
+        }
+
+        auto second() -> TraceInfo
+        {
+            TraceInfo ti;
+            ti.stackFrameSizes.emplace("main", 16);
+            ti.stackFrameSizes.emplace("helper", 2);
+            ti.memoryAccesses.push_back({100, 16, false, false, 4, false, 100});
+            ti.successors.insert({1, 2});
+            ti.successors.insert({1, 5});
+            ti.functionLog.entries = {3};
+            ti.functionLog.entryToCaller = {{10, 11}, {10, 12}};
+            ti.functionLog.entryToReturn = {{30, 31}};
+            ti.functionLog.entryToTbs = {{20, {22, 23}}, {24, {25}}};
+            return ti;
+        }
+
+        class trace_info_stream_merge : public ::testing::Test {
+        protected:
+            std::string binaryPath = testing::TempDir() + "stream_merge_first.bin";
+            std::string jsonPath = testing::TempDir() + "stream_merge_second.json";
+
+            void SetUp() override
+            {
+                ASSERT_TRUE(saveTraceInfo(binaryPath, first(), TraceInfoFormat::Binary));
+                ASSERT_TRUE(saveTraceInfo(jsonPath, second(), TraceInfoFormat::Json));
+            }
+
+            void TearDown() override
+            {
+                std::remove(binaryPath.c_str());
+                std::remove(jsonPath.c_str());
+            }
+        };
+
+        TEST_F(trace_info_stream_merge, sorted_members)
+        {
+            TraceInfo ti;
+            ASSERT_TRUE(streamMergeTraceInfo({binaryPath, jsonPath}, ti));
+
+            FunctionLog &fl = ti.functionLog;
+            EXPECT_THAT(fl.entries, ElementsAre(1, 2));
+            EXPECT_THAT(fl.entryToCaller, ElementsAre(Pair(10, 11), Pair(10, 12), Pair(12, 13)));
+            EXPECT_THAT(fl.entryToReturn, ElementsAre(Pair(30, 31)));
+            EXPECT_TRUE(fl.callerToFollowUp.empty());
+            EXPECT_THAT(
+                fl.entryToTbs,
+                ElementsAre(Pair(20, ElementsAre(21, 22, 23)), Pair(24, ElementsAre(25))));
+
+            ASSERT_EQ(ti.successors.size(), 3);
+            auto it = ti.successors.begin();
+            EXPECT_EQ(it->successor, 2);
+            EXPECT_EQ((++it)->successor, 5);
+            EXPECT_EQ((++it)->pc, 3);
+        }
+
+        TEST_F(trace_info_stream_merge, matches_add)
+        {
+            TraceInfo streamed;
+            ASSERT_TRUE(streamMergeTraceInfo({jsonPath, binaryPath}, streamed));
+
+            TraceInfo added = second();
+            added.add(first());
+
+            nlohmann::json expected = added.functionLog;
+            nlohmann::json actual = streamed.functionLog;
+            EXPECT_EQ(actual, expected);
+            EXPECT_EQ(streamed.successors.size(), added.successors.size());
+        }
+
+        TEST_F(trace_info_stream_merge, deduplicates_memory_accesses)
+        {
+            TraceInfo ti;
+            ASSERT_TRUE(streamMergeTraceInfo({binaryPath, jsonPath}, ti));
+
+            ASSERT_EQ(ti.memoryAccesses.size(), 2);
+            EXPECT_EQ(ti.memoryAccesses[0].pc, 100);
+            EXPECT_EQ(ti.memoryAccesses[1].pc, 200);
+            EXPECT_EQ(ti.memoryAccesses[1].offset, -8);
+        }
+
+        TEST_F(trace_info_stream_merge, stack_maps)
+        {
+            TraceInfo ti;
+            ASSERT_TRUE(streamMergeTraceInfo({binaryPath, jsonPath}, ti));
+
+            EXPECT_THAT(
+                ti.stackFrameSizes,
+                UnorderedElementsAre(Pair("main", 16), Pair("helper", 2)));
+            EXPECT_THAT(ti.stackDifference, UnorderedElementsAre(Pair("main", 4)));
+        }
+
+        TEST_F(trace_info_stream_merge, missing_input)
+        {
+            TraceInfo ti;
+            EXPECT_FALSE(
+                streamMergeTraceInfo({binaryPath, testing::TempDir() + "does-not-exist.bin"}, ti));
+        }
+
+    } // namespace
+} // namespace binrec
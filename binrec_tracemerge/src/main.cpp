@@ -1,28 +1,99 @@
 #include "binrec/tracing/trace_info.hpp"
+#include "binrec/tracing/trace_info_binary.hpp"
+#include "binrec/tracing/trace_info_parallel_merge.hpp"
+#include "binrec/tracing/trace_info_stream_merge.hpp"
 #include <algorithm>
 #include <cstdlib>
-#include <fstream>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 using namespace binrec;
 
+static void usage(const char *program)
+{
+    std::cout << "usage: " << program
+              << " [--format json|binary] [--stream | --jobs N] INPUT... OUTPUT\n"
+              << "\nInputs may be stored as JSON, in the binary format or as a journal written\n"
+              << "while tracing, which is compacted into the output. The output format\n"
+              << "defaults to binary when OUTPUT ends with " << TraceInfo::binarySuffix
+              << " and to JSON otherwise.\n"
+              << "\n  --stream  merge all inputs in a single pass over their sorted runs, which\n"
+              << "            keeps memory bounded by the output. Duplicate memory accesses\n"
+              << "            are dropped.\n"
+              << "  --jobs N  parse inputs on N threads and merge them in a balanced tree.\n"
+              << "            Duplicate memory accesses are dropped.\n";
+}
+
+static auto endsWith(const std::string &str, const std::string &suffix) -> bool
+{
+    return str.size() >= suffix.size() &&
+        str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
 auto main(int argc, char *argv[]) -> int
 {
     TraceInfo mergeTi;
+    int first = 1;
+    bool hasFormat = false;
+    bool stream = false;
+    unsigned jobs = 0;
+    TraceInfoFormat format = TraceInfoFormat::Json;
 
-    std::for_each(argv + 1, argv + argc - 1, [&mergeTi](char *arg) {
-        TraceInfo ti;
-        std::ifstream is{arg};
-        if (!is) {
-            std::cout << "Can't open file " << arg << '\n';
-            exit(1);
+    for (; first < argc && std::strncmp(argv[first], "--", 2) == 0; ++first) {
+        if (std::strcmp(argv[first], "--stream") == 0) {
+            stream = true;
+        } else if (
+            std::strcmp(argv[first], "--format") == 0 && first + 1 < argc &&
+            parseTraceInfoFormat(argv[first + 1], format))
+        {
+            hasFormat = true;
+            ++first;
+        } else if (std::strcmp(argv[first], "--jobs") == 0 && first + 1 < argc) {
+            jobs = std::strtoul(argv[++first], nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
         }
-        is >> ti;
-        mergeTi.add(ti);
-    });
+    }
+
+    if (argc - first < 2 || (stream && jobs > 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> inputs{argv + first, argv + argc - 1};
+    if (stream) {
+        if (!streamMergeTraceInfo(inputs, mergeTi)) {
+            std::cout << "Can't merge trace info files\n";
+            return 1;
+        }
+    } else if (jobs > 0) {
+        if (!parallelMergeTraceInfo(inputs, jobs, mergeTi)) {
+            std::cout << "Can't merge trace info files\n";
+            return 1;
+        }
+    } else {
+        std::for_each(argv + first, argv + argc - 1, [&mergeTi](char *arg) {
+            TraceInfo ti;
+            if (!loadTraceInfo(arg, ti)) {
+                std::cout << "Can't open file " << arg << '\n';
+                exit(1);
+            }
+            mergeTi.add(ti);
+        });
+    }
+
+    std::string output = argv[argc - 1];
+    if (!hasFormat && endsWith(output, TraceInfo::binarySuffix)) {
+        format = TraceInfoFormat::Binary;
+    }
 
-    std::ofstream os{argv[argc - 1]};
-    os << mergeTi;
+    if (!saveTraceInfo(output, mergeTi, format)) {
+        std::cout << "Can't write file " << output << '\n';
+        return 1;
+    }
 
     return 0;
 }
@@ -88,6 +88,17 @@ class TestEnv:
         assert env.get_trace_dirs("asdf") == [trace_dir_1, trace_dir_2]
         mock_project_dir.assert_called_once_with("asdf")
 
+    @patch.object(env, "project_dir")
+    def test_get_trace_dirs_numeric_order(self, mock_project_dir):
+        root = mock_project_dir.return_value = MockPath("asdf")
+        trace_dir_10 = root / MockPath("s2e-out-10", is_dir=True)
+        trace_dir_9 = root / MockPath("s2e-out-9", is_dir=True)
+
+        assert env.get_trace_dirs("asdf") == [trace_dir_9, trace_dir_10]
+
+    def test_trace_worker_dir(self):
+        assert env.trace_worker_dir("asdf", 3) == env.BINREC_PROJECTS / "asdf" / "trace-workers" / "3"
+
     def test_input_files_dirs(self):
         assert env.input_files_dir("asdf") == env.BINREC_PROJECTS / "asdf" / "input_files"
 
@@ -8,7 +8,7 @@ import pytest
 
 from binrec import lift, core
 from binrec.lift import OptimizationLevel
-from binrec.env import BINREC_ROOT, llvm_command
+from binrec.env import BINREC_ROOT
 from binrec.errors import BinRecError
 from binrec import audit
 
@@ -147,157 +147,6 @@ class TestLifting:
         with pytest.raises(BinRecError):
             lift._extract_sections(MagicMock(name="asdf"))
 
-    def test_clean_bitcode(self, mock_lib_module):
-        trace_dir = MockPath("asdf")
-
-        lift._clean_bitcode(trace_dir)
-
-        mock_lib_module.binrec_lift.clean.assert_called_once_with(
-            trace_filename="captured.bc",
-            destination="cleaned",
-            working_dir=str(trace_dir),
-        )
-
-    def test_clean_bitcode_error(self, mock_lib_module):
-        mock_lib_module.binrec_lift.clean.side_effect = OSError()
-        mock_lib_module.convert_lib_error.return_value = BinRecError('asdf')
-        with pytest.raises(BinRecError):
-            lift._clean_bitcode(MockPath("asdf"))
-
-        mock_lib_module.convert_lib_error.assert_called_once()
-
-    @patch.object(lift.subprocess, "check_call")
-    def test_apply_fixups(self, mock_check_call):
-        trace_dir = MockPath("asdf")
-
-        lift._apply_fixups(trace_dir)
-
-        assert mock_check_call.call_args_list == [
-            call(
-                [
-                    llvm_command("llvm-link"),
-                    "-o",
-                    "linked.bc",
-                    "cleaned.bc",
-                    str(BINREC_ROOT / "runlib" / "custom-helpers.bc"),
-                ],
-                cwd=str(trace_dir),
-                stdout=(trace_dir / "fixups.log").open.return_value,
-                stderr=subprocess.STDOUT
-            ),
-            call(
-                [llvm_command("llvm-dis"), "linked.bc"],
-                cwd=str(trace_dir),
-                stdout=(trace_dir / "fixups.log").open.return_value,
-                stderr=subprocess.STDOUT
-            ),
-        ]
-
-    @patch.object(lift.subprocess, "check_call")
-    def test_apply_fixups_error(self, mock_check_call):
-        mock_check_call.side_effect = CalledProcessError(0, "asdf")
-        with pytest.raises(BinRecError):
-            lift._apply_fixups(MockPath("asdf"))
-
-    def test_lift_bitcode(self, mock_lib_module):
-        trace_dir = MockPath("asdf")
-
-        lift._lift_bitcode(trace_dir)
-
-        mock_lib_module.binrec_lift.lift.assert_called_once_with(
-            trace_filename="linked.bc",
-            destination="lifted",
-            clean_names=True,
-            working_dir=str(trace_dir),
-        )
-
-    def test_lift_bitcode_error(self, mock_lib_module):
-        mock_lib_module.binrec_lift.lift.side_effect = OSError()
-        mock_lib_module.convert_lib_error.return_value = BinRecError('asdf')
-        with pytest.raises(BinRecError):
-            lift._lift_bitcode(MockPath("asdf"))
-
-        mock_lib_module.convert_lib_error.assert_called_once()
-
-    def test_optimize_bitcode(self, mock_lib_module):
-        trace_dir = MockPath("asdf")
-
-        lift._optimize_bitcode(trace_dir, lift.OptimizationLevel.NORMAL)
-
-        mock_lib_module.binrec_lift.optimize(
-            trace_filename="lifted.bc",
-            destination="optimized",
-            memssa_check_limit=100000,
-            working_dir=str(trace_dir),
-        )
-
-    def test_optimize_bitcode_error(self, mock_lib_module):
-        mock_lib_module.binrec_lift.optimize.side_effect = OSError()
-        mock_lib_module.convert_lib_error.return_value = BinRecError('asdf')
-        with pytest.raises(BinRecError):
-            lift._optimize_bitcode(MockPath("asdf"), lift.OptimizationLevel.NORMAL)
-
-        mock_lib_module.convert_lib_error.assert_called_once()
-
-    @patch.object(lift.subprocess, "check_call")
-    def test_disassemble_bitcode(self, mock_check_call):
-        trace_dir = MockPath("asdf")
-
-        lift._disassemble_bitcode(trace_dir)
-
-        mock_check_call.assert_called_once_with(
-            [llvm_command("llvm-dis"), "optimized.bc"],
-            cwd=str(trace_dir),
-            stdout=(trace_dir / "disassembly.log").open.return_value,
-            stderr=subprocess.STDOUT
-        )
-
-    @patch.object(lift.subprocess, "check_call")
-    def test_disassemble_bitcode_error(self, mock_check_call):
-        mock_check_call.side_effect = CalledProcessError(0, "asdf")
-        with pytest.raises(BinRecError):
-            lift._disassemble_bitcode(MockPath("asdf"))
-
-    def test_recover_bitcode(self, mock_lib_module):
-        trace_dir = MockPath("asdf")
-
-        lift._recover_bitcode(trace_dir)
-
-        mock_lib_module.binrec_lift.compile_prep.assert_called_once_with(
-            trace_filename="optimized.bc",
-            destination="recovered",
-            working_dir=str(trace_dir),
-        )
-
-    def test_recover_bitcode_error(self, mock_lib_module):
-        mock_lib_module.binrec_lift.compile_prep.side_effect = OSError()
-        mock_lib_module.convert_lib_error.return_value = BinRecError('asdf')
-        with pytest.raises(BinRecError):
-            lift._recover_bitcode(MockPath("asdf"))
-
-        mock_lib_module.convert_lib_error.assert_called_once()
-
-    @patch.object(lift.subprocess, "check_call")
-    def test_compile_bitcode(self, mock_check_call):
-        trace_dir = MockPath("asdf")
-        lift._compile_bitcode(trace_dir)
-
-        mock_check_call.assert_called_once_with(
-            [
-                llvm_command("llc"), "-filetype", "obj", "-o", "recovered.o",
-                "recovered.bc"
-            ],
-            cwd=str(trace_dir),
-            stdout=(trace_dir / "compile.log").open.return_value,
-            stderr=subprocess.STDOUT
-        )
-
-    @patch.object(lift.subprocess, "check_call")
-    def test_compile_bitcode_error(self, mock_check_call):
-        mock_check_call.side_effect = CalledProcessError(0, "asdf")
-        with pytest.raises(BinRecError):
-            lift._compile_bitcode(MockPath("asdf"))
-
     def test_link_recovered_binary(self, mock_lib_module):
         trace_dir = MockPath("asdf")
         i386_ld = str(BINREC_ROOT / "binrec_link" / "ld" / "i386.ld")
@@ -323,30 +172,40 @@ class TestLifting:
 
         mock_lib_module.convert_lib_error.assert_called_once()
 
+    def test_run_full_pipeline(self, mock_lib_module):
+        trace_dir = MockPath("asdf")
+        lift._run_full_pipeline(trace_dir, OptimizationLevel.HIGH)
+        mock_lib_module.binrec_lift.full_pipeline.assert_called_once_with(
+            trace_filename="captured.bc",
+            destination="recovered",
+            custom_helpers=str(BINREC_ROOT / "runlib" / "custom-helpers.bc"),
+            working_dir=str(trace_dir),
+            optimize_better=True,
+            clean_names=True,
+            memssa_check_limit=100000,
+            split_module=False,
+        )
+
+    def test_run_full_pipeline_error(self, mock_lib_module):
+        mock_lib_module.binrec_lift.full_pipeline.side_effect = OSError()
+        mock_lib_module.convert_lib_error.return_value = BinRecError('asdf')
+        with pytest.raises(BinRecError):
+            lift._run_full_pipeline(MockPath("asdf"), OptimizationLevel.NORMAL)
+
+        mock_lib_module.convert_lib_error.assert_called_once()
+
     @patch.object(lift, "_extract_binary_symbols")
     @patch.object(lift, "_extract_data_imports")
     @patch.object(lift, "_extract_sections")
     @patch.object(lift, "_extract_dependencies")
-    @patch.object(lift, "_clean_bitcode")
-    @patch.object(lift, "_apply_fixups")
-    @patch.object(lift, "_lift_bitcode")
-    @patch.object(lift, "_optimize_bitcode")
-    @patch.object(lift, "_disassemble_bitcode")
-    @patch.object(lift, "_recover_bitcode")
-    @patch.object(lift, "_compile_bitcode")
+    @patch.object(lift, "_run_full_pipeline")
     @patch.object(lift, "_link_recovered_binary")
     @patch.object(lift, "project")
     def test_lift_trace(
         self,
         mock_project,
         mock_link,
-        mock_compile,
-        mock_recover,
-        mock_disasm,
-        mock_optimize,
-        mock_lift,
-        mock_apply,
-        mock_clean,
+        mock_pipeline,
         mock_deps,
         mock_sections,
         mock_data_imports,
@@ -357,13 +216,7 @@ class TestLifting:
         )
         lift.lift_trace("hello", OptimizationLevel.NORMAL)
         mock_extract.assert_called_once_with(trace_dir)
-        mock_clean.assert_called_once_with(trace_dir)
-        mock_apply.assert_called_once_with(trace_dir)
-        mock_lift.assert_called_once_with(trace_dir)
-        mock_optimize.assert_called_once_with(trace_dir, OptimizationLevel.NORMAL)
-        mock_disasm.assert_called_once_with(trace_dir)
-        mock_recover.assert_called_once_with(trace_dir)
-        mock_compile.assert_called_once_with(trace_dir)
+        mock_pipeline.assert_called_once_with(trace_dir, OptimizationLevel.NORMAL, False)
         mock_link.assert_called_once_with(trace_dir, False)
         mock_data_imports.assert_called_once_with(trace_dir)
         mock_sections.assert_called_once_with(trace_dir)
@@ -372,26 +225,14 @@ class TestLifting:
     @patch.object(lift, "_extract_binary_symbols")
     @patch.object(lift, "_extract_sections")
     @patch.object(lift, "_extract_dependencies")
-    @patch.object(lift, "_clean_bitcode")
-    @patch.object(lift, "_apply_fixups")
-    @patch.object(lift, "_lift_bitcode")
-    @patch.object(lift, "_optimize_bitcode")
-    @patch.object(lift, "_disassemble_bitcode")
-    @patch.object(lift, "_recover_bitcode")
-    @patch.object(lift, "_compile_bitcode")
+    @patch.object(lift, "_run_full_pipeline")
     @patch.object(lift, "_link_recovered_binary")
     @patch.object(lift, "project")
     def test_lift_trace_error(
         self,
         mock_project,
         mock_link,
-        mock_compile,
-        mock_recover,
-        mock_disasm,
-        mock_optimize,
-        mock_lift,
-        mock_apply,
-        mock_clean,
+        mock_pipeline,
         mock_deps,
         mock_sections,
         mock_extract,
@@ -401,13 +242,7 @@ class TestLifting:
             lift.lift_trace("hello", OptimizationLevel.NORMAL)
 
         mock_extract.assert_not_called()
-        mock_clean.assert_not_called()
-        mock_apply.assert_not_called()
-        mock_lift.assert_not_called()
-        mock_optimize.assert_not_called()
-        mock_disasm.assert_not_called()
-        mock_recover.assert_not_called()
-        mock_compile.assert_not_called()
+        mock_pipeline.assert_not_called()
         mock_link.assert_not_called()
         mock_sections.assert_not_called()
         mock_deps.assert_not_called()
@@ -417,9 +252,16 @@ class TestLifting:
     @patch.object(lift, "lift_trace")
     def test_main(self, mock_lift, mock_exit):
         lift.main()
-        mock_lift.assert_called_once_with("hello", OptimizationLevel.NORMAL, False)
+        mock_lift.assert_called_once_with("hello", OptimizationLevel.NORMAL, False, False)
         mock_exit.assert_called_once_with(0)
 
+    @patch("sys.argv", ["lift", "--split-module", "hello"])
+    @patch.object(sys, "exit")
+    @patch.object(lift, "lift_trace")
+    def test_main_split_module(self, mock_lift, mock_exit):
+        lift.main()
+        mock_lift.assert_called_once_with("hello", OptimizationLevel.NORMAL, False, True)
+
     @patch("sys.argv", ["lift"])
     def test_main_usage_error(self):
         with pytest.raises(SystemExit) as err:
@@ -1,6 +1,6 @@
 import subprocess
 import sys
-from unittest.mock import patch, call
+from unittest.mock import patch
 from pathlib import Path
 import logging
 
@@ -15,37 +15,26 @@ from helpers.mock_path import MockPath
 
 
 class TestMerge:
-    @patch.object(merge.subprocess, "check_call")
-    def test_link_bitcode(self, mock_check_call):
-        dest = MockPath("dest")
-        merge._link_bitcode(Path("base"), Path("source"), dest)
-        mock_check_call.assert_called_once_with(
-            [
-                llvm_command("llvm-link"),
-                "-print-after-all",
-                "-v",
-                "-o",
-                "dest",
-                "-override=base",
-                "source",
-            ],
-            stdout=(dest.parent / "merge_link.log").open.return_value,
-            stderr=subprocess.STDOUT
+    def test_link_bitcode(self, mock_lib_module):
+        merge._link_bitcode([Path("base"), Path("source")], Path("dest"))
+        mock_lib_module.binrec_lift.merge_captures.assert_called_once_with(
+            captures=["base", "source"], destination="dest"
         )
 
-    @patch.object(merge.subprocess, "check_call")
-    def test_link_bitcode_exc(self, mock_check_call):
-        dest = MockPath("dest")
-        mock_check_call.side_effect = subprocess.CalledProcessError(0, "asdf")
+    def test_link_bitcode_exc(self, mock_lib_module):
+        mock_lib_module.binrec_lift.merge_captures.side_effect = RuntimeError("asdf")
+        mock_lib_module.convert_lib_error.return_value = BinRecError("asdf")
         with pytest.raises(BinRecError):
-            merge._link_bitcode(Path("base"), Path("source"), dest)
+            merge._link_bitcode([Path("base"), Path("source")], Path("dest"))
+
+        mock_lib_module.convert_lib_error.assert_called_once()
 
     @patch.object(merge.subprocess, "check_call")
     def test_merge_trace_info(self, mock_check_call):
         binrec_tracemerge = str(BINREC_ROOT / "build" / "bin" / "binrec_tracemerge")
         merge._merge_trace_info([1, 2, 3], "dest")
         mock_check_call.assert_called_once_with(
-            [binrec_tracemerge, "1", "2", "3", "dest"]
+            [binrec_tracemerge, "--stream", "1", "2", "3", "dest"]
         )
 
     @patch.object(merge.subprocess, "check_call")
@@ -55,8 +44,6 @@ class TestMerge:
             merge._merge_trace_info(["asdf"], "qwer")
 
     @patch.object(merge, "shutil")
-    @patch.object(merge, "prep_bitcode_for_linkage")
-    @patch.object(merge.tempfile, "mkstemp")
     @patch.object(merge, "os")
     @patch.object(merge, "_link_bitcode")
     @patch.object(merge.subprocess, "check_call")
@@ -67,14 +54,17 @@ class TestMerge:
         mock_check_call,
         mock_link,
         mock_os,
-        mock_mkstemp,
-        mock_prep_bitcode,
         mock_shutil,
     ):
         dest = MockPath() / "does" / "not" / "exist"
         dest.exists.return_value = False
-        mock_mkstemp.return_value = (100, "temp")
-        mock_os.listdir.return_value = ["captured.bc", "captured_0.bc", "traceInfo.json", "traceInfo_0.json"]
+        mock_os.listdir.return_value = [
+            "captured.bc",
+            "captured_0.bc",
+            "captured-link-ready.bc",
+            "traceInfo.json",
+            "traceInfo_0.json",
+        ]
         outfile = dest / "captured.bc"
         capture_dirs = [
             Path("/") / "i" / "don't" / "exist",
@@ -86,42 +76,110 @@ class TestMerge:
         dest.mkdir.assert_called_once_with(exist_ok=True)
         mock_shutil.rmtree.assert_not_called()
 
-        assert mock_prep_bitcode.call_args_list == [
-            call(capture_dirs[0], Path("captured.bc"), Path("captured-link-ready.bc")),
-            call(capture_dirs[0], Path("captured_0.bc"), Path("captured_0-link-ready.bc")),
-            call(capture_dirs[1], Path("captured.bc"), Path("captured-link-ready.bc")),
-            call(capture_dirs[1], Path("captured_0.bc"), Path("captured_0-link-ready.bc"))
-        ]
-
-        mock_shutil.copy.assert_called_once_with(
-            capture_dirs[0] / "captured-link-ready.bc", outfile
+        mock_link.assert_called_once_with(
+            [
+                capture_dirs[0] / "captured.bc",
+                capture_dirs[0] / "captured_0.bc",
+                capture_dirs[1] / "captured.bc",
+                capture_dirs[1] / "captured_0.bc",
+            ],
+            outfile,
         )
 
-        mock_mkstemp.assert_called_once_with(suffix=".bc")
-        mock_os.close.assert_called_once_with(100)
+        mock_check_call.assert_not_called()
+        mock_merge.assert_called_once_with(
+            [capture_dirs[0] / "traceInfo.json", capture_dirs[0] / "traceInfo_0.json",
+             capture_dirs[1] / "traceInfo.json", capture_dirs[1] / "traceInfo_0.json"],
+            dest / "traceInfo.json",
+        )
 
-        assert mock_link.call_args_list == [
-            call(base=outfile, source=capture_dirs[0] / "captured_0-link-ready.bc", destination = Path("temp")),
-            call(base=outfile, source=capture_dirs[1] / "captured-link-ready.bc", destination = Path("temp")),
-            call(base=outfile, source=capture_dirs[1] / "captured_0-link-ready.bc", destination = Path("temp"))
+    @patch.object(merge, "shutil")
+    @patch.object(merge, "os")
+    @patch.object(merge, "_link_bitcode")
+    @patch.object(merge.subprocess, "check_call")
+    @patch.object(merge, "_merge_trace_info")
+    def test_merge_bitcode_binary_trace_info(
+        self,
+        mock_merge,
+        mock_check_call,
+        mock_link,
+        mock_os,
+        mock_shutil,
+    ):
+        dest = MockPath() / "does" / "not" / "exist"
+        dest.exists.return_value = False
+        mock_os.listdir.side_effect = [
+            ["captured.bc", "traceInfo.bin"],
+            ["captured.bc", "traceInfo.json"],
+        ]
+        capture_dirs = [
+            Path("/") / "i" / "don't" / "exist",
+            Path("/") / "I" / "don't" / "either",
         ]
 
-        assert mock_shutil.move.call_args_list == [
-            call("temp", outfile), call("temp", outfile), call("temp", outfile)
+        merge.merge_bitcode(capture_dirs, dest)
+        mock_merge.assert_called_once_with(
+            [capture_dirs[0] / "traceInfo.bin", capture_dirs[1] / "traceInfo.json"],
+            dest / "traceInfo.bin",
+        )
+
+    @patch.object(merge, "shutil")
+    @patch.object(merge, "os")
+    @patch.object(merge, "_link_bitcode")
+    @patch.object(merge.subprocess, "check_call")
+    @patch.object(merge, "_merge_trace_info")
+    def test_merge_bitcode_journal_trace_info(
+        self,
+        mock_merge,
+        mock_check_call,
+        mock_link,
+        mock_os,
+        mock_shutil,
+    ):
+        dest = MockPath() / "does" / "not" / "exist"
+        dest.exists.return_value = False
+        mock_os.listdir.side_effect = [
+            ["captured.bc", "traceInfo.journal"],
+            ["captured.bc", "traceInfo.json"],
+        ]
+        capture_dirs = [
+            Path("/") / "i" / "don't" / "exist",
+            Path("/") / "I" / "don't" / "either",
         ]
 
+        merge.merge_bitcode(capture_dirs, dest)
+        mock_merge.assert_called_once_with(
+            [capture_dirs[0] / "traceInfo.journal", capture_dirs[1] / "traceInfo.json"],
+            dest / "traceInfo.bin",
+        )
+
+    @patch.object(merge, "shutil")
+    @patch.object(merge, "os")
+    @patch.object(merge, "_link_bitcode")
+    @patch.object(merge.subprocess, "check_call")
+    @patch.object(merge, "_merge_trace_info")
+    def test_merge_bitcode_debug(
+        self,
+        mock_merge,
+        mock_check_call,
+        mock_link,
+        mock_os,
+        mock_shutil,
+    ):
+        dest = MockPath() / "does" / "not" / "exist"
+        dest.exists.return_value = False
+        mock_os.listdir.return_value = ["captured.bc"]
+        outfile = dest / "captured.bc"
+        capture_dirs = [Path("/") / "i" / "don't" / "exist"]
+
+        with patch.object(merge.logger, "isEnabledFor", return_value=True):
+            merge.merge_bitcode(capture_dirs, dest)
+
         mock_check_call.assert_called_once_with(
             [llvm_command("llvm-dis"), str(outfile)]
         )
-        mock_merge.assert_called_once_with(
-            [capture_dirs[0] / "traceInfo.json", capture_dirs[0] / "traceInfo_0.json",
-             capture_dirs[1] / "traceInfo.json", capture_dirs[1] / "traceInfo_0.json"],
-            dest / "traceInfo.json",
-        )
 
     @patch.object(merge, "shutil")
-    @patch.object(merge, "prep_bitcode_for_linkage")
-    @patch.object(merge.tempfile, "mkstemp")
     @patch.object(merge, "os")
     @patch.object(merge, "_link_bitcode")
     @patch.object(merge.subprocess, "check_call")
@@ -132,13 +190,10 @@ class TestMerge:
         mock_check_call,
         mock_link,
         mock_os,
-        mock_mkstemp,
-        mock_prep_bitcode,
         mock_shutil,
     ):
         dest = MockPath("/") / "does" / "not" / "exist"
         dest._exists = True
-        mock_mkstemp.return_value = (100, "temp")
         mock_os.listdir.return_value = ["captured.bc"]
         capture_dirs = [
             Path("/") / "i" / "don't" / "exist",
@@ -149,8 +204,6 @@ class TestMerge:
         mock_shutil.rmtree.assert_called_once_with(dest)
 
     @patch.object(merge, "shutil")
-    @patch.object(merge, "prep_bitcode_for_linkage")
-    @patch.object(merge.tempfile, "mkstemp")
     @patch.object(merge, "os")
     @patch.object(merge, "_link_bitcode")
     @patch.object(merge.subprocess, "check_call")
@@ -161,13 +214,10 @@ class TestMerge:
         mock_check_call,
         mock_link,
         mock_os,
-        mock_mkstemp,
-        mock_prep_bitcode,
         mock_shutil,
     ):
         dest = MockPath("/") / "does" / "not" / "exist"
         dest.exists.return_value = True
-        mock_mkstemp.return_value = (100, "temp")
         mock_os.listdir.return_value = ["captured.bc"]
         capture_dirs = [
             Path("/") / "i" / "don't" / "exist",
@@ -175,8 +225,9 @@ class TestMerge:
         ]
         mock_check_call.side_effect = subprocess.CalledProcessError(0, "asdf")
 
-        with pytest.raises(BinRecError):
-            merge.merge_bitcode(capture_dirs, dest)
+        with patch.object(merge.logger, "isEnabledFor", return_value=True):
+            with pytest.raises(BinRecError):
+                merge.merge_bitcode(capture_dirs, dest)
 
     @patch.object(merge, "merged_trace_dir")
     @patch.object(merge, "get_trace_dirs")
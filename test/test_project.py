@@ -112,6 +112,74 @@ class TestProject:
         )
         mock_log_filename.assert_called_once_with(c.project)
 
+    @patch.object(project, "_run_campaign_parallel")
+    @patch.object(project, "_run_campaign_trace")
+    def test_run_campaign_serial(self, mock_run_trace, mock_run_parallel):
+        c = MagicMock(spec=project.Campaign, traces=[1, 2])
+        project.run_campaign(c)
+        mock_run_trace.assert_has_calls([call(c, 1), call(c, 2)])
+        mock_run_parallel.assert_not_called()
+
+    @patch.object(project, "_run_campaign_parallel")
+    @patch.object(project, "_run_campaign_trace")
+    def test_run_campaign_parallel(self, mock_run_trace, mock_run_parallel):
+        c = MagicMock(spec=project.Campaign, traces=[1, 2])
+        project.run_campaign(c, jobs=4)
+        mock_run_parallel.assert_called_once_with(c, 4)
+        mock_run_trace.assert_not_called()
+
+    @patch.object(project, "_run_campaign_parallel")
+    @patch.object(project, "campaign_jobs", return_value=2)
+    def test_run_campaign_auto_jobs(self, mock_jobs, mock_run_parallel):
+        c = MagicMock(spec=project.Campaign, traces=[1, 2, 3])
+        project.run_campaign(c, jobs=0)
+        mock_jobs.assert_called_once_with(3)
+        mock_run_parallel.assert_called_once_with(c, 2)
+
+    @patch.object(project, "_available_memory", return_value=5 * project.TRACE_MEMORY_ESTIMATE)
+    @patch.object(project.os, "cpu_count", return_value=8)
+    def test_campaign_jobs(self, mock_cpu_count, mock_memory):
+        assert project.campaign_jobs(100) == 5
+        assert project.campaign_jobs(3) == 3
+        mock_memory.return_value = 0
+        assert project.campaign_jobs(100) == 8
+        mock_memory.return_value = 1
+        assert project.campaign_jobs(100) == 1
+
+    @patch.object(project, "get_trace_dirs")
+    def test_get_next_trace_ids(self, mock_get_trace_dirs):
+        mock_get_trace_dirs.return_value = [Path("s2e-out-0"), Path("s2e-out-2")]
+        assert project._get_next_trace_ids("asdf", 3) == [1, 3, 4]
+
+    def test_setup_trace_worker(self, tmp_path):
+        project_path = tmp_path / "asdf"
+        project_path.mkdir()
+        (project_path / "bootstrap.sh").write_text("bootstrap")
+        (project_path / "launch-s2e.sh").write_text("launch")
+        (project_path / "s2e-config.lua").write_text(f'baseDirs = {{"{project_path}"}}')
+        (project_path / "s2e-out-0").mkdir()
+        (project_path / "input_files").mkdir()
+        worker = project_path / "trace-workers" / "1"
+        trace = MagicMock()
+
+        with patch.object(project, "project_dir", return_value=project_path), patch.object(
+            project, "s2e_config_filename", return_value=project_path / "s2e-config.lua"
+        ):
+            project._setup_trace_worker(MagicMock(project="asdf"), trace, worker)
+
+        assert (worker / "bootstrap.sh").is_symlink()
+        assert not (worker / "launch-s2e.sh").is_symlink()
+        assert (worker / "launch-s2e.sh").read_text() == "launch"
+        assert (worker / "s2e-config.lua").read_text() == f'baseDirs = {{"{worker}"}}'
+        assert not (worker / "s2e-out-0").exists()
+        assert not (worker / "input_files").exists()
+        trace.setup_input_file_directory.assert_called_once_with(
+            "asdf", dirname=worker / "input_files"
+        )
+        trace.write_config_script.assert_called_once_with(
+            "asdf", worker / "binrec_trace_config.sh"
+        )
+
     @patch.object(project, "project_dir")
     @patch.object(project.subprocess, "check_call")
     def test_new_project_error(self, mock_check_call, mock_project_dir):